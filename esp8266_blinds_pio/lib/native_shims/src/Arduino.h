@@ -0,0 +1,292 @@
+#ifndef NATIVE_ARDUINO_H
+#define NATIVE_ARDUINO_H
+
+// Host stand-in for the ESP8266 Arduino core (env:native only)
+
+#include <algorithm>
+#include <cmath>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+
+#ifndef F_CPU
+#define F_CPU 80000000L
+#endif
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+// Flash attributes and PROGMEM accessors: everything lives in RAM here
+#define PROGMEM
+#define PGM_P const char*
+#define PSTR(s) (s)
+#define F(s) (s)
+#define IRAM_ATTR
+#define ICACHE_RAM_ATTR
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+#define pgm_read_word(p) (*(const uint16_t*)(p))
+#define pgm_read_dword(p) (*(const uint32_t*)(p))
+#define memcpy_P memcpy
+#define strlen_P strlen
+#define strcmp_P strcmp
+#define strncmp_P strncmp
+#define strncpy_P strncpy
+#define snprintf_P snprintf
+#define vsnprintf_P vsnprintf
+
+// GPIO
+#define LOW 0
+#define HIGH 1
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define RISING 1
+#define FALLING 2
+#define CHANGE 3
+#define digitalPinToInterrupt(p) (p)
+
+extern volatile uint32_t GPOS, GPOC;  // GPIO set/clear registers
+
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t value);
+void attachInterrupt(uint8_t pin, void (*isr)(), int mode);
+void detachInterrupt(uint8_t pin);
+void noInterrupts();
+void interrupts();
+inline uint32_t xt_rsil(uint32_t) { return 0; }
+inline void xt_wsr_ps(uint32_t) {}
+
+// Time
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+// Soak runs: millis() and micros() follow a virtual clock that delay()
+// advances at once instead of sleeping
+void nativeVirtualClock(bool enable);
+
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+
+template <typename T> T constrain(T x, T low, T high) {
+    return x < low ? low : (x > high ? high : x);
+}
+
+// Timer1 (stepper ISR); never fires on the host. It does not count down
+// either: timer1_read() returns the last value written, nativeTimer1Load,
+// which a test can lower to stand for time passed since then.
+#define TIM_DIV1 0
+#define TIM_DIV16 1
+#define TIM_DIV256 3
+#define TIM_EDGE 0
+#define TIM_SINGLE 0
+#define TIM_LOOP 1
+
+void timer1_isr_init();
+void timer1_attachInterrupt(void (*isr)());
+void timer1_detachInterrupt();
+void timer1_enable(uint8_t divider, uint8_t interruptType, uint8_t reload);
+void timer1_disable();
+void timer1_write(uint32_t ticks);
+uint32_t timer1_read();
+extern uint32_t nativeTimer1Load;
+
+// Emulated device heap: a first-fit arena the size of the ESP8266's free
+// heap at boot, with umm_malloc's 8-byte blocks and 4-byte header. String
+// allocates from it and the ESP heap figures report on it, so heap use and
+// fragmentation show up in host runs.
+#define NATIVE_HEAP_SIZE 40000
+
+void* nativeHeapAlloc(size_t size);
+void nativeHeapRelease(void* ptr);
+bool nativeHeapOwns(const void* ptr);  // ptr came from nativeHeapAlloc()
+uint32_t nativeHeapFreeBytes();
+uint32_t nativeHeapMaxBlock();
+uint8_t nativeHeapFragmentation();
+extern uint32_t nativeHeapAllocations;  // successful nativeHeapAlloc() calls
+
+template <typename T> struct NativeHeapAllocator {
+    typedef T value_type;
+    NativeHeapAllocator() {}
+    template <typename U> NativeHeapAllocator(const NativeHeapAllocator<U>&) {}
+    T* allocate(size_t n) {
+        void* p = nativeHeapAlloc(n * sizeof(T));
+        if (!p) throw std::bad_alloc();
+        return (T*)p;
+    }
+    void deallocate(T* p, size_t) { nativeHeapRelease(p); }
+    template <typename U> bool operator==(const NativeHeapAllocator<U>&) const { return true; }
+    template <typename U> bool operator!=(const NativeHeapAllocator<U>&) const { return false; }
+};
+
+// Arduino String over std::basic_string on the emulated heap; covers what
+// src/ uses
+class String {
+public:
+    typedef std::basic_string<char, std::char_traits<char>, NativeHeapAllocator<char>> Storage;
+    Storage s;
+
+    String() {}
+    String(const char* c) : s(c ? c : "") {}
+    String(const Storage& x) : s(x) {}
+    String(const std::string& x) : s(x.data(), x.size()) {}
+    String(char c) : s(1, c) {}
+    String(int v) : String(std::to_string(v)) {}
+    String(unsigned v) : String(std::to_string(v)) {}
+    String(long v) : String(std::to_string(v)) {}
+    String(unsigned long v) : String(std::to_string(v)) {}
+    String(float v) : String(std::to_string(v)) {}
+
+    const char* c_str() const { return s.c_str(); }
+    unsigned length() const { return s.size(); }
+    void reserve(unsigned n) { s.reserve(n); }
+    String substring(unsigned from) const { return s.substr(from); }
+    String substring(unsigned from, unsigned to) const { return s.substr(from, to - from); }
+    int toInt() const { return atoi(s.c_str()); }
+
+    char operator[](unsigned i) const { return s[i]; }
+    String& operator+=(const String& o) { s += o.s; return *this; }
+    String& operator+=(const char* o) { s += o; return *this; }
+    String& operator+=(char c) { s += c; return *this; }
+    bool operator==(const String& o) const { return s == o.s; }
+    bool operator==(const char* o) const { return s == o; }
+    bool operator!=(const char* o) const { return s != o; }
+};
+
+inline String operator+(const String& a, const String& b) { return String(a.s + b.s); }
+inline String operator+(const String& a, const char* b) { return String(a.s + b); }
+inline String operator+(const char* a, const String& b) { return String(a + b.s); }
+
+class IPAddress {
+public:
+    uint8_t b[4] = { 0, 0, 0, 0 };
+
+    IPAddress() {}
+    IPAddress(uint8_t a, uint8_t b1, uint8_t c, uint8_t d) { b[0] = a; b[1] = b1; b[2] = c; b[3] = d; }
+    IPAddress(uint32_t v) { memcpy(b, &v, 4); }
+    operator uint32_t() const { uint32_t v; memcpy(&v, b, 4); return v; }
+    uint8_t operator[](int i) const { return b[i]; }
+    bool isSet() const { return (uint32_t)*this != 0; }
+
+    String toString() const {
+        char str[16];
+        snprintf(str, sizeof(str), "%u.%u.%u.%u", b[0], b[1], b[2], b[3]);
+        return String(str);
+    }
+
+    bool fromString(const char* str) {
+        unsigned a, b1, c, d;
+        if (sscanf(str, "%u.%u.%u.%u", &a, &b1, &c, &d) != 4 || a > 255 || b1 > 255 || c > 255 || d > 255) return false;
+        *this = IPAddress(a, b1, c, d);
+        return true;
+    }
+};
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buf, size_t size) {
+        size_t n = 0;
+        while (size--) n += write(*buf++);
+        return n;
+    }
+    size_t write(const char* str) { return write((const uint8_t*)str, strlen(str)); }
+
+    size_t print(const char* str) { return write(str); }
+    size_t print(const String& str) { return write(str.c_str()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int v) { return print(String(v)); }
+    size_t print(unsigned v) { return print(String(v)); }
+    size_t print(long v) { return print(String(v)); }
+    size_t print(unsigned long v) { return print(String(v)); }
+    size_t print(const IPAddress& ip) { return print(ip.toString()); }
+    size_t println() { return write("\r\n"); }
+    template <typename T> size_t println(const T& v) { return print(v) + println(); }
+
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+        char buf[256];
+        va_list args;
+        va_start(args, format);
+        int n = vsnprintf(buf, sizeof(buf), format, args);
+        va_end(args);
+        if (n < 0) return 0;
+        return write((const uint8_t*)buf, std::min<size_t>(n, sizeof(buf) - 1));
+    }
+};
+
+// Serial goes to stdout. With nativeSerialModel(true) it goes nowhere
+// instead: bytes enter a 128-byte TX FIFO that drains at the baud rate in
+// real time, and write() waits for room like the ESP8266 core does, so a
+// benchmark sees what printing costs the caller.
+#define NATIVE_SERIAL_FIFO 128
+
+void nativeSerialModel(bool enable);
+extern uint64_t nativeSerialBytes;  // bytes written while modelled
+
+class HardwareSerial : public Print {
+public:
+    void begin(unsigned long baud);
+    int availableForWrite();
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* buf, size_t size) override;
+    using Print::write;
+
+private:
+    unsigned long baud = 115200;
+};
+
+extern HardwareSerial Serial;
+
+// Reset cause, as reported by the ESP8266 SDK
+enum rst_reason {
+    REASON_DEFAULT_RST = 0,  // power on
+    REASON_WDT_RST,
+    REASON_EXCEPTION_RST,
+    REASON_SOFT_WDT_RST,
+    REASON_SOFT_RESTART,
+    REASON_DEEP_SLEEP_AWAKE,
+    REASON_EXT_SYS_RST
+};
+
+struct rst_info {
+    uint32_t reason;
+    uint32_t exccause;
+    uint32_t epc1, epc2, epc3;
+    uint32_t excvaddr;
+    uint32_t depc;
+};
+
+// ESP object: heap figures come from the emulated heap, RTC memory is a RAM
+// array, the flash calls are unused (flash_utils.h has its own host
+// emulator). The chip id
+// and reset reason can be set per process with NATIVE_CHIP_ID and
+// NATIVE_RESET_REASON (a rst_reason number; default power on).
+class EspClass {
+public:
+    uint32_t getFreeHeap() { return nativeHeapFreeBytes(); }
+    uint32_t getMaxFreeBlockSize() { return nativeHeapMaxBlock(); }
+    uint8_t getHeapFragmentation() { return nativeHeapFragmentation(); }
+    uint32_t getChipId();
+    rst_info* getResetInfoPtr();
+    uint32_t getCycleCount();  // wall clock at F_CPU, even under the virtual clock
+    bool rtcUserMemoryRead(uint32_t offset, uint32_t* data, size_t size);
+    bool rtcUserMemoryWrite(uint32_t offset, uint32_t* data, size_t size);
+    bool flashEraseSector(uint32_t) { return false; }
+    bool flashWrite(uint32_t, const uint32_t*, size_t) { return false; }
+    bool flashRead(uint32_t, uint32_t*, size_t) { return false; }
+    void restart();
+};
+
+extern EspClass ESP;
+
+#endif // NATIVE_ARDUINO_H
@@ -0,0 +1,28 @@
+#ifndef NATIVE_EEPROM_H
+#define NATIVE_EEPROM_H
+
+// Host stand-in for the ESP8266 EEPROM library: a RAM image that starts
+// erased (0xFF), like a fresh board
+
+#include <Arduino.h>
+
+#define NATIVE_EEPROM_SIZE 4096
+
+class EEPROMClass {
+public:
+    EEPROMClass() { memset(data, 0xFF, sizeof(data)); }
+    void begin(size_t size) { this->size = std::min<size_t>(size, sizeof(data)); }
+    uint8_t read(int address) { return (size_t)address < size ? data[address] : 0; }
+    void write(int address, uint8_t value) { if ((size_t)address < size) data[address] = value; }
+    bool commit() { return true; }
+    void end() { size = 0; }
+
+    uint8_t data[NATIVE_EEPROM_SIZE];
+
+private:
+    size_t size = 0;
+};
+
+extern EEPROMClass EEPROM;
+
+#endif // NATIVE_EEPROM_H
@@ -0,0 +1,117 @@
+#ifndef NATIVE_ESP8266WIFI_H
+#define NATIVE_ESP8266WIFI_H
+
+// Host stand-in for ESP8266WiFi: begin() associates to "native" at once and
+// WiFiClient is a plain TCP socket. Names ending in .local resolve to
+// NATIVE_MDNS_HOST (default 127.0.0.1), anything else through the system.
+// With the loopback broker enabled, connects to port 1883 reach the
+// in-process MQTT broker below instead of the network.
+
+#include <Arduino.h>
+
+typedef enum {
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_WRONG_PASSWORD = 6,
+    WL_DISCONNECTED = 7
+} wl_status_t;
+
+typedef enum { WIFI_OFF = 0, WIFI_STA = 1, WIFI_AP = 2, WIFI_AP_STA = 3 } WiFiMode_t;
+typedef enum { WIFI_NONE_SLEEP = 0, WIFI_LIGHT_SLEEP = 1, WIFI_MODEM_SLEEP = 2 } WiFiSleepType_t;
+
+class ESP8266WiFiClass {
+public:
+    wl_status_t status() { return associated ? WL_CONNECTED : WL_DISCONNECTED; }
+    bool mode(WiFiMode_t m) {
+        if (!(m & WIFI_STA)) associated = false;
+        return true;
+    }
+    wl_status_t begin(const char*, const char* = nullptr, int32_t = 0, const uint8_t* = nullptr, bool = true) {
+        associated = true;
+        return WL_CONNECTED;
+    }
+    bool config(IPAddress, IPAddress, IPAddress, IPAddress = IPAddress(), IPAddress = IPAddress()) { return true; }
+    bool disconnect(bool = false) { associated = false; return true; }
+    bool persistent(bool) { return true; }
+    bool setSleepMode(WiFiSleepType_t, uint8_t = 0) { return true; }
+
+    bool softAP(const char*, const char* = nullptr) { return true; }
+    bool softAPConfig(IPAddress, IPAddress, IPAddress) { return true; }
+    bool softAPdisconnect(bool = false) { return true; }
+    IPAddress softAPIP() { return IPAddress(192, 168, 1, 1); }
+
+    String SSID() { return String("native"); }
+    IPAddress localIP() { return IPAddress(127, 0, 0, 1); }
+    IPAddress gatewayIP() { return IPAddress(127, 0, 0, 1); }
+    IPAddress subnetMask() { return IPAddress(255, 0, 0, 0); }
+    IPAddress dnsIP(uint8_t = 0) { return IPAddress(127, 0, 0, 1); }
+    int32_t RSSI() { return -60; }
+    int32_t channel() { return 6; }
+    uint8_t* BSSID() { static uint8_t bssid[6] = { 0x02, 0, 0, 0, 0, 0x01 }; return bssid; }
+
+    int hostByName(const char* host, IPAddress& result);
+
+private:
+    bool associated = false;
+};
+
+extern ESP8266WiFiClass WiFi;
+
+class Client : public Print {
+public:
+    virtual int connect(IPAddress ip, uint16_t port) = 0;
+    virtual int connect(const char* host, uint16_t port) = 0;
+    virtual size_t write(uint8_t c) override = 0;
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual void stop() = 0;
+    virtual uint8_t connected() = 0;
+    using Print::write;
+};
+
+// Non-blocking TCP socket; connect and write wait up to setTimeout()
+class WiFiClient : public Client {
+public:
+    ~WiFiClient() { stop(); }
+    int connect(IPAddress ip, uint16_t port) override;
+    int connect(const char* host, uint16_t port) override;
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* buf, size_t size) override;
+    int available() override;
+    int read() override;
+    void stop() override;
+    uint8_t connected() override;
+    void setTimeout(unsigned long ms) { timeoutMs = ms; }
+    void setNoDelay(bool noDelay);
+    using Print::write;
+
+private:
+    int fd = -1;
+    bool loopback = false;  // attached to the loopback broker
+    unsigned long timeoutMs = 1000;
+};
+
+// Loopback MQTT broker for tests and the soak (also NATIVE_MQTT_LOOPBACK=1):
+// one session at a time, CONNACK/SUBACK/PINGRESP, exact-match
+// subscriptions, and fixed buffers only, so it allocates nothing while the
+// firmware runs. Messages the firmware publishes go to
+// nativeBrokerOnPublish; nativeBrokerPublish() sends one to the firmware
+// if it subscribed to the topic.
+#define NATIVE_BROKER_PORT 1883
+
+typedef void (*NativeBrokerPublishHook)(const char* topic, const uint8_t* payload, size_t length, bool retained);
+
+void nativeBrokerEnable(bool enable);
+bool nativeBrokerConnected();
+bool nativeBrokerSubscribed(const char* topic);
+bool nativeBrokerPublish(const char* topic, const char* payload, uint8_t qos = 1);
+void nativeBrokerDisconnect();  // the broker drops the session
+
+extern NativeBrokerPublishHook nativeBrokerOnPublish;
+extern uint32_t nativeBrokerConnects;
+extern uint32_t nativeBrokerPublishes;     // received from the firmware
+extern uint32_t nativeBrokerPublishBytes;  // their payload bytes
+
+#endif // NATIVE_ESP8266WIFI_H
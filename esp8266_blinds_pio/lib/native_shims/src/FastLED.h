@@ -0,0 +1,38 @@
+#ifndef NATIVE_FASTLED_H
+#define NATIVE_FASTLED_H
+
+// Host stand-in for FastLED: colors are stored, show() does nothing
+
+#include <Arduino.h>
+
+#define WS2812B 0
+#define GRB 0
+
+struct CRGB {
+    uint8_t r, g, b;
+
+    enum HTMLColorCode { Black = 0x000000 };
+
+    CRGB() : r(0), g(0), b(0) {}
+    CRGB(uint8_t r, uint8_t g, uint8_t b) : r(r), g(g), b(b) {}
+    CRGB(HTMLColorCode code) : r(code >> 16), g(code >> 8), b(code) {}
+
+    bool operator==(const CRGB& o) const { return r == o.r && g == o.g && b == o.b; }
+    bool operator!=(const CRGB& o) const { return !(*this == o); }
+};
+
+class CFastLED {
+public:
+    template <int TYPE, int PIN, int ORDER> void addLeds(CRGB* leds, int count) { (void)leds; (void)count; }
+    void setBrightness(uint8_t scale) { brightness = scale; }
+    uint8_t getBrightness() { return brightness; }
+    void clear() {}
+    void show() {}
+
+private:
+    uint8_t brightness = 255;
+};
+
+extern CFastLED FastLED;
+
+#endif // NATIVE_FASTLED_H
@@ -0,0 +1,338 @@
+#ifndef NATIVE_PUBSUBCLIENT_H
+#define NATIVE_PUBSUBCLIENT_H
+
+// Host stand-in for PubSubClient: a small MQTT 3.1.1 client over the shim
+// WiFiClient, so env:native can talk to a real broker (mosquitto) or the
+// loopback broker in ESP8266WiFi.h. Same behaviour as the library where src/
+// depends on it: one packet buffer of getBufferSize() bytes allocated up
+// front, blocking connect that waits for CONNACK, QoS 0 publishes, QoS 1
+// deliveries acknowledged in loop(), keepalive pings, and the same state()
+// codes. Nothing is allocated per packet.
+//
+// When NATIVE_CHIP_ID is set the client id gets "-<id>" appended, so many
+// instances of the same build can share one broker. publishCount and
+// publishBytes count everything sent.
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+
+#define MQTT_CONNECTION_TIMEOUT -4
+#define MQTT_CONNECTION_LOST -3
+#define MQTT_CONNECT_FAILED -2
+#define MQTT_DISCONNECTED -1
+#define MQTT_CONNECTED 0
+
+#define MQTT_MAX_HEADER_SIZE 5
+
+#define MQTT_CALLBACK_SIGNATURE void (*callback)(char*, uint8_t*, unsigned int)
+
+class PubSubClient : public Print {
+public:
+    PubSubClient() { setBufferSize(256); }
+    PubSubClient(Client& client) : client(&client) { setBufferSize(256); }
+    ~PubSubClient() { free(buffer); }
+
+    PubSubClient& setServer(const char* host, uint16_t port) {
+        snprintf(serverHost, sizeof(serverHost), "%s", host);
+        serverPort = port;
+        return *this;
+    }
+    PubSubClient& setServer(IPAddress ip, uint16_t port) {
+        snprintf(serverHost, sizeof(serverHost), "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+        serverPort = port;
+        return *this;
+    }
+    PubSubClient& setClient(Client& client) { this->client = &client; return *this; }
+    PubSubClient& setCallback(MQTT_CALLBACK_SIGNATURE) { this->callback = callback; return *this; }
+    PubSubClient& setKeepAlive(uint16_t seconds) { keepAliveS = seconds; return *this; }
+    PubSubClient& setSocketTimeout(uint16_t seconds) { socketTimeoutS = seconds; return *this; }
+    bool setBufferSize(uint16_t size) {
+        if (size == 0) return false;
+        uint8_t* resized = (uint8_t*)realloc(buffer, size);
+        if (!resized) return false;
+        buffer = resized;
+        bufferSize = size;
+        return true;
+    }
+    uint16_t getBufferSize() { return bufferSize; }
+
+    bool connect(const char* id) { return connect(id, nullptr, nullptr, nullptr, 0, false, nullptr, true); }
+    bool connect(const char* id, const char* user, const char* pass) {
+        return connect(id, user, pass, nullptr, 0, false, nullptr, true);
+    }
+    bool connect(const char* id, const char* willTopic, uint8_t willQos, bool willRetain, const char* willMessage) {
+        return connect(id, nullptr, nullptr, willTopic, willQos, willRetain, willMessage, true);
+    }
+    bool connect(const char* id, const char* user, const char* pass, const char* willTopic, uint8_t willQos,
+                 bool willRetain, const char* willMessage) {
+        return connect(id, user, pass, willTopic, willQos, willRetain, willMessage, true);
+    }
+
+    bool connect(const char* id, const char* user, const char* pass, const char* willTopic, uint8_t willQos,
+                 bool willRetain, const char* willMessage, bool cleanSession) {
+        if (connected()) return true;
+        if (!client || !client->connect(serverHost, serverPort)) {
+            mqttState = MQTT_CONNECT_FAILED;
+            return false;
+        }
+
+        char clientId[96];
+        const char* chipId = getenv("NATIVE_CHIP_ID");
+        if (chipId && *chipId) snprintf(clientId, sizeof(clientId), "%s-%s", id, chipId);
+        else snprintf(clientId, sizeof(clientId), "%s", id);
+
+        uint8_t flags = cleanSession ? 0x02 : 0;
+        if (willTopic) flags |= 0x04 | (willQos << 3) | (willRetain ? 0x20 : 0);
+        if (user) flags |= 0x80;
+        if (user && pass) flags |= 0x40;
+
+        size_t length = MQTT_MAX_HEADER_SIZE;
+        static const uint8_t protocol[] = { 0x00, 0x04, 'M', 'Q', 'T', 'T', 0x04 };
+        bool ok = appendBytes(length, protocol, sizeof(protocol));
+        uint8_t options[] = { flags, (uint8_t)(keepAliveS >> 8), (uint8_t)keepAliveS };
+        ok = ok && appendBytes(length, options, sizeof(options)) && appendString(length, clientId);
+        if (willTopic) ok = ok && appendString(length, willTopic) && appendString(length, willMessage ? willMessage : "");
+        if (user) ok = ok && appendString(length, user);
+        if (user && pass) ok = ok && appendString(length, pass);
+        if (!ok || !sendPacket(0x10, length)) {
+            dropConnection(MQTT_CONNECTION_LOST);
+            return false;
+        }
+
+        uint8_t type;
+        size_t replyLength;
+        if (!readPacket(type, replyLength, socketTimeoutS * 1000UL)) {
+            dropConnection(MQTT_CONNECTION_TIMEOUT);
+            return false;
+        }
+        if ((type & 0xF0) != 0x20 || replyLength < 2 || buffer[1] != 0) {
+            dropConnection(replyLength >= 2 ? buffer[1] : MQTT_CONNECT_FAILED);
+            return false;
+        }
+        mqttState = MQTT_CONNECTED;
+        lastInMs = lastOutMs = millis();
+        pingOutstanding = false;
+        return true;
+    }
+
+    void disconnect() {
+        if (client && mqttState == MQTT_CONNECTED) sendPacket(0xE0, MQTT_MAX_HEADER_SIZE);
+        if (client) client->stop();
+        mqttState = MQTT_DISCONNECTED;
+    }
+
+    bool connected() {
+        if (!client || mqttState != MQTT_CONNECTED) return false;
+        if (!client->connected()) {
+            dropConnection(MQTT_CONNECTION_LOST);
+            return false;
+        }
+        return true;
+    }
+
+    int state() { return mqttState; }
+
+    bool loop() {
+        if (!connected()) return false;
+        unsigned long now = millis();
+        if (keepAliveS && (now - lastInMs > keepAliveS * 1000UL || now - lastOutMs > keepAliveS * 1000UL)) {
+            if (pingOutstanding) {
+                dropConnection(MQTT_CONNECTION_TIMEOUT);
+                return false;
+            }
+            sendPacket(0xC0, MQTT_MAX_HEADER_SIZE);
+            pingOutstanding = true;
+        }
+
+        uint8_t type;
+        size_t length;
+        while (client->available()) {
+            if (!readPacket(type, length, socketTimeoutS * 1000UL)) {
+                dropConnection(MQTT_CONNECTION_LOST);
+                return false;
+            }
+            lastInMs = millis();
+            switch (type & 0xF0) {
+                case 0x30: handlePublish(type, length); break;
+                case 0xC0: sendPacket(0xD0, MQTT_MAX_HEADER_SIZE); break;
+                case 0xD0: pingOutstanding = false; break;
+                default: break;  // SUBACK, UNSUBACK
+            }
+        }
+        return true;
+    }
+
+    bool subscribe(const char* topic) { return subscribe(topic, 0); }
+    bool subscribe(const char* topic, uint8_t qos) {
+        if (!connected() || qos > 1) return false;
+        size_t length = MQTT_MAX_HEADER_SIZE;
+        if (!appendPacketId(length) || !appendString(length, topic) || !appendBytes(length, &qos, 1)) return false;
+        return sendPacket(0x82, length);
+    }
+    bool unsubscribe(const char* topic) {
+        if (!connected()) return false;
+        size_t length = MQTT_MAX_HEADER_SIZE;
+        if (!appendPacketId(length) || !appendString(length, topic)) return false;
+        return sendPacket(0xA2, length);
+    }
+
+    bool publish(const char* topic, const char* payload) { return publish(topic, payload, false); }
+    bool publish(const char* topic, const char* payload, bool retained) {
+        return publish(topic, (const uint8_t*)payload, strlen(payload), retained);
+    }
+    bool publish(const char* topic, const uint8_t* payload, unsigned int length) {
+        return publish(topic, payload, length, false);
+    }
+    // Like the library: the whole packet has to fit the buffer
+    bool publish(const char* topic, const uint8_t* payload, unsigned int length, bool retained) {
+        if (!connected()) return false;
+        size_t packetLength = MQTT_MAX_HEADER_SIZE;
+        if (!appendString(packetLength, topic) || !appendBytes(packetLength, payload, length)) return false;
+        if (!sendPacket(0x30 | (retained ? 1 : 0), packetLength)) return false;
+        publishCount++;
+        publishBytes += length;
+        return true;
+    }
+
+    // Header now, payload through write(); the length must be exact
+    bool beginPublish(const char* topic, unsigned int length, bool retained) {
+        if (!connected()) return false;
+        size_t headerLength = MQTT_MAX_HEADER_SIZE;
+        if (!appendString(headerLength, topic)) return false;
+        size_t start = writeFixedHeader(0x30 | (retained ? 1 : 0), headerLength - MQTT_MAX_HEADER_SIZE + length);
+        if (!sendRaw(buffer + start, headerLength - start)) return false;
+        publishCount++;
+        publishBytes += length;
+        return true;
+    }
+    int endPublish() { return connected() ? 1 : 0; }
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* buf, size_t size) override {
+        if (!client) return 0;
+        lastOutMs = millis();
+        return client->write(buf, size);
+    }
+    using Print::write;
+
+    uint32_t publishCount = 0;
+    uint32_t publishBytes = 0;
+
+private:
+    // Packets are built at buffer + MQTT_MAX_HEADER_SIZE; the fixed header
+    // is written in front of the body once its length is known
+    bool appendBytes(size_t& length, const void* data, size_t size) {
+        if (length + size > bufferSize) return false;
+        memcpy(buffer + length, data, size);
+        length += size;
+        return true;
+    }
+
+    bool appendString(size_t& length, const char* str) {
+        size_t len = strlen(str);
+        uint8_t prefix[2] = { (uint8_t)(len >> 8), (uint8_t)len };
+        return appendBytes(length, prefix, 2) && appendBytes(length, str, len);
+    }
+
+    bool appendPacketId(size_t& length) {
+        if (++nextPacketId == 0) nextPacketId = 1;
+        uint8_t id[2] = { (uint8_t)(nextPacketId >> 8), (uint8_t)nextPacketId };
+        return appendBytes(length, id, 2);
+    }
+
+    // Returns the offset the packet starts at
+    size_t writeFixedHeader(uint8_t header, size_t bodyLength) {
+        uint8_t digits[4];
+        uint8_t n = 0;
+        do {
+            uint8_t digit = bodyLength % 128;
+            bodyLength /= 128;
+            digits[n++] = bodyLength ? digit | 0x80 : digit;
+        } while (bodyLength && n < 4);
+        size_t start = MQTT_MAX_HEADER_SIZE - 1 - n;
+        buffer[start] = header;
+        memcpy(buffer + start + 1, digits, n);
+        return start;
+    }
+
+    bool sendRaw(const uint8_t* data, size_t size) {
+        lastOutMs = millis();
+        return client->write(data, size) == size;
+    }
+
+    bool sendPacket(uint8_t header, size_t length) {
+        size_t start = writeFixedHeader(header, length - MQTT_MAX_HEADER_SIZE);
+        return sendRaw(buffer + start, length - start);
+    }
+
+    // Blocks until a whole packet is in or timeoutMs passes without a byte
+    int readByte(unsigned long timeoutMs) {
+        unsigned long start = millis();
+        while (!client->available()) {
+            if (!client->connected() || millis() - start >= timeoutMs) return -1;
+            delay(1);
+        }
+        return client->read();
+    }
+
+    // Body goes to the buffer; bytes beyond it are read and dropped, and
+    // length still reports the full body
+    bool readPacket(uint8_t& type, size_t& length, unsigned long timeoutMs) {
+        int c = readByte(timeoutMs);
+        if (c < 0) return false;
+        type = (uint8_t)c;
+        length = 0;
+        for (int shift = 0; shift < 28; shift += 7) {
+            if ((c = readByte(timeoutMs)) < 0) return false;
+            length |= (size_t)(c & 0x7F) << shift;
+            if (!(c & 0x80)) break;
+        }
+        for (size_t i = 0; i < length; i++) {
+            if ((c = readByte(timeoutMs)) < 0) return false;
+            if (i < bufferSize) buffer[i] = (uint8_t)c;
+        }
+        return true;
+    }
+
+    void handlePublish(uint8_t type, size_t length) {
+        if (length < 2 || length > bufferSize) return;
+        size_t topicLen = (buffer[0] << 8) | buffer[1];
+        size_t offset = 2 + topicLen;
+        uint8_t qos = (type >> 1) & 3;
+        if (offset + (qos ? 2 : 0) > length) return;
+        if (qos) {
+            uint8_t ack[MQTT_MAX_HEADER_SIZE + 2];
+            ack[MQTT_MAX_HEADER_SIZE - 2] = 0x40;  // PUBACK
+            ack[MQTT_MAX_HEADER_SIZE - 1] = 2;
+            memcpy(ack + MQTT_MAX_HEADER_SIZE, buffer + offset, 2);
+            sendRaw(ack + MQTT_MAX_HEADER_SIZE - 2, 4);
+            offset += 2;
+        }
+        // The library drops packets larger than its buffer
+        if (!callback || length + MQTT_MAX_HEADER_SIZE > bufferSize) return;
+        // The topic is NUL-terminated in place, as the library does
+        memmove(buffer + 1, buffer + 2, topicLen);
+        buffer[1 + topicLen] = '\0';
+        callback((char*)buffer + 1, buffer + offset, length - offset);
+    }
+
+    void dropConnection(int newState) {
+        if (client) client->stop();
+        mqttState = newState;
+    }
+
+    Client* client = nullptr;
+    char serverHost[128] = "";
+    uint16_t serverPort = 1883;
+    void (*callback)(char*, uint8_t*, unsigned int) = nullptr;
+    uint8_t* buffer = nullptr;
+    uint16_t bufferSize = 0;
+    uint16_t keepAliveS = 15;
+    uint16_t socketTimeoutS = 15;
+    uint16_t nextPacketId = 0;
+    int mqttState = MQTT_DISCONNECTED;
+    unsigned long lastInMs = 0;
+    unsigned long lastOutMs = 0;
+    bool pingOutstanding = false;
+};
+
+#endif // NATIVE_PUBSUBCLIENT_H
@@ -0,0 +1,28 @@
+#ifndef NATIVE_WIFIUDP_H
+#define NATIVE_WIFIUDP_H
+
+// Host stand-in for WiFiUDP: outgoing datagrams only (log_utils.h syslog)
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+
+#include <string>
+
+class WiFiUDP : public Print {
+public:
+    ~WiFiUDP();
+    int beginPacket(const char* host, uint16_t port);
+    int beginPacket(IPAddress ip, uint16_t port);
+    size_t write(uint8_t c) override { packet += (char)c; return 1; }
+    size_t write(const uint8_t* buf, size_t size) override { packet.append((const char*)buf, size); return size; }
+    int endPacket();
+    using Print::write;
+
+private:
+    int fd = -1;
+    IPAddress remoteIp;
+    uint16_t remotePort = 0;
+    std::string packet;
+};
+
+#endif // NATIVE_WIFIUDP_H
@@ -0,0 +1,591 @@
+// Globals and out-of-line functions for the env:native shims
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <ESP8266WiFi.h>
+#include <FastLED.h>
+#include <WiFiUdp.h>
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <thread>
+
+HardwareSerial Serial;
+EspClass ESP;
+EEPROMClass EEPROM;
+ESP8266WiFiClass WiFi;
+CFastLED FastLED;
+
+volatile uint32_t GPOS, GPOC;
+
+static const auto bootTime = std::chrono::steady_clock::now();
+static bool virtualClock = false;
+static uint64_t virtualClockUs = 0;
+
+// Wall-clock nanoseconds since start, whatever the virtual clock does
+static uint64_t steadyNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - bootTime).count();
+}
+
+static uint64_t clockUs() {
+    if (virtualClock) return virtualClockUs;
+    return steadyNs() / 1000;
+}
+
+void nativeVirtualClock(bool enable) {
+    if (enable && !virtualClock) virtualClockUs = clockUs();
+    virtualClock = enable;
+}
+
+// Serial TX model: the FIFO holds whatever has not gone out on the line
+// by serialFifoEmptyNs, one 8N1 byte time per byte
+static bool serialModel = false;
+static uint64_t serialFifoEmptyNs = 0;
+uint64_t nativeSerialBytes = 0;
+
+void nativeSerialModel(bool enable) {
+    serialModel = enable;
+    serialFifoEmptyNs = 0;
+}
+
+void HardwareSerial::begin(unsigned long rate) {
+    baud = rate;
+    setvbuf(stdout, nullptr, _IOLBF, 0);
+}
+
+int HardwareSerial::availableForWrite() {
+    if (!serialModel) return NATIVE_SERIAL_FIFO;
+    uint64_t byteNs = 10000000000ULL / baud;
+    uint64_t now = steadyNs();
+    uint64_t queued = serialFifoEmptyNs > now ? (serialFifoEmptyNs - now + byteNs - 1) / byteNs : 0;
+    return queued >= NATIVE_SERIAL_FIFO ? 0 : NATIVE_SERIAL_FIFO - (int)queued;
+}
+
+size_t HardwareSerial::write(const uint8_t* buf, size_t size) {
+    if (!serialModel) return fwrite(buf, 1, size, stdout);
+    uint64_t byteNs = 10000000000ULL / baud;
+    for (size_t i = 0; i < size; i++) {
+        while (availableForWrite() == 0) {}
+        uint64_t now = steadyNs();
+        serialFifoEmptyNs = (serialFifoEmptyNs > now ? serialFifoEmptyNs : now) + byteNs;
+    }
+    nativeSerialBytes += size;
+    return size;
+}
+
+unsigned long millis() {
+    return clockUs() / 1000;
+}
+
+unsigned long micros() {
+    return clockUs();
+}
+
+void delay(unsigned long ms) {
+    fflush(stdout);
+    if (virtualClock) virtualClockUs += ms * 1000ULL;
+    else std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(unsigned int us) {
+    if (virtualClock) virtualClockUs += us;
+    else std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+void yield() {}
+
+// Inputs read high: buttons (active low) are released
+void pinMode(uint8_t, uint8_t) {}
+int digitalRead(uint8_t) { return HIGH; }
+void digitalWrite(uint8_t, uint8_t) {}
+void attachInterrupt(uint8_t, void (*)(), int) {}
+void detachInterrupt(uint8_t) {}
+void noInterrupts() {}
+void interrupts() {}
+
+long random(long max) { return max > 0 ? rand() % max : 0; }
+long random(long min, long max) { return max > min ? min + rand() % (max - min) : min; }
+void randomSeed(unsigned long seed) { srand(seed); }
+
+void timer1_isr_init() {}
+void timer1_attachInterrupt(void (*)()) {}
+void timer1_detachInterrupt() {}
+void timer1_enable(uint8_t, uint8_t, uint8_t) {}
+void timer1_disable() {}
+uint32_t nativeTimer1Load = 0;
+void timer1_write(uint32_t ticks) { nativeTimer1Load = ticks; }
+uint32_t timer1_read() { return nativeTimer1Load; }
+
+// 512 bytes of RTC user memory, addressed in 4-byte blocks; survives
+// nothing, just like a cold boot
+static uint32_t rtcUserMemory[128];
+
+bool EspClass::rtcUserMemoryRead(uint32_t offset, uint32_t* data, size_t size) {
+    if (offset * 4 + size > sizeof(rtcUserMemory)) return false;
+    memcpy(data, rtcUserMemory + offset, size);
+    return true;
+}
+
+bool EspClass::rtcUserMemoryWrite(uint32_t offset, uint32_t* data, size_t size) {
+    if (offset * 4 + size > sizeof(rtcUserMemory)) return false;
+    memcpy(rtcUserMemory + offset, data, size);
+    return true;
+}
+
+// Emulated device heap. Blocks are contiguous; each starts with a 4-byte
+// header holding its size in bytes (header included, a multiple of 8) with
+// bit 0 set while in use. Free neighbours are merged as the walk passes.
+alignas(8) static uint8_t heapArena[NATIVE_HEAP_SIZE / 8 * 8];
+static bool heapReady = false;
+uint32_t nativeHeapAllocations = 0;
+
+static uint32_t& heapHeader(size_t offset) {
+    if (!heapReady) {
+        heapReady = true;
+        heapHeader(0) = sizeof(heapArena);
+    }
+    return *(uint32_t*)(heapArena + offset);
+}
+
+// Size of the free block at offset after absorbing the free ones behind it
+static uint32_t heapMergeFree(size_t offset) {
+    uint32_t size = heapHeader(offset);
+    while (offset + size < sizeof(heapArena) && !(heapHeader(offset + size) & 1)) size += heapHeader(offset + size);
+    heapHeader(offset) = size;
+    return size;
+}
+
+void* nativeHeapAlloc(size_t size) {
+    uint32_t need = (size + 4 + 7) & ~(size_t)7;
+    for (size_t offset = 0; offset < sizeof(heapArena);) {
+        if (heapHeader(offset) & 1) {
+            offset += heapHeader(offset) & ~1U;
+            continue;
+        }
+        uint32_t free = heapMergeFree(offset);
+        if (free >= need) {
+            if (free - need >= 8) heapHeader(offset + need) = free - need;
+            else need = free;
+            heapHeader(offset) = need | 1;
+            nativeHeapAllocations++;
+            return heapArena + offset + 4;
+        }
+        offset += free;
+    }
+    return nullptr;
+}
+
+void nativeHeapRelease(void* ptr) {
+    if (ptr) heapHeader((uint8_t*)ptr - heapArena - 4) &= ~1U;
+}
+
+bool nativeHeapOwns(const void* ptr) {
+    return ptr >= heapArena && ptr < heapArena + sizeof(heapArena);
+}
+
+// Free space in bytes, largest usable block, and the core's fragmentation
+// figure: 100 - 100 * sqrt(sum of squared free block sizes) / free bytes
+static void heapStats(uint32_t& freeBytes, uint32_t& maxBlock, uint8_t& fragmentation) {
+    double squares = 0;
+    freeBytes = maxBlock = 0;
+    for (size_t offset = 0; offset < sizeof(heapArena);) {
+        uint32_t size = heapHeader(offset) & ~1U;
+        if (!(heapHeader(offset) & 1)) {
+            size = heapMergeFree(offset);
+            freeBytes += size;
+            squares += (double)size * size;
+            if (size - 4 > maxBlock) maxBlock = size - 4;
+        }
+        offset += size;
+    }
+    fragmentation = freeBytes ? (uint8_t)(100 - 100 * sqrt(squares) / freeBytes) : 0;
+}
+
+uint32_t nativeHeapFreeBytes() {
+    uint32_t freeBytes, maxBlock;
+    uint8_t fragmentation;
+    heapStats(freeBytes, maxBlock, fragmentation);
+    return freeBytes;
+}
+
+uint32_t nativeHeapMaxBlock() {
+    uint32_t freeBytes, maxBlock;
+    uint8_t fragmentation;
+    heapStats(freeBytes, maxBlock, fragmentation);
+    return maxBlock;
+}
+
+uint8_t nativeHeapFragmentation() {
+    uint32_t freeBytes, maxBlock;
+    uint8_t fragmentation;
+    heapStats(freeBytes, maxBlock, fragmentation);
+    return fragmentation;
+}
+
+static uint32_t envNumber(const char* name, uint32_t fallback) {
+    const char* value = getenv(name);
+    return (value && *value) ? (uint32_t)strtoul(value, nullptr, 0) : fallback;
+}
+
+uint32_t EspClass::getChipId() {
+    return envNumber("NATIVE_CHIP_ID", 0x00C0FFEE);
+}
+
+rst_info* EspClass::getResetInfoPtr() {
+    static rst_info info = { envNumber("NATIVE_RESET_REASON", REASON_DEFAULT_RST), 0, 0, 0, 0, 0, 0 };
+    return &info;
+}
+
+// Real time, not clockUs(): code that busy-waits on the cycle counter
+// (the stepper ISR's pulse width) would spin forever on a virtual clock
+uint32_t EspClass::getCycleCount() {
+    return (uint32_t)(steadyNs() * (F_CPU / 1000000) / 1000);
+}
+
+void EspClass::restart() {
+    fflush(stdout);
+    exit(0);
+}
+
+// WiFi and WiFiClient
+
+int ESP8266WiFiClass::hostByName(const char* host, IPAddress& result) {
+    size_t len = strlen(host);
+    if (len > 6 && strcmp(host + len - 6, ".local") == 0) {
+        // Multicast lookups can be slow or go unanswered
+        delay(envNumber("NATIVE_MDNS_DELAY_MS", 0));
+        if ((uint32_t)random(100) < envNumber("NATIVE_MDNS_LOSS", 0)) return 0;
+        const char* mdns = getenv("NATIVE_MDNS_HOST");
+        return result.fromString(mdns && *mdns ? mdns : "127.0.0.1") ? 1 : 0;
+    }
+    if (result.fromString(host)) return 1;
+
+    struct addrinfo hints, *info;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    if (getaddrinfo(host, nullptr, &hints, &info) != 0) return 0;
+    uint32_t addr = ((struct sockaddr_in*)info->ai_addr)->sin_addr.s_addr;
+    freeaddrinfo(info);
+    result = IPAddress(addr);
+    return 1;
+}
+
+static bool waitFd(int fd, short events, unsigned long timeoutMs) {
+    struct pollfd p = { fd, events, 0 };
+    return poll(&p, 1, (int)timeoutMs) == 1 && !(p.revents & (POLLERR | POLLNVAL));
+}
+
+// Loopback MQTT broker. Packets from the client collect in brokerIn until
+// complete; replies and deliveries wait in the brokerOut ring.
+#define BROKER_IN_SIZE 8192
+#define BROKER_OUT_SIZE 4096
+#define BROKER_MAX_SUBSCRIPTIONS 16
+#define BROKER_TOPIC_MAX 128
+
+NativeBrokerPublishHook nativeBrokerOnPublish = nullptr;
+uint32_t nativeBrokerConnects = 0;
+uint32_t nativeBrokerPublishes = 0;
+uint32_t nativeBrokerPublishBytes = 0;
+
+static int brokerEnabled = -1;  // -1 = not decided yet: NATIVE_MQTT_LOOPBACK
+static bool brokerSession = false;
+static uint8_t brokerIn[BROKER_IN_SIZE];
+static size_t brokerInLen = 0;
+static uint8_t brokerOut[BROKER_OUT_SIZE];
+static size_t brokerOutHead = 0, brokerOutTail = 0;  // free-running
+static char brokerSubscriptions[BROKER_MAX_SUBSCRIPTIONS][BROKER_TOPIC_MAX];
+static uint16_t brokerPacketId = 0;
+
+void nativeBrokerEnable(bool enable) {
+    brokerEnabled = enable ? 1 : 0;
+}
+
+static bool brokerActive() {
+    if (brokerEnabled < 0) brokerEnabled = envNumber("NATIVE_MQTT_LOOPBACK", 0) ? 1 : 0;
+    return brokerEnabled == 1;
+}
+
+bool nativeBrokerConnected() {
+    return brokerSession;
+}
+
+bool nativeBrokerSubscribed(const char* topic) {
+    for (auto& subscription : brokerSubscriptions) {
+        if (subscription[0] && strcmp(subscription, topic) == 0) return true;
+    }
+    return false;
+}
+
+void nativeBrokerDisconnect() {
+    brokerSession = false;
+    brokerInLen = 0;
+    brokerOutHead = brokerOutTail = 0;
+}
+
+// Queue one packet for the client: fixed header, then the parts in order
+static bool brokerSend(uint8_t header, const uint8_t* a, size_t aLen, const uint8_t* b = nullptr, size_t bLen = 0) {
+    uint8_t fixed[5];
+    size_t n = 0, length = aLen + bLen;
+    fixed[n++] = header;
+    do {
+        uint8_t digit = length % 128;
+        length /= 128;
+        fixed[n++] = length ? digit | 0x80 : digit;
+    } while (length);
+    if (BROKER_OUT_SIZE - (brokerOutHead - brokerOutTail) < n + aLen + bLen) return false;
+    const uint8_t* parts[] = { fixed, a, b };
+    size_t sizes[] = { n, aLen, bLen };
+    for (int p = 0; p < 3; p++) {
+        for (size_t i = 0; i < sizes[p]; i++) brokerOut[brokerOutHead++ % BROKER_OUT_SIZE] = parts[p][i];
+    }
+    return true;
+}
+
+static void brokerSubscribe(const char* topic) {
+    if (nativeBrokerSubscribed(topic)) return;
+    for (auto& subscription : brokerSubscriptions) {
+        if (subscription[0]) continue;
+        snprintf(subscription, BROKER_TOPIC_MAX, "%s", topic);
+        return;
+    }
+}
+
+static void brokerUnsubscribe(const char* topic) {
+    for (auto& subscription : brokerSubscriptions) {
+        if (strcmp(subscription, topic) == 0) subscription[0] = '\0';
+    }
+}
+
+// Copy the length-prefixed string at body[offset] into out
+static bool brokerReadString(const uint8_t* body, size_t length, size_t& offset, char* out, size_t outSize) {
+    if (offset + 2 > length) return false;
+    size_t n = (body[offset] << 8) | body[offset + 1];
+    if (offset + 2 + n > length || n >= outSize) return false;
+    memcpy(out, body + offset + 2, n);
+    out[n] = '\0';
+    offset += 2 + n;
+    return true;
+}
+
+static void brokerHandle(uint8_t type, const uint8_t* body, size_t length) {
+    char topic[BROKER_TOPIC_MAX];
+    size_t offset = 0;
+    switch (type & 0xF0) {
+        case 0x10: {  // CONNECT
+            static const uint8_t accepted[] = { 0x00, 0x00 };
+            if (length > 7 && (body[7] & 0x02)) memset(brokerSubscriptions, 0, sizeof(brokerSubscriptions));
+            brokerSend(0x20, accepted, sizeof(accepted));
+            nativeBrokerConnects++;
+            break;
+        }
+        case 0x30: {  // PUBLISH
+            uint8_t qos = (type >> 1) & 3;
+            if (!brokerReadString(body, length, offset, topic, sizeof(topic))) break;
+            if (qos) {
+                if (offset + 2 > length) break;
+                brokerSend(0x40, body + offset, 2);  // PUBACK
+                offset += 2;
+            }
+            nativeBrokerPublishes++;
+            nativeBrokerPublishBytes += length - offset;
+            if (nativeBrokerOnPublish) nativeBrokerOnPublish(topic, body + offset, length - offset, type & 1);
+            break;
+        }
+        case 0x80: {  // SUBSCRIBE
+            uint8_t granted[BROKER_MAX_SUBSCRIPTIONS + 2];
+            size_t n = 2;
+            if (length < 2) break;
+            memcpy(granted, body, 2);
+            offset = 2;
+            while (n < sizeof(granted) && brokerReadString(body, length, offset, topic, sizeof(topic)) && offset < length) {
+                uint8_t qos = body[offset++];
+                brokerSubscribe(topic);
+                granted[n++] = qos > 1 ? 1 : qos;
+            }
+            brokerSend(0x90, granted, n);
+            break;
+        }
+        case 0xA0:  // UNSUBSCRIBE
+            if (length < 2) break;
+            offset = 2;
+            while (brokerReadString(body, length, offset, topic, sizeof(topic))) brokerUnsubscribe(topic);
+            brokerSend(0xB0, body, 2);
+            break;
+        case 0xC0:  // PINGREQ
+            brokerSend(0xD0, nullptr, 0);
+            break;
+        case 0xE0:  // DISCONNECT
+            nativeBrokerDisconnect();
+            break;
+        default:  // PUBACK
+            break;
+    }
+}
+
+// Bytes from the client; every complete packet is handled at once
+static size_t brokerReceive(const uint8_t* data, size_t size) {
+    if (!brokerSession) return 0;
+    if (brokerInLen + size > BROKER_IN_SIZE) {
+        fprintf(stderr, "loopback broker: packet larger than %u bytes, dropping the session\n", BROKER_IN_SIZE);
+        nativeBrokerDisconnect();
+        return 0;
+    }
+    memcpy(brokerIn + brokerInLen, data, size);
+    brokerInLen += size;
+
+    while (brokerSession && brokerInLen >= 2) {
+        size_t length = 0, pos = 1;
+        for (int shift = 0; pos < brokerInLen && shift < 28; shift += 7) {
+            length |= (size_t)(brokerIn[pos] & 0x7F) << shift;
+            if (!(brokerIn[pos++] & 0x80)) break;
+        }
+        if (brokerIn[pos - 1] & 0x80 || pos + length > brokerInLen) break;  // incomplete
+        brokerHandle(brokerIn[0], brokerIn + pos, length);
+        if (!brokerSession) break;
+        memmove(brokerIn, brokerIn + pos + length, brokerInLen - pos - length);
+        brokerInLen -= pos + length;
+    }
+    return size;
+}
+
+bool nativeBrokerPublish(const char* topic, const char* payload, uint8_t qos) {
+    if (!brokerSession || !nativeBrokerSubscribed(topic)) return false;
+    uint8_t head[BROKER_TOPIC_MAX + 4];
+    size_t topicLen = strlen(topic), n = 0;
+    if (topicLen >= BROKER_TOPIC_MAX) return false;
+    head[n++] = (uint8_t)(topicLen >> 8);
+    head[n++] = (uint8_t)topicLen;
+    memcpy(head + n, topic, topicLen);
+    n += topicLen;
+    if (qos) {
+        if (++brokerPacketId == 0) brokerPacketId = 1;
+        head[n++] = (uint8_t)(brokerPacketId >> 8);
+        head[n++] = (uint8_t)brokerPacketId;
+    }
+    return brokerSend(0x30 | (qos ? 0x02 : 0), head, n, (const uint8_t*)payload, strlen(payload));
+}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port) {
+    stop();
+    if (port == NATIVE_BROKER_PORT && brokerActive()) {
+        nativeBrokerDisconnect();
+        brokerSession = true;
+        loopback = true;
+        return 1;
+    }
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return 0;
+    fcntl(fd, F_SETFL, O_NONBLOCK);
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = (uint32_t)ip;
+    addr.sin_port = htons(port);
+    int error = 0;
+    socklen_t errorLen = sizeof(error);
+    if (::connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 &&
+        (errno != EINPROGRESS || !waitFd(fd, POLLOUT, timeoutMs) ||
+         getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &errorLen) < 0 || error != 0)) {
+        stop();
+        return 0;
+    }
+    return 1;
+}
+
+int WiFiClient::connect(const char* host, uint16_t port) {
+    IPAddress ip;
+    if (!WiFi.hostByName(host, ip)) return 0;
+    return connect(ip, port);
+}
+
+size_t WiFiClient::write(const uint8_t* buf, size_t size) {
+    if (loopback) return brokerReceive(buf, size);
+    size_t sent = 0;
+    while (fd >= 0 && sent < size) {
+        ssize_t n = send(fd, buf + sent, size - sent, MSG_NOSIGNAL);
+        if (n > 0) sent += n;
+        else if (n < 0 && errno == EAGAIN && waitFd(fd, POLLOUT, timeoutMs)) continue;
+        else break;
+    }
+    return sent;
+}
+
+int WiFiClient::available() {
+    if (loopback) return brokerSession ? (int)(brokerOutHead - brokerOutTail) : 0;
+    int n = 0;
+    if (fd < 0 || ioctl(fd, FIONREAD, &n) < 0) return 0;
+    return n;
+}
+
+int WiFiClient::read() {
+    if (loopback) return (brokerSession && brokerOutTail != brokerOutHead) ? brokerOut[brokerOutTail++ % BROKER_OUT_SIZE] : -1;
+    uint8_t c;
+    if (fd < 0 || recv(fd, &c, 1, 0) != 1) return -1;
+    return c;
+}
+
+void WiFiClient::stop() {
+    if (loopback) nativeBrokerDisconnect();
+    loopback = false;
+    if (fd >= 0) close(fd);
+    fd = -1;
+}
+
+uint8_t WiFiClient::connected() {
+    if (loopback) {
+        if (!brokerSession) stop();
+        return brokerSession ? 1 : 0;
+    }
+    if (fd < 0) return 0;
+    uint8_t c;
+    ssize_t n = recv(fd, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+    if (n == 0 || (n < 0 && errno != EAGAIN)) {
+        stop();
+        return 0;
+    }
+    return 1;
+}
+
+void WiFiClient::setNoDelay(bool noDelay) {
+    int one = noDelay ? 1 : 0;
+    if (fd >= 0) setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+}
+
+// WiFiUDP
+
+WiFiUDP::~WiFiUDP() {
+    if (fd >= 0) close(fd);
+}
+
+int WiFiUDP::beginPacket(const char* host, uint16_t port) {
+    IPAddress ip;
+    return WiFi.hostByName(host, ip) ? beginPacket(ip, port) : 0;
+}
+
+int WiFiUDP::beginPacket(IPAddress ip, uint16_t port) {
+    if (fd < 0) fd = socket(AF_INET, SOCK_DGRAM, 0);
+    remoteIp = ip;
+    remotePort = port;
+    packet.clear();
+    return fd >= 0 ? 1 : 0;
+}
+
+int WiFiUDP::endPacket() {
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = (uint32_t)remoteIp;
+    addr.sin_port = htons(remotePort);
+    return sendto(fd, packet.data(), packet.size(), 0, (struct sockaddr*)&addr, sizeof(addr)) >= 0 ? 1 : 0;
+}
@@ -0,0 +1,83 @@
+"""
+Minify and gzip the web pages into PROGMEM byte arrays (src/web_assets.h).
+
+Runs as a PlatformIO pre-build script (see extra_scripts in platformio.ini)
+and can also be run by hand: python scripts/build_web_assets.py
+"""
+
+import gzip
+import hashlib
+import os
+import re
+
+# (source file in src/, C identifier prefix)
+ASSETS = [
+    ("wifi-config.html", "WIFI_SETUP"),
+    ("wifi-home.html", "WIFI_HOME"),
+]
+OUTPUT = "web_assets.h"
+
+
+def minify_html(text):
+    # HTML comments and CSS block comments
+    text = re.sub(r"<!--.*?-->", "", text, flags=re.S)
+    text = re.sub(r"/\*.*?\*/", "", text, flags=re.S)
+    lines = []
+    for line in text.splitlines():
+        line = line.strip()
+        # Whole-line JS comments only; inline "//" may be part of a URL
+        if not line or line.startswith("//"):
+            continue
+        lines.append(line)
+    # Keep line breaks so JS without semicolons still parses
+    return "\n".join(lines)
+
+
+def c_array(name, data):
+    rows = []
+    for i in range(0, len(data), 16):
+        rows.append("    " + ", ".join("0x%02x" % b for b in data[i:i + 16]) + ",")
+    return "const uint8_t %s[] PROGMEM = {\n%s\n};\n" % (name, "\n".join(rows))
+
+
+def build(src_dir):
+    out_path = os.path.join(src_dir, OUTPUT)
+    sources = [os.path.join(src_dir, f) for f, _ in ASSETS]
+    if os.path.exists(out_path):
+        out_mtime = os.path.getmtime(out_path)
+        if all(os.path.getmtime(s) <= out_mtime for s in sources):
+            return
+
+    parts = [
+        "// Generated by scripts/build_web_assets.py from %s. Do not edit.\n"
+        % ", ".join(f for f, _ in ASSETS),
+        "#ifndef WEB_ASSETS_H\n#define WEB_ASSETS_H\n\n#include <Arduino.h>\n\n",
+    ]
+    for filename, name in ASSETS:
+        with open(os.path.join(src_dir, filename), encoding="utf-8") as f:
+            html = f.read()
+        minified = minify_html(html).encode("utf-8")
+        # mtime=0 keeps the output (and the ETag) stable across builds
+        data = gzip.compress(minified, compresslevel=9, mtime=0)
+        etag = hashlib.sha1(data).hexdigest()[:16]
+        parts.append("// %s: %d bytes, %d minified, %d gzipped\n"
+                     % (filename, len(html.encode("utf-8")), len(minified), len(data)))
+        parts.append(c_array(name + "_GZ", data))
+        parts.append("const size_t %s_GZ_LEN = %d;\n" % (name, len(data)))
+        parts.append("const char %s_ETAG[] = \"\\\"%s\\\"\";\n\n" % (name, etag))
+    parts.append("#endif // WEB_ASSETS_H\n")
+
+    with open(out_path, "w", encoding="utf-8") as f:
+        f.write("".join(parts))
+    print("Generated %s" % out_path)
+
+
+try:
+    Import("env")  # noqa: F821 (provided by PlatformIO/SCons)
+except NameError:
+    env = None
+
+if env is not None:
+    build(env.subst("$PROJECT_SRC_DIR"))
+else:
+    build(os.path.normpath(os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "src")))
@@ -0,0 +1,217 @@
+"""
+Power-restore fleet simulation for the startup jitter (STARTUP_JITTER_MAX_MS).
+
+Starts hundreds of env:native firmware instances at the same moment, as
+after a building-wide power cut, against a local MQTT broker, and reports
+how long it takes until every device has published its availability and
+the peak rate of broker connection attempts. Runs once with the jitter
+(power-on reset) and once without it (soft restart reason), unless --mode
+picks one.
+
+    pio run -e native
+    mosquitto -p 1883 &            # or --start-broker
+    python scripts/fleet_sim.py -n 300
+
+Every instance gets its own chip id (NATIVE_CHIP_ID, which also makes its
+MQTT client id unique), its own copy of a provisioned flash image
+(NATIVE_FLASH_FILE) and an ephemeral HTTP port. The broker port is the
+firmware's fixed 1883; "homeassistant.local" resolves to --broker.
+"""
+
+import argparse
+import os
+import selectors
+import shutil
+import signal
+import subprocess
+import sys
+import tempfile
+import time
+import urllib.request
+
+DEFAULT_PROGRAM = os.path.join(".pio", "build", "native", "program")
+REASON_POWER_ON = "0"
+REASON_SOFT_RESTART = "4"
+CHIP_ID_BASE = 0x00A00000
+
+# Log lines that mark each step (src/mqtt_utils.h, src/metrics_utils.h).
+# Every broker connection attempt ends in exactly one of the first two.
+LINE_CONNECTED = "Boot to MQTT connected"
+LINE_FAILED = "MQTT connect failed"
+LINE_AVAILABLE = "Availability message published successfully"
+
+
+def instance_env(flash_file, chip_id, reset_reason, broker, http_port="0"):
+    env = dict(os.environ)
+    env.update({
+        "NATIVE_FLASH_FILE": flash_file,
+        "NATIVE_CHIP_ID": "0x%08X" % chip_id,
+        "NATIVE_RESET_REASON": reset_reason,
+        "NATIVE_HTTP_PORT": http_port,
+        "NATIVE_MDNS_HOST": broker,
+    })
+    return env
+
+
+class LineReader:
+    """Splits a child's stdout into lines without blocking on partial ones."""
+
+    def __init__(self, proc, index=None):
+        self.fd = proc.stdout.fileno()
+        self.index = index
+        self.pending = b""
+
+    def read_lines(self):
+        """New complete lines, or None at end of file."""
+        data = os.read(self.fd, 65536)
+        if not data:
+            return None
+        lines = (self.pending + data).split(b"\n")
+        self.pending = lines.pop()
+        return [line.decode(errors="replace") for line in lines]
+
+
+def wait_for_line(proc, text, timeout):
+    deadline = time.monotonic() + timeout
+    reader = LineReader(proc)
+    sel = selectors.DefaultSelector()
+    sel.register(reader.fd, selectors.EVENT_READ)
+    try:
+        while time.monotonic() < deadline:
+            if not sel.select(timeout=0.2):
+                continue
+            lines = reader.read_lines()
+            if lines is None:
+                return False
+            if any(text in line for line in lines):
+                return True
+        return False
+    finally:
+        sel.close()
+
+
+def provision(program, flash_file, broker, timeout):
+    """Boot one instance into the setup portal and submit WiFi credentials."""
+    port = "18080"
+    proc = subprocess.Popen([program], stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                            env=instance_env(flash_file, CHIP_ID_BASE, REASON_SOFT_RESTART, broker, port))
+    try:
+        if not wait_for_line(proc, "HTTP server started", timeout):
+            sys.exit("provisioning: setup portal did not start")
+        request = urllib.request.Request("http://127.0.0.1:%s/wifi-config" % port,
+                                         data=b"ssid=native&password=native", method="POST")
+        urllib.request.urlopen(request, timeout=timeout).read()
+        if not wait_for_line(proc, "WiFi credentials saved", timeout):
+            sys.exit("provisioning: credentials were not saved")
+    finally:
+        proc.kill()
+        proc.wait()
+
+
+def run_fleet(program, image, workdir, count, jitter, broker, timeout):
+    reason = REASON_POWER_ON if jitter else REASON_SOFT_RESTART
+    procs = []
+    sel = selectors.DefaultSelector()
+    attempts, connects, available = [], [], {}
+    failed = 0
+
+    start = time.monotonic()
+    for i in range(count):
+        flash_file = os.path.join(workdir, "flash_%d.bin" % i)
+        shutil.copyfile(image, flash_file)
+        proc = subprocess.Popen([program], stdout=subprocess.PIPE, stderr=subprocess.DEVNULL,
+                                env=instance_env(flash_file, CHIP_ID_BASE + 1 + i, reason, broker))
+        procs.append(proc)
+        reader = LineReader(proc, i)
+        sel.register(reader.fd, selectors.EVENT_READ, reader)
+
+    try:
+        deadline = start + timeout
+        while len(available) < count and time.monotonic() < deadline:
+            for key, _ in sel.select(timeout=0.5):
+                reader = key.data
+                lines = reader.read_lines()
+                now = time.monotonic() - start
+                if lines is None:
+                    sel.unregister(reader.fd)
+                    continue
+                for line in lines:
+                    if LINE_CONNECTED in line:
+                        attempts.append(now)
+                        connects.append(now)
+                    elif LINE_FAILED in line:
+                        attempts.append(now)
+                        failed += 1
+                    elif LINE_AVAILABLE in line and reader.index not in available:
+                        available[reader.index] = now
+    finally:
+        sel.close()
+        for proc in procs:
+            proc.send_signal(signal.SIGKILL)
+        for proc in procs:
+            proc.wait()
+
+    return {
+        "available": len(available),
+        "all_available_s": max(available.values()) if len(available) == count else None,
+        "peak_attempts_per_s": peak_rate(attempts),
+        "peak_connects_per_s": peak_rate(connects),
+        "attempts": len(attempts),
+        "failed": failed,
+    }
+
+
+def peak_rate(times):
+    """Largest number of events in any one-second window."""
+    times = sorted(times)
+    peak, first = 0, 0
+    for last in range(len(times)):
+        while times[last] - times[first] >= 1.0:
+            first += 1
+        peak = max(peak, last - first + 1)
+    return peak
+
+
+def report(label, count, result):
+    all_s = result["all_available_s"]
+    print("%-10s %4d/%d available, all after %s, peak %d attempts/s, %d connects/s, %d attempts (%d failed)" % (
+        label, result["available"], count, "%.1f s" % all_s if all_s is not None else "timeout",
+        result["peak_attempts_per_s"], result["peak_connects_per_s"], result["attempts"], result["failed"]))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("-n", "--count", type=int, default=200, help="instances per run (default 200)")
+    parser.add_argument("--program", default=DEFAULT_PROGRAM, help="env:native binary")
+    parser.add_argument("--mode", choices=["both", "jitter", "no-jitter"], default="both")
+    parser.add_argument("--broker", default="127.0.0.1", help="broker address (port 1883)")
+    parser.add_argument("--start-broker", action="store_true", help="run mosquitto on 1883 for the duration")
+    parser.add_argument("--timeout", type=float, default=120.0, help="seconds to wait per run")
+    args = parser.parse_args()
+
+    if not os.access(args.program, os.X_OK):
+        sys.exit("%s not found; build it with: pio run -e native" % args.program)
+
+    broker = None
+    if args.start_broker:
+        broker = subprocess.Popen(["mosquitto", "-p", "1883"], stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+        time.sleep(0.5)
+
+    workdir = tempfile.mkdtemp(prefix="blinds_fleet_")
+    try:
+        image = os.path.join(workdir, "provisioned.bin")
+        provision(args.program, image, args.broker, 10)
+        modes = ["jitter", "no-jitter"] if args.mode == "both" else [args.mode]
+        for mode in modes:
+            result = run_fleet(args.program, image, workdir, args.count, mode == "jitter", args.broker, args.timeout)
+            report(mode, args.count, result)
+            time.sleep(2)  # let the broker drop the previous run's sessions
+    finally:
+        shutil.rmtree(workdir, ignore_errors=True)
+        if broker:
+            broker.terminate()
+            broker.wait()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,181 @@
+#ifndef BUTTON_UTILS_H
+#define BUTTON_UTILS_H
+
+#include <Arduino.h>
+
+#include "event_utils.h"
+#include "motor_utils.h"
+#include "wifi_utils.h"
+#include "log_utils.h"
+
+// Button Configuration (active low, internal pull-up)
+#define BUTTON_PIN 4
+#define BUTTON_DEBOUNCE_MS 30
+#define BUTTON_DOUBLE_GAP_MS 300  // max gap between the two presses of a double press
+#define BUTTON_LONG_MS 5000       // fires while still held: WiFi setup portal
+
+// Edges go from the ISR to the button task through one ring, the decoded
+// gestures through another. Edge values are millis() cut to the ring's 24
+// value bits, so timestamps are compared with buttonElapsed().
+enum ButtonEdge : uint8_t {
+    BUTTON_EDGE_DOWN = 1,
+    BUTTON_EDGE_UP
+};
+
+enum ButtonGesture : uint8_t {
+    BUTTON_SHORT = 1,  // open / stop / close / stop
+    BUTTON_DOUBLE,     // travel to the far end
+    BUTTON_LONG        // restart the WiFi setup portal
+};
+
+EventRing buttonEdges;     // producer: buttonISR()
+EventRing buttonGestures;  // producer: buttonDecode()
+
+inline uint32_t IRAM_ATTR buttonElapsed(uint32_t from, uint32_t to) {
+    return (to - from) & EVENT_VALUE_MASK;
+}
+
+// ISR state: last accepted level and when it changed
+volatile uint8_t buttonIsrLevel = HIGH;
+volatile uint32_t buttonIsrEdgeTime = 0;
+
+// Pin change: the first edge of a bounce burst is taken, with its time, and
+// the rest of the burst is dropped. A press is timed from the interrupt, so
+// a late button task does not change which gesture it was.
+void IRAM_ATTR buttonISR() {
+    uint8_t level = digitalRead(BUTTON_PIN);
+    uint32_t now = millis() & EVENT_VALUE_MASK;
+    if (level == buttonIsrLevel || buttonElapsed(buttonIsrEdgeTime, now) < BUTTON_DEBOUNCE_MS) return;
+    buttonIsrLevel = level;
+    buttonIsrEdgeTime = now;
+    eventPush(buttonEdges, level == LOW ? BUTTON_EDGE_DOWN : BUTTON_EDGE_UP, now);
+}
+
+// Gesture decoder state (button task only)
+bool buttonPressed = false;
+bool buttonLongSent = false;
+bool buttonClickPending = false;  // last press was short: a quick second one makes a double
+uint32_t buttonPressTime = 0;
+uint32_t buttonReleaseTime = 0;
+
+// A short press is reported on release, without waiting to see whether a
+// second one follows; that second press then comes as a double instead.
+void buttonDecode(uint8_t edge, uint32_t time) {
+    if (edge == BUTTON_EDGE_DOWN) {
+        if (buttonClickPending && buttonElapsed(buttonReleaseTime, time) > BUTTON_DOUBLE_GAP_MS)
+            buttonClickPending = false;
+        buttonPressed = true;
+        buttonLongSent = false;
+        buttonPressTime = time;
+        return;
+    }
+    if (!buttonPressed) return;
+    buttonPressed = false;
+    if (buttonLongSent) return;
+
+    if (buttonClickPending) {
+        eventPush(buttonGestures, BUTTON_DOUBLE, 0);
+        buttonClickPending = false;
+    }
+    else {
+        eventPush(buttonGestures, BUTTON_SHORT, 0);
+        buttonClickPending = true;
+        buttonReleaseTime = time;
+    }
+}
+
+// Long press: reported once the hold time is reached
+void buttonCheckHold(uint32_t now) {
+    if (!buttonPressed || buttonLongSent || buttonElapsed(buttonPressTime, now) < BUTTON_LONG_MS) return;
+    eventPush(buttonGestures, BUTTON_LONG, 0);
+    buttonLongSent = true;
+    buttonClickPending = false;
+}
+
+// An edge dropped as bounce (a tap shorter than the debounce time) can
+// leave the ISR on the wrong level. Once the pin has been quiet for the
+// debounce time, its level is taken as an edge.
+void buttonResync(uint32_t now) {
+    noInterrupts();
+    uint8_t level = digitalRead(BUTTON_PIN);
+    bool missed = level != buttonIsrLevel && buttonElapsed(buttonIsrEdgeTime, now) >= BUTTON_DEBOUNCE_MS;
+    if (missed) {
+        buttonIsrLevel = level;
+        buttonIsrEdgeTime = now;
+    }
+    interrupts();
+    if (missed) buttonDecode(level == LOW ? BUTTON_EDGE_DOWN : BUTTON_EDGE_UP, now);
+}
+
+// ---------------------------------------------------------------------------
+// Local control: the button drives all blinds together
+// ---------------------------------------------------------------------------
+
+bool buttonLastOpen = false;  // direction of the last move the button started
+uint8_t buttonPressPosition = 0;  // blind position (0-100) when the last short press was handled
+
+void buttonMoveAll(bool open) {
+    for (uint8_t axis = 0; axis < MOTOR_AXES; axis++) blindMoveToPercent(axis, open ? 100 : 0);
+    buttonLastOpen = open;
+    LOG_I(LOG_BUTTON, "%s", open ? "open" : "close");
+}
+
+void buttonStopAll() {
+    buttonLastOpen = planners[0].direction > 0;
+    for (uint8_t axis = 0; axis < MOTOR_AXES; axis++) motorStop(axis);
+    LOG_I(LOG_BUTTON, "stop");
+}
+
+// The open -> stop -> close -> stop cycle of the original button prototype,
+// but taken from the blind's actual state, so it stays right when Home
+// Assistant moved the blind in between
+void buttonCycle() {
+    if (motorIsMoving()) {
+        buttonStopAll();
+        return;
+    }
+    uint8_t position = blindPositionPercent(0);
+    if (position == 0) buttonMoveAll(true);
+    else if (position == 100) buttonMoveAll(false);
+    else buttonMoveAll(!buttonLastOpen);
+}
+
+void handleButtonGesture(uint8_t gesture) {
+    switch (gesture) {
+        case BUTTON_SHORT:
+            buttonPressPosition = blindPositionPercent(0);
+            buttonCycle();
+            break;
+        case BUTTON_DOUBLE:
+            // Whatever the first press started or stopped, travel to the
+            // endpoint farther from where the blind was at that press
+            buttonMoveAll(buttonPressPosition < 50);
+            break;
+        case BUTTON_LONG:
+            LOG_I(LOG_BUTTON, "long press, starting WiFi setup");
+            resetWifiSetup();
+            setupWifi();
+            break;
+    }
+}
+
+void initButton() {
+    pinMode(BUTTON_PIN, INPUT_PULLUP);
+    buttonIsrLevel = digitalRead(BUTTON_PIN);
+    attachInterrupt(digitalPinToInterrupt(BUTTON_PIN), buttonISR, CHANGE);
+}
+
+// Button task: decode queued edges, then act on the gestures
+void handleButton() {
+    uint8_t type;
+    uint32_t value;
+    while (eventPop(buttonEdges, &type, &value)) buttonDecode(type, value);
+
+    uint32_t now = millis() & EVENT_VALUE_MASK;
+    buttonResync(now);
+    buttonCheckHold(now);
+
+    while (eventPop(buttonGestures, &type, &value)) handleButtonGesture(type);
+}
+
+#endif // BUTTON_UTILS_H
@@ -0,0 +1,334 @@
+#ifndef CONFIG_UTILS_H
+#define CONFIG_UTILS_H
+
+#include <EEPROM.h>
+#include <Arduino.h>
+
+#include "flash_utils.h"
+#include "led_utils.h"
+#include "metrics_utils.h"
+#include "string_utils.h"
+#include "log_utils.h"
+
+// Config Store Configuration
+#define CONFIG_MAX_KEYS 8
+#define CONFIG_MAX_VALUE_LEN 64
+#define CONFIG_COMMIT_DELAY_MS 2000  // batch changes made within this window
+#define CONFIG_RETRY_MIN_MS 10000UL    // first retry after a failed commit, doubled each time
+#define CONFIG_RETRY_MAX_MS 3600000UL
+#define CONFIG_MAX_FAILURES 8          // then stop retrying until restart
+
+// Config Keys (1..254; never reuse a retired number)
+#define CONFIG_KEY_WIFI_SSID 1
+#define CONFIG_KEY_WIFI_PASSWORD 2
+#define CONFIG_KEY_WIFI_FAST_CONNECT 3
+#define CONFIG_KEY_DISCOVERY_HASH 4
+#define CONFIG_KEY_BROKER_ADDRESS 5
+
+#define MAX_SSID_LEN 32
+#define MAX_PASSWORD_LEN 64
+
+typedef FixedString<MAX_SSID_LEN> WifiSsid;
+typedef FixedString<MAX_PASSWORD_LEN> WifiPassword;
+
+// Legacy EEPROM layout, read once to migrate existing devices
+#define EEPROM_SIZE 512
+#define SSID_ADDR 0
+#define PASSWORD_ADDR 64
+
+// Log-structured key/value store. Each sector starts with an 8-byte header
+// (sequence, magic) followed by an append-only log of records:
+//   [key:8 | len:8 | crc16:16] [data, padded to 4 bytes]
+// The sector with the highest sequence is active, and the last record for a
+// key wins (len 0 deletes it). When the active sector fills up, the live
+// values are compacted into the next sector in rotation, which spreads the
+// erase cycles over all FLASH_SECTOR_COUNT sectors.
+//
+// Power-cut safety: a compacted sector only becomes valid once its header is
+// written, and the magic is the last word written. A torn record fails its
+// CRC, so scanning stops there and the next commit compacts.
+#define CONFIG_SECTOR_MAGIC 0x31474643UL  // "CFG1"
+#define CONFIG_HEADER_SIZE 8
+#define CONFIG_RECORD_HEADER_SIZE 4
+#define CONFIG_NO_SECTOR 0xFF
+
+struct ConfigEntry {
+    uint8_t key;   // 0 = unused slot
+    uint8_t len;   // 0 = not set
+    bool dirty;    // changed since the last commit
+    uint8_t data[CONFIG_MAX_VALUE_LEN];
+};
+
+// RAM copy of every value; flash is only read at boot
+ConfigEntry configEntries[CONFIG_MAX_KEYS];
+
+uint8_t configActiveSector = CONFIG_NO_SECTOR;
+uint32_t configSequence = 0;
+uint32_t configWriteOffset = CONFIG_HEADER_SIZE;
+bool configLogDamaged = false;          // unreadable record found, compact on next commit
+unsigned long configDirtySince = 0;
+bool configDirty = false;
+uint8_t configFailures = 0;             // consecutive failed commits
+unsigned long configFailedAt = 0;
+
+uint16_t configCrc16(uint16_t crc, const uint8_t* data, size_t len) {
+    // CRC-16/CCITT-FALSE
+    while (len--) {
+        crc ^= (uint16_t)(*data++) << 8;
+        for (uint8_t bit = 0; bit < 8; bit++)
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+    return crc;
+}
+
+inline uint32_t configRecordSize(uint8_t len) {
+    return CONFIG_RECORD_HEADER_SIZE + ((len + 3) & ~3UL);
+}
+
+ConfigEntry* configFind(uint8_t key, bool create) {
+    ConfigEntry* freeSlot = NULL;
+    for (uint8_t i = 0; i < CONFIG_MAX_KEYS; i++) {
+        if (configEntries[i].key == key) return &configEntries[i];
+        if (!freeSlot && configEntries[i].key == 0) freeSlot = &configEntries[i];
+    }
+    if (!create || !freeSlot) return NULL;
+    freeSlot->key = key;
+    freeSlot->len = 0;
+    freeSlot->dirty = false;
+    return freeSlot;
+}
+
+// Write one record at the end of the log. Refuses to program over anything
+// that is not blank, since that would corrupt both records.
+bool configAppendRecord(uint8_t sector, uint32_t offset, const ConfigEntry& entry) {
+    uint32_t size = configRecordSize(entry.len);
+    if (offset + size > FLASH_SECTOR_SIZE) return false;
+
+    uint32_t buffer[(CONFIG_RECORD_HEADER_SIZE + CONFIG_MAX_VALUE_LEN + 3) / 4];
+    if (!flashRead(sector, offset, buffer, size)) return false;
+    for (uint32_t i = 0; i < size / 4; i++) {
+        if (buffer[i] != 0xFFFFFFFFUL) return false;
+    }
+
+    uint8_t* bytes = (uint8_t*)buffer;
+    memset(bytes, 0xFF, size);
+    bytes[0] = entry.key;
+    bytes[1] = entry.len;
+    memcpy(bytes + CONFIG_RECORD_HEADER_SIZE, entry.data, entry.len);
+    uint16_t crc = configCrc16(0xFFFF, bytes, 2);
+    crc = configCrc16(crc, entry.data, entry.len);
+    bytes[2] = crc & 0xFF;
+    bytes[3] = crc >> 8;
+    return flashWrite(sector, offset, buffer, size);
+}
+
+// Replay the active sector's log into RAM
+void configReplay(uint8_t sector) {
+    uint32_t offset = CONFIG_HEADER_SIZE;
+    uint32_t buffer[(CONFIG_MAX_VALUE_LEN + 3) / 4];
+
+    while (offset + CONFIG_RECORD_HEADER_SIZE <= FLASH_SECTOR_SIZE) {
+        uint32_t header;
+        if (!flashRead(sector, offset, &header, 4)) break;
+        if (header == 0xFFFFFFFFUL) break;  // end of log
+
+        uint8_t key = header & 0xFF;
+        uint8_t len = (header >> 8) & 0xFF;
+        uint16_t crc = header >> 16;
+        uint32_t size = configRecordSize(len);
+        if (key == 0 || key == 0xFF || len > CONFIG_MAX_VALUE_LEN || offset + size > FLASH_SECTOR_SIZE ||
+            !flashRead(sector, offset + CONFIG_RECORD_HEADER_SIZE, buffer, size - CONFIG_RECORD_HEADER_SIZE)) {
+            configLogDamaged = true;
+            break;
+        }
+        uint8_t keyLen[2] = {key, len};
+        if (configCrc16(configCrc16(0xFFFF, keyLen, 2), (uint8_t*)buffer, len) != crc) {
+            configLogDamaged = true;
+            break;
+        }
+
+        ConfigEntry* entry = configFind(key, true);
+        if (entry) {
+            entry->len = len;
+            memcpy(entry->data, buffer, len);
+        }
+        offset += size;
+    }
+    configWriteOffset = offset;
+}
+
+// Copy every live value into the next sector and make it the active one
+bool configCompact() {
+    uint8_t next = (configActiveSector == CONFIG_NO_SECTOR) ? 0 : (configActiveSector + 1) % FLASH_SECTOR_COUNT;
+    if (!flashErase(next)) return false;
+
+    uint32_t offset = CONFIG_HEADER_SIZE;
+    for (uint8_t i = 0; i < CONFIG_MAX_KEYS; i++) {
+        const ConfigEntry& entry = configEntries[i];
+        if (entry.key == 0 || entry.len == 0) continue;
+        if (!configAppendRecord(next, offset, entry)) return false;
+        offset += configRecordSize(entry.len);
+    }
+
+    // Sequence first, magic last: the sector is only valid once both are in
+    uint32_t header[2] = {configSequence + 1, CONFIG_SECTOR_MAGIC};
+    if (!flashWrite(next, 0, header, sizeof(header))) return false;
+
+    configActiveSector = next;
+    configSequence++;
+    configWriteOffset = offset;
+    configLogDamaged = false;
+    return true;
+}
+
+// Write all pending changes. Returns false if flash could not be written;
+// the changes stay pending and are retried on the next commit.
+// An explicit call always tries; the config task backs off after failures.
+bool configCommit() {
+    if (!configDirty) return true;
+    unsigned long start = micros();
+
+    bool ok = !configLogDamaged && configActiveSector != CONFIG_NO_SECTOR;
+    uint32_t offset = configWriteOffset;
+    for (uint8_t i = 0; ok && i < CONFIG_MAX_KEYS; i++) {
+        ConfigEntry& entry = configEntries[i];
+        if (entry.key == 0 || !entry.dirty) continue;
+        if (!configAppendRecord(configActiveSector, offset, entry)) {
+            // Full, or a torn write left garbage: rewrite everything elsewhere
+            ok = false;
+            break;
+        }
+        offset += configRecordSize(entry.len);
+        entry.dirty = false;
+        configWriteOffset = offset;
+    }
+
+    if (!ok) {
+        configLogDamaged = true;
+        if (!configCompact()) {
+            // Every attempt erases a sector: handleConfig() backs off
+            if (configFailures < CONFIG_MAX_FAILURES) configFailures++;
+            configFailedAt = millis();
+            LOG_E(LOG_CONFIG, "store write failed (%u)", configFailures);
+            if (configFailures == CONFIG_MAX_FAILURES) LOG_E(LOG_CONFIG, "not retrying until restart");
+            return false;
+        }
+    }
+
+    for (uint8_t i = 0; i < CONFIG_MAX_KEYS; i++) configEntries[i].dirty = false;
+    configDirty = false;
+    configFailures = 0;
+    metricsRecord(metricConfigCommitHist, micros() - start);
+    return true;
+}
+
+// Stage a value; unchanged values are not written again
+bool configSet(uint8_t key, const void* data, uint8_t len) {
+    if (len > CONFIG_MAX_VALUE_LEN) return false;
+    ConfigEntry* entry = configFind(key, len > 0);
+    if (!entry) return len == 0;
+    if (entry->len == len && (len == 0 || memcmp(entry->data, data, len) == 0)) return true;
+
+    if (len > 0) memcpy(entry->data, data, len);
+    entry->len = len;
+    entry->dirty = true;
+    if (!configDirty) configDirtySince = millis();
+    configDirty = true;
+    return true;
+}
+
+bool configSetString(uint8_t key, StringView value) {
+    return configSet(key, value.data, value.len > CONFIG_MAX_VALUE_LEN ? CONFIG_MAX_VALUE_LEN : value.len);
+}
+
+void configRemove(uint8_t key) {
+    configSet(key, NULL, 0);
+}
+
+// Returns the value length, 0 if the key is not set
+uint8_t configGet(uint8_t key, void* data, uint8_t size) {
+    ConfigEntry* entry = configFind(key, false);
+    if (!entry || entry->len == 0 || entry->len > size) return 0;
+    memcpy(data, entry->data, entry->len);
+    return entry->len;
+}
+
+// Copies a value into out (truncated to its capacity); false if unset
+template <size_t N>
+bool configGetString(uint8_t key, FixedString<N>& out) {
+    out.clear();
+    ConfigEntry* entry = configFind(key, false);
+    if (!entry || entry->len == 0) return false;
+    out = StringView((const char*)entry->data, entry->len);
+    return true;
+}
+
+// Read a length-prefixed string from the old fixed EEPROM layout
+template <size_t N>
+bool readLegacyEEPROMString(int address, FixedString<N>& out) {
+    out.clear();
+    uint8_t len = EEPROM.read(address);
+    if (len == 0 || len > N) return false;
+    for (uint8_t i = 0; i < len; i++) out += (char)EEPROM.read(address + 1 + i);
+    return true;
+}
+
+void migrateLegacyEEPROM() {
+    WifiSsid ssid;
+    WifiPassword password;
+
+    EEPROM.begin(EEPROM_SIZE);
+    if (readLegacyEEPROMString(SSID_ADDR, ssid)) {
+        readLegacyEEPROMString(PASSWORD_ADDR, password);
+        configSetString(CONFIG_KEY_WIFI_SSID, ssid);
+        configSetString(CONFIG_KEY_WIFI_PASSWORD, password);
+        LOG_I(LOG_CONFIG, "Migrated WiFi credentials from EEPROM");
+    }
+    EEPROM.end();
+}
+
+// Find the newest valid sector and load it. Call once from setup().
+void configBegin() {
+    for (uint8_t s = 0; s < FLASH_SECTOR_COUNT; s++) {
+        uint32_t header[2];
+        if (!flashRead(s, 0, header, sizeof(header)) || header[1] != CONFIG_SECTOR_MAGIC) continue;
+        if (configActiveSector == CONFIG_NO_SECTOR || (int32_t)(header[0] - configSequence) > 0) {
+            configActiveSector = s;
+            configSequence = header[0];
+        }
+    }
+
+    if (configActiveSector == CONFIG_NO_SECTOR) {
+        LOG_I(LOG_CONFIG, "store empty, formatting");
+        migrateLegacyEEPROM();
+        configDirty = true;  // always write the first sector header
+        configCommit();
+    }
+    else {
+        configReplay(configActiveSector);
+    }
+
+    LOG_I(LOG_CONFIG, "sector %u, sequence %u, %u/%u bytes used%s",
+          configActiveSector, (unsigned)configSequence, (unsigned)configWriteOffset, FLASH_SECTOR_SIZE,
+          configLogDamaged ? ", damaged tail" : "");
+}
+
+// Wait before the next automatic retry: CONFIG_RETRY_MIN_MS, doubling
+// with each consecutive failure up to CONFIG_RETRY_MAX_MS
+unsigned long configRetryDelay() {
+    unsigned long delayMs = CONFIG_RETRY_MIN_MS;
+    for (uint8_t i = 1; i < configFailures && delayMs < CONFIG_RETRY_MAX_MS; i++) delayMs *= 2;
+    return delayMs < CONFIG_RETRY_MAX_MS ? delayMs : CONFIG_RETRY_MAX_MS;
+}
+
+// Config task: commit batched changes once they have settled. After
+// CONFIG_MAX_FAILURES failed commits in a row the error is latched and only
+// an explicit configCommit() (e.g. saving WiFi settings) tries again.
+void handleConfig() {
+    if (!configDirty || millis() - configDirtySince < CONFIG_COMMIT_DELAY_MS) return;
+    if (configFailures >= CONFIG_MAX_FAILURES) return;
+    if (configFailures && millis() - configFailedAt < configRetryDelay()) return;
+    configCommit();
+}
+
+#endif // CONFIG_UTILS_H
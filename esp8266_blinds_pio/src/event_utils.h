@@ -0,0 +1,78 @@
+#ifndef EVENT_UTILS_H
+#define EVENT_UTILS_H
+
+#include <Arduino.h>
+
+// Event Ring Configuration
+#define EVENT_RING_SIZE 16  // power of two, at most 128 (indices wrap as uint8_t)
+#define EVENT_VALUE_MASK 0x00FFFFFFUL
+#define EVENT_AXIS_SHIFT 16  // value bits 16-23: blind axis, bits 0-15: payload
+
+static_assert((EVENT_RING_SIZE & (EVENT_RING_SIZE - 1)) == 0 && EVENT_RING_SIZE <= 128,
+              "EVENT_RING_SIZE must be a power of two <= 128");
+
+// State event types; each one maps to one MQTT topic
+enum StateEventType : uint8_t {
+    EVENT_POSITION = 1,  // value: 0-100
+    EVENT_MOTION,        // value: MotionState
+    EVENT_ERROR          // value: MotorError
+};
+
+enum MotionState : uint8_t {
+    MOTION_STOPPED = 0,
+    MOTION_OPENING,
+    MOTION_CLOSING
+};
+
+enum MotorError : uint8_t {
+    MOTOR_ERROR_NONE = 0,
+    MOTOR_ERROR_STEP_UNDERRUN  // step queue ran dry mid-move
+};
+
+inline uint32_t IRAM_ATTR eventAxisValue(uint8_t axis, uint16_t value) {
+    return ((uint32_t)axis << EVENT_AXIS_SHIFT) | value;
+}
+
+inline uint8_t eventAxis(uint32_t value) {
+    return (uint8_t)(value >> EVENT_AXIS_SHIFT);
+}
+
+// Lock-free single-producer/single-consumer ring of state events. Each
+// entry is one word (type << 24 | value) so a slot is written in one store.
+// The head is only written by the producer and the tail only by the
+// consumer; release/acquire ordering publishes the slot before the index.
+// Every producer context (task, ISR) needs its own ring.
+struct EventRing {
+    uint32_t entries[EVENT_RING_SIZE];
+    uint8_t head;      // producer only
+    uint8_t tail;      // consumer only
+    uint16_t dropped;  // producer only: pushes rejected because the ring was full
+};
+
+inline bool IRAM_ATTR eventPush(EventRing& ring, uint8_t type, uint32_t value) {
+    uint8_t head = ring.head;
+    uint8_t tail = __atomic_load_n(&ring.tail, __ATOMIC_ACQUIRE);
+    if ((uint8_t)(head - tail) >= EVENT_RING_SIZE) {
+        ring.dropped++;
+        return false;
+    }
+    ring.entries[head & (EVENT_RING_SIZE - 1)] = ((uint32_t)type << 24) | (value & EVENT_VALUE_MASK);
+    __atomic_store_n(&ring.head, (uint8_t)(head + 1), __ATOMIC_RELEASE);
+    return true;
+}
+
+inline bool eventPop(EventRing& ring, uint8_t* type, uint32_t* value) {
+    uint8_t tail = ring.tail;
+    if (tail == __atomic_load_n(&ring.head, __ATOMIC_ACQUIRE)) return false;
+    uint32_t entry = ring.entries[tail & (EVENT_RING_SIZE - 1)];
+    __atomic_store_n(&ring.tail, (uint8_t)(tail + 1), __ATOMIC_RELEASE);
+    *type = entry >> 24;
+    *value = entry & EVENT_VALUE_MASK;
+    return true;
+}
+
+// Motion events: produced by the motor task, stepper ISR events by the ISR
+EventRing motionEvents;
+EventRing stepperIsrEvents;
+
+#endif // EVENT_UTILS_H
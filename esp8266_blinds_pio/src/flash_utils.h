@@ -0,0 +1,105 @@
+#ifndef FLASH_UTILS_H
+#define FLASH_UTILS_H
+
+#include <Arduino.h>
+
+// Flash Configuration
+// The config store owns FLASH_SECTOR_COUNT sectors directly below the
+// emulated-EEPROM sector, i.e. the tail of the filesystem area. This project
+// does not mount a filesystem; if one is ever added it must leave these free.
+#define FLASH_SECTOR_SIZE 4096
+#define FLASH_SECTOR_COUNT 4
+
+// Minimal flash HAL used by config_utils.h. Sectors are addressed by index
+// 0..FLASH_SECTOR_COUNT-1; offsets and lengths must be multiples of 4.
+// Like NOR flash, a write can only clear bits; erase sets a sector to 0xFF.
+
+#ifdef ESP8266
+
+#include <spi_flash.h>
+
+extern "C" uint32_t _EEPROM_start;  // from the linker script
+
+#define FLASH_EEPROM_SECTOR (((uint32_t)&_EEPROM_start - 0x40200000) / SPI_FLASH_SEC_SIZE)
+#define FLASH_FIRST_SECTOR (FLASH_EEPROM_SECTOR - FLASH_SECTOR_COUNT)
+
+bool flashErase(uint8_t sector) {
+    return ESP.flashEraseSector(FLASH_FIRST_SECTOR + sector);
+}
+
+bool flashWrite(uint8_t sector, uint32_t offset, const uint32_t* data, size_t len) {
+    return ESP.flashWrite((FLASH_FIRST_SECTOR + sector) * FLASH_SECTOR_SIZE + offset, data, len);
+}
+
+bool flashRead(uint8_t sector, uint32_t offset, uint32_t* data, size_t len) {
+    return ESP.flashRead((FLASH_FIRST_SECTOR + sector) * FLASH_SECTOR_SIZE + offset, data, len);
+}
+
+#else // Host flash emulator
+
+// RAM-backed flash that counts erase cycles and can simulate a power cut:
+// with flashEmuWriteBudget >= 0, only that many more words get programmed,
+// after which every write and erase fails until the budget is reset to -1.
+// If NATIVE_FLASH_FILE names a file, the image is loaded from it on first
+// use and written back after every erase and write.
+uint32_t flashEmuData[FLASH_SECTOR_COUNT][FLASH_SECTOR_SIZE / 4];
+uint32_t flashEmuEraseCount[FLASH_SECTOR_COUNT];
+long flashEmuWriteBudget = -1;
+bool flashEmuInitialized = false;
+
+void flashEmuReset() {
+    memset(flashEmuData, 0xFF, sizeof(flashEmuData));
+    memset(flashEmuEraseCount, 0, sizeof(flashEmuEraseCount));
+    flashEmuWriteBudget = -1;
+    flashEmuInitialized = true;
+}
+
+void flashEmuLoad() {
+    flashEmuReset();
+    const char* path = getenv("NATIVE_FLASH_FILE");
+    FILE* file = path ? fopen(path, "rb") : NULL;
+    if (!file) return;
+    if (fread(flashEmuData, 1, sizeof(flashEmuData), file) != sizeof(flashEmuData))
+        memset(flashEmuData, 0xFF, sizeof(flashEmuData));
+    fclose(file);
+}
+
+void flashEmuSave() {
+    const char* path = getenv("NATIVE_FLASH_FILE");
+    FILE* file = path ? fopen(path, "wb") : NULL;
+    if (!file) return;
+    fwrite(flashEmuData, 1, sizeof(flashEmuData), file);
+    fclose(file);
+}
+
+bool flashErase(uint8_t sector) {
+    if (!flashEmuInitialized) flashEmuLoad();
+    if (sector >= FLASH_SECTOR_COUNT || flashEmuWriteBudget == 0) return false;
+    memset(flashEmuData[sector], 0xFF, FLASH_SECTOR_SIZE);
+    flashEmuEraseCount[sector]++;
+    flashEmuSave();
+    return true;
+}
+
+bool flashWrite(uint8_t sector, uint32_t offset, const uint32_t* data, size_t len) {
+    if (!flashEmuInitialized) flashEmuLoad();
+    if (sector >= FLASH_SECTOR_COUNT || offset + len > FLASH_SECTOR_SIZE || (offset | len) & 3) return false;
+    for (size_t i = 0; i < len / 4; i++) {
+        if (flashEmuWriteBudget == 0) return false;  // power lost mid-write
+        if (flashEmuWriteBudget > 0) flashEmuWriteBudget--;
+        flashEmuData[sector][offset / 4 + i] &= data[i];
+    }
+    flashEmuSave();
+    return true;
+}
+
+bool flashRead(uint8_t sector, uint32_t offset, uint32_t* data, size_t len) {
+    if (!flashEmuInitialized) flashEmuLoad();
+    if (sector >= FLASH_SECTOR_COUNT || offset + len > FLASH_SECTOR_SIZE || (offset | len) & 3) return false;
+    memcpy(data, &flashEmuData[sector][offset / 4], len);
+    return true;
+}
+
+#endif
+
+#endif // FLASH_UTILS_H
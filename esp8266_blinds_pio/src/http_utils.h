@@ -0,0 +1,901 @@
+#ifndef HTTP_UTILS_H
+#define HTTP_UTILS_H
+
+#include <Arduino.h>
+
+#include "string_utils.h"
+#include "log_utils.h"
+
+// Transport: lwIP raw TCP API on the ESP8266, non-blocking POSIX sockets on
+// the host so the same server can be load-tested on Linux.
+#ifdef ESP8266
+#include <lwip/tcp.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+// HTTP Server Configuration
+#define HTTP_MAX_CONNECTIONS 4
+#define HTTP_MAX_ROUTES 8
+#define HTTP_TARGET_MAX_LEN 64        // path + query string
+#define HTTP_TOKEN_MAX_LEN 24         // method, version, header name
+#define HTTP_HEADER_VALUE_MAX_LEN 40
+#define HTTP_BODY_MAX_LEN 320        // worst-case /wifi-config form, see wifi_utils.h
+#define HTTP_TX_BUFFER_LEN 512        // status line + headers + small bodies
+#define HTTP_EXTRA_HEADERS_LEN 160
+#define HTTP_IO_CHUNK 256
+#define HTTP_IDLE_TIMEOUT_MS 5000     // keep-alive connections idle longer are closed
+#define HTTP_MAX_EVENT_STREAMS 2      // leave slots free for ordinary requests
+#define HTTP_EVENT_KEEPALIVE_MS 15000 // comment line on a quiet event stream
+#define HTTP_EVENT_IDLE_TIMEOUT_MS 30000  // event stream that took no data this long is closed
+
+enum HttpMethod {
+    HTTP_METHOD_ANY,
+    HTTP_METHOD_GET,
+    HTTP_METHOD_HEAD,
+    HTTP_METHOD_POST,
+    HTTP_METHOD_OTHER
+};
+
+// Incremental request parser: fed one byte at a time, never waits for more
+enum HttpParseState {
+    HTTP_PARSE_METHOD,
+    HTTP_PARSE_TARGET,
+    HTTP_PARSE_VERSION,
+    HTTP_PARSE_HEADER_NAME,
+    HTTP_PARSE_HEADER_VALUE,
+    HTTP_PARSE_BODY,
+    HTTP_PARSE_DONE,
+    HTTP_PARSE_ERROR
+};
+
+struct HttpRequest {
+    HttpParseState state;
+    HttpMethod method;
+    char target[HTTP_TARGET_MAX_LEN + 1];
+    uint8_t targetLen;
+    const char* query;            // points into target after '?', or ""
+    char token[HTTP_TOKEN_MAX_LEN + 1];
+    uint8_t tokenLen;
+    char value[HTTP_HEADER_VALUE_MAX_LEN + 1];
+    uint8_t valueLen;
+    char ifNoneMatch[HTTP_HEADER_VALUE_MAX_LEN + 1];
+    bool keepAlive;
+    uint16_t contentLength;
+    char body[HTTP_BODY_MAX_LEN + 1];
+    uint16_t bodyLen;
+    uint16_t errorCode;           // set with HTTP_PARSE_ERROR
+};
+
+// Fills buf with part `index` of a streamed response; returns 0 when done
+typedef size_t (*HttpStreamWriter)(char* buf, size_t size, uint16_t index);
+
+struct HttpConnection {
+    bool inUse;
+#ifdef ESP8266
+    struct tcp_pcb* pcb;
+    struct pbuf* rx;              // received data not yet parsed
+    uint16_t rxOffset;            // read position in the first segment
+#else
+    int fd;
+    uint8_t rx[HTTP_IO_CHUNK];
+    uint16_t rxLen;
+    uint16_t rxPos;
+#endif
+    bool remoteClosed;
+    bool eventStream;             // long-lived text/event-stream response
+    unsigned long lastActivity;
+    HttpRequest request;
+
+    // Response in progress: tx buffer first, then the optional body pointer
+    bool responding;
+    bool closeAfterResponse;
+    char tx[HTTP_TX_BUFFER_LEN];
+    uint16_t txLen;
+    uint16_t txSent;
+    const uint8_t* body;
+    size_t bodyLen;
+    size_t bodySent;
+    bool bodyProgmem;
+    HttpStreamWriter streamWriter; // refills tx once it has been sent
+    uint16_t streamIndex;
+    char extraHeaders[HTTP_EXTRA_HEADERS_LEN];
+    uint8_t extraHeadersLen;
+};
+
+typedef void (*HttpHandler)();
+
+struct HttpRoute {
+    const char* path;
+    HttpMethod method;
+    HttpHandler handler;
+};
+
+HttpConnection httpConnections[HTTP_MAX_CONNECTIONS];
+HttpRoute httpRoutes[HTTP_MAX_ROUTES];
+uint8_t httpRouteCount = 0;
+HttpHandler httpNotFoundHandler = NULL;
+bool httpServerStarted = false;
+
+// Connection whose request is being handled; handlers respond through it
+HttpConnection* httpCurrent = NULL;
+
+// ---------------------------------------------------------------------------
+// Parser
+// ---------------------------------------------------------------------------
+
+void httpResetRequest(HttpRequest& r) {
+    r.state = HTTP_PARSE_METHOD;
+    r.method = HTTP_METHOD_OTHER;
+    r.target[0] = '\0';
+    r.targetLen = 0;
+    r.query = "";
+    r.tokenLen = 0;
+    r.valueLen = 0;
+    r.ifNoneMatch[0] = '\0';
+    r.keepAlive = true;
+    r.contentLength = 0;
+    r.body[0] = '\0';
+    r.bodyLen = 0;
+    r.errorCode = 0;
+}
+
+void httpParseError(HttpRequest& r, uint16_t code) {
+    r.state = HTTP_PARSE_ERROR;
+    r.errorCode = code;
+}
+
+void httpApplyHeader(HttpRequest& r) {
+    if (strcmp(r.token, "content-length") == 0) {
+        long length = atol(r.value);
+        if (length < 0 || length > HTTP_BODY_MAX_LEN) httpParseError(r, 413);
+        else r.contentLength = (uint16_t)length;
+    }
+    else if (strcmp(r.token, "connection") == 0) {
+        if (strcasecmp(r.value, "close") == 0) r.keepAlive = false;
+        else if (strcasecmp(r.value, "keep-alive") == 0) r.keepAlive = true;
+    }
+    else if (strcmp(r.token, "if-none-match") == 0) {
+        strcpy(r.ifNoneMatch, r.value);
+    }
+}
+
+void httpParseByte(HttpRequest& r, char c) {
+    switch (r.state) {
+        case HTTP_PARSE_METHOD:
+            if (c == '\r' || c == '\n') {
+                if (r.tokenLen > 0) httpParseError(r, 400);
+            }
+            else if (c == ' ') {
+                r.token[r.tokenLen] = '\0';
+                if (strcmp(r.token, "GET") == 0) r.method = HTTP_METHOD_GET;
+                else if (strcmp(r.token, "HEAD") == 0) r.method = HTTP_METHOD_HEAD;
+                else if (strcmp(r.token, "POST") == 0) r.method = HTTP_METHOD_POST;
+                r.tokenLen = 0;
+                r.state = HTTP_PARSE_TARGET;
+            }
+            else if (r.tokenLen < HTTP_TOKEN_MAX_LEN) r.token[r.tokenLen++] = c;
+            else httpParseError(r, 400);
+            break;
+
+        case HTTP_PARSE_TARGET:
+            if (c == ' ') {
+                r.target[r.targetLen] = '\0';
+                char* q = strchr(r.target, '?');
+                if (q) {
+                    *q = '\0';
+                    r.query = q + 1;
+                }
+                r.state = HTTP_PARSE_VERSION;
+            }
+            else if (c == '\r' || c == '\n') httpParseError(r, 400);
+            else if (r.targetLen < HTTP_TARGET_MAX_LEN) r.target[r.targetLen++] = c;
+            else httpParseError(r, 414);
+            break;
+
+        case HTTP_PARSE_VERSION:
+            if (c == '\n') {
+                r.token[r.tokenLen] = '\0';
+                // HTTP/1.0 closes by default, HTTP/1.1 keeps the connection
+                r.keepAlive = (strcmp(r.token, "HTTP/1.1") == 0);
+                r.tokenLen = 0;
+                r.state = HTTP_PARSE_HEADER_NAME;
+            }
+            else if (c != '\r') {
+                if (r.tokenLen < HTTP_TOKEN_MAX_LEN) r.token[r.tokenLen++] = c;
+                else httpParseError(r, 400);
+            }
+            break;
+
+        case HTTP_PARSE_HEADER_NAME:
+            if (c == '\n') {
+                if (r.tokenLen == 0) {
+                    // Blank line: end of headers
+                    if (r.contentLength > 0) r.state = HTTP_PARSE_BODY;
+                    else r.state = HTTP_PARSE_DONE;
+                }
+                r.tokenLen = 0;
+            }
+            else if (c == ':') {
+                r.token[r.tokenLen] = '\0';
+                r.valueLen = 0;
+                r.state = HTTP_PARSE_HEADER_VALUE;
+            }
+            else if (c != '\r' && r.tokenLen < HTTP_TOKEN_MAX_LEN) {
+                // Over-long names are truncated and simply never match
+                r.token[r.tokenLen++] = (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+            }
+            break;
+
+        case HTTP_PARSE_HEADER_VALUE:
+            if (c == '\n') {
+                r.value[r.valueLen] = '\0';
+                r.tokenLen = 0;
+                r.state = HTTP_PARSE_HEADER_NAME;
+                httpApplyHeader(r);
+            }
+            else if (c == ' ' && r.valueLen == 0) {
+                // Skip leading whitespace
+            }
+            else if (c != '\r' && r.valueLen < HTTP_HEADER_VALUE_MAX_LEN) r.value[r.valueLen++] = c;
+            break;
+
+        case HTTP_PARSE_BODY:
+            r.body[r.bodyLen++] = c;
+            if (r.bodyLen >= r.contentLength) {
+                r.body[r.bodyLen] = '\0';
+                r.state = HTTP_PARSE_DONE;
+            }
+            break;
+
+        case HTTP_PARSE_DONE:
+        case HTTP_PARSE_ERROR:
+            break;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Transport
+// ---------------------------------------------------------------------------
+
+HttpConnection* httpAllocConnection() {
+    for (uint8_t i = 0; i < HTTP_MAX_CONNECTIONS; i++) {
+        HttpConnection& c = httpConnections[i];
+        if (c.inUse) continue;
+        c.inUse = true;
+        c.remoteClosed = false;
+        c.eventStream = false;
+        c.responding = false;
+        c.lastActivity = millis();
+        httpResetRequest(c.request);
+        return &c;
+    }
+    return NULL;
+}
+
+#ifdef ESP8266
+
+struct tcp_pcb* httpListenPcb = NULL;
+
+void httpReleaseConnection(HttpConnection& c) {
+    if (c.rx) pbuf_free(c.rx);
+    c.rx = NULL;
+    c.pcb = NULL;
+    c.inUse = false;
+}
+
+// lwIP callbacks only queue data or flag state; parsing and responding
+// happen in httpServerPoll() from the HTTP task.
+err_t httpOnReceive(void* arg, struct tcp_pcb* pcb, struct pbuf* p, err_t err) {
+    HttpConnection* c = (HttpConnection*)arg;
+    if (!c) {
+        if (p) pbuf_free(p);
+        return ERR_OK;
+    }
+    if (!p) {
+        c->remoteClosed = true;
+        return ERR_OK;
+    }
+    if (c->rx) pbuf_cat(c->rx, p);
+    else {
+        c->rx = p;
+        c->rxOffset = 0;
+    }
+    c->lastActivity = millis();
+    return ERR_OK;
+}
+
+void httpOnError(void* arg, err_t err) {
+    // The pcb has already been freed by lwIP
+    HttpConnection* c = (HttpConnection*)arg;
+    if (c) httpReleaseConnection(*c);
+}
+
+err_t httpOnAccept(void* arg, struct tcp_pcb* pcb, err_t err) {
+    if (err != ERR_OK || !pcb) return ERR_VAL;
+    HttpConnection* c = httpAllocConnection();
+    if (!c) {
+        tcp_abort(pcb);
+        return ERR_ABRT;
+    }
+    c->pcb = pcb;
+    c->rx = NULL;
+    c->rxOffset = 0;
+    tcp_arg(pcb, c);
+    tcp_recv(pcb, httpOnReceive);
+    tcp_err(pcb, httpOnError);
+    tcp_nagle_disable(pcb);
+    return ERR_OK;
+}
+
+bool httpTransportBegin(uint16_t port) {
+    struct tcp_pcb* pcb = tcp_new();
+    if (!pcb) return false;
+    if (tcp_bind(pcb, IP_ADDR_ANY, port) != ERR_OK) {
+        tcp_close(pcb);
+        return false;
+    }
+    httpListenPcb = tcp_listen_with_backlog(pcb, HTTP_MAX_CONNECTIONS);
+    if (!httpListenPcb) {
+        tcp_close(pcb);
+        return false;
+    }
+    tcp_accept(httpListenPcb, httpOnAccept);
+    return true;
+}
+
+void httpTransportAccept() {
+    // Connections arrive through httpOnAccept()
+}
+
+size_t httpTransportPeek(HttpConnection& c, uint8_t* buf, size_t size) {
+    if (!c.rx) return 0;
+    return pbuf_copy_partial(c.rx, buf, size, c.rxOffset);
+}
+
+void httpTransportConsume(HttpConnection& c, size_t length) {
+    if (!c.rx || length == 0) return;
+    // Free each segment once it has been read, so a client that keeps
+    // pipelining never grows the chain (or rxOffset) past what is unparsed.
+    // The next segment is referenced first: pbuf_cat() handed its only
+    // reference to the chain, and pbuf_free() would release it with the head.
+    c.rxOffset += length;
+    while (c.rx && c.rxOffset >= c.rx->len) {
+        struct pbuf* head = c.rx;
+        c.rxOffset -= head->len;
+        c.rx = head->next;
+        if (c.rx) pbuf_ref(c.rx);
+        pbuf_free(head);
+    }
+    if (!c.rx) c.rxOffset = 0;
+    // Reopen the receive window only for what has been parsed
+    if (c.pcb) tcp_recved(c.pcb, length);
+}
+
+size_t httpTransportWrite(HttpConnection& c, const uint8_t* data, size_t length) {
+    if (!c.pcb) return 0;
+    size_t room = tcp_sndbuf(c.pcb);
+    if (length > room) length = room;
+    if (length == 0) return 0;
+    if (tcp_write(c.pcb, data, length, TCP_WRITE_FLAG_COPY) != ERR_OK) return 0;
+    return length;
+}
+
+void httpTransportFlush(HttpConnection& c) {
+    if (c.pcb) tcp_output(c.pcb);
+}
+
+bool httpTransportOpen(HttpConnection& c) {
+    return c.pcb != NULL;
+}
+
+bool httpTransportPending(HttpConnection& c) {
+    return c.rx != NULL;
+}
+
+void httpTransportClose(HttpConnection& c) {
+    if (c.pcb) {
+        tcp_arg(c.pcb, NULL);
+        tcp_recv(c.pcb, NULL);
+        tcp_err(c.pcb, NULL);
+        if (tcp_close(c.pcb) != ERR_OK) tcp_abort(c.pcb);
+    }
+    httpReleaseConnection(c);
+}
+
+#else // POSIX sockets
+
+int httpListenFd = -1;
+
+bool httpTransportBegin(uint16_t port) {
+    // Several instances on one host: NATIVE_HTTP_PORT overrides (0 = any free port)
+    const char* portOverride = getenv("NATIVE_HTTP_PORT");
+    if (portOverride && *portOverride) port = (uint16_t)atoi(portOverride);
+    httpListenFd = socket(AF_INET, SOCK_STREAM, 0);
+    if (httpListenFd < 0) return false;
+    int one = 1;
+    setsockopt(httpListenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    if (bind(httpListenFd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(httpListenFd, HTTP_MAX_CONNECTIONS) < 0) {
+        close(httpListenFd);
+        httpListenFd = -1;
+        return false;
+    }
+    fcntl(httpListenFd, F_SETFL, O_NONBLOCK);
+    return true;
+}
+
+void httpTransportAccept() {
+    while (true) {
+        int fd = accept(httpListenFd, NULL, NULL);
+        if (fd < 0) return;
+        HttpConnection* c = httpAllocConnection();
+        if (!c) {
+            close(fd);
+            continue;
+        }
+        fcntl(fd, F_SETFL, O_NONBLOCK);
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        c->fd = fd;
+        c->rxLen = 0;
+        c->rxPos = 0;
+    }
+}
+
+size_t httpTransportPeek(HttpConnection& c, uint8_t* buf, size_t size) {
+    if (c.rxPos == c.rxLen) {
+        c.rxPos = 0;
+        c.rxLen = 0;
+        ssize_t n = recv(c.fd, c.rx, sizeof(c.rx), 0);
+        if (n > 0) {
+            c.rxLen = (uint16_t)n;
+            c.lastActivity = millis();
+        }
+        else if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) c.remoteClosed = true;
+    }
+    size_t available = c.rxLen - c.rxPos;
+    if (size > available) size = available;
+    memcpy(buf, c.rx + c.rxPos, size);
+    return size;
+}
+
+void httpTransportConsume(HttpConnection& c, size_t length) {
+    c.rxPos += length;
+}
+
+size_t httpTransportWrite(HttpConnection& c, const uint8_t* data, size_t length) {
+    ssize_t n = send(c.fd, data, length, MSG_NOSIGNAL);
+    if (n > 0) return (size_t)n;
+    if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) c.remoteClosed = true;
+    return 0;
+}
+
+void httpTransportFlush(HttpConnection&) {
+}
+
+bool httpTransportOpen(HttpConnection& c) {
+    return c.fd >= 0;
+}
+
+bool httpTransportPending(HttpConnection& c) {
+    return c.rxPos < c.rxLen;
+}
+
+void httpTransportClose(HttpConnection& c) {
+    if (c.fd >= 0) close(c.fd);
+    c.fd = -1;
+    c.inUse = false;
+}
+
+#endif
+
+// ---------------------------------------------------------------------------
+// Responses (called from route handlers)
+// ---------------------------------------------------------------------------
+
+bool httpPumpResponse(HttpConnection& c);
+
+const char* httpStatusText(int code) {
+    switch (code) {
+        case 200: return "OK";
+        case 304: return "Not Modified";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 413: return "Payload Too Large";
+        case 414: return "URI Too Long";
+        case 503: return "Service Unavailable";
+        default: return "Error";
+    }
+}
+
+// Add a response header; call before httpSend()
+void httpSendHeader(const char* name, const char* value) {
+    HttpConnection* c = httpCurrent;
+    if (!c) return;
+    int n = snprintf(c->extraHeaders + c->extraHeadersLen, sizeof(c->extraHeaders) - c->extraHeadersLen, "%s: %s\r\n", name, value);
+    if (n > 0 && c->extraHeadersLen + n < (int)sizeof(c->extraHeaders)) c->extraHeadersLen += n;
+}
+
+// Queue a response. The body is referenced, not copied, unless it fits in the
+// tx buffer after the headers, so it must outlive the response otherwise.
+void httpSendResponse(int code, const char* contentType, const uint8_t* body, size_t length, bool progmem) {
+    HttpConnection* c = httpCurrent;
+    if (!c || c->responding) return;
+
+    bool sendBody = (c->request.method != HTTP_METHOD_HEAD && code != 304);
+    int n = snprintf(c->tx, sizeof(c->tx),
+        "HTTP/1.1 %d %s\r\nContent-Type: %s\r\nContent-Length: %u\r\nConnection: %s\r\n%s\r\n",
+        code, httpStatusText(code), contentType, (unsigned)(code == 304 ? 0 : length),
+        c->closeAfterResponse ? "close" : "keep-alive", c->extraHeaders);
+    c->txLen = (n > 0 && n < (int)sizeof(c->tx)) ? n : 0;
+    c->txSent = 0;
+    c->streamWriter = NULL;
+    c->streamIndex = 0;
+    c->body = NULL;
+    c->bodyLen = 0;
+    c->bodySent = 0;
+    c->bodyProgmem = progmem;
+
+    if (sendBody && length > 0) {
+        if (!progmem && c->txLen + length <= sizeof(c->tx)) {
+            memcpy(c->tx + c->txLen, body, length);
+            c->txLen += length;
+        }
+        else {
+            c->body = body;
+            c->bodyLen = length;
+        }
+    }
+    c->responding = true;
+}
+
+void httpSend(int code, const char* contentType, const char* body) {
+    httpSendResponse(code, contentType, (const uint8_t*)body, strlen(body), false);
+}
+
+void httpSend(int code) {
+    httpSendResponse(code, "text/plain", NULL, 0, false);
+}
+
+void httpSend_P(int code, const char* contentType, const uint8_t* body, size_t length) {
+    httpSendResponse(code, contentType, body, length, true);
+}
+
+// Send a response generated piece by piece into the tx buffer, for bodies
+// too large to build in RAM. Each part must fit HTTP_TX_BUFFER_LEN. The
+// length is not known up front, so closing the connection ends the body.
+void httpSendStream(int code, const char* contentType, HttpStreamWriter writer) {
+    HttpConnection* c = httpCurrent;
+    if (!c || c->responding) return;
+    c->closeAfterResponse = true;
+    int n = snprintf(c->tx, sizeof(c->tx),
+        "HTTP/1.1 %d %s\r\nContent-Type: %s\r\nConnection: close\r\n%s\r\n",
+        code, httpStatusText(code), contentType, c->extraHeaders);
+    c->txLen = (n > 0 && n < (int)sizeof(c->tx)) ? n : 0;
+    c->txSent = 0;
+    c->bodyLen = 0;
+    c->bodySent = 0;
+    c->streamWriter = NULL;
+    c->streamIndex = 0;
+    c->responding = true;
+    if (c->request.method != HTTP_METHOD_HEAD) c->streamWriter = writer;
+}
+
+uint8_t httpEventStreamCount() {
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < HTTP_MAX_CONNECTIONS; i++) {
+        if (httpConnections[i].inUse && httpConnections[i].eventStream) count++;
+    }
+    return count;
+}
+
+// Turn the current request into a Server-Sent Events stream. The connection
+// stays open; push events with httpSendEvent(). Returns false if too many
+// streams are already open (a 503 has been sent instead).
+bool httpBeginEventStream() {
+    HttpConnection* c = httpCurrent;
+    if (!c || c->responding) return false;
+    if (httpEventStreamCount() >= HTTP_MAX_EVENT_STREAMS) {
+        c->closeAfterResponse = true;
+        httpSend(503, "text/plain", "Too many event streams");
+        return false;
+    }
+    int n = snprintf(c->tx, sizeof(c->tx),
+        "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\nCache-Control: no-cache\r\nConnection: keep-alive\r\n%s\r\n",
+        c->extraHeaders);
+    c->txLen = (n > 0 && n < (int)sizeof(c->tx)) ? n : 0;
+    c->txSent = 0;
+    c->bodyLen = 0;
+    c->bodySent = 0;
+    c->streamWriter = NULL;
+    c->closeAfterResponse = false;
+    c->eventStream = true;
+    c->responding = true;
+    return true;
+}
+
+bool httpIsEventStream(uint8_t index) {
+    HttpConnection& c = httpConnections[index];
+    return c.inUse && c.eventStream;
+}
+
+// Start sending the first length bytes of tx on an event stream
+void httpPushEventStream(HttpConnection& c, size_t length) {
+    c.txLen = length;
+    c.txSent = 0;
+    c.bodyLen = 0;
+    c.bodySent = 0;
+    c.responding = true;
+    if (httpPumpResponse(c)) c.responding = false;
+    if (c.txSent > 0) c.lastActivity = millis();
+}
+
+// Queue one event on stream `index`. Returns false (and drops nothing) while
+// the previous event is still being sent, so slow clients are simply skipped.
+bool httpSendEvent(uint8_t index, const char* data) {
+    HttpConnection& c = httpConnections[index];
+    if (!c.inUse || !c.eventStream || c.responding) return false;
+    int n = snprintf(c.tx, sizeof(c.tx), "data: %s\n\n", data);
+    if (n <= 0 || n >= (int)sizeof(c.tx)) return false;
+    httpPushEventStream(c, n);
+    return true;
+}
+
+// Index of the connection being handled, for per-client state in handlers
+uint8_t httpCurrentIndex() {
+    return httpCurrent ? (uint8_t)(httpCurrent - httpConnections) : 0;
+}
+
+// ---------------------------------------------------------------------------
+// Request accessors (called from route handlers)
+// ---------------------------------------------------------------------------
+
+HttpMethod httpMethod() {
+    return httpCurrent ? httpCurrent->request.method : HTTP_METHOD_OTHER;
+}
+
+const char* httpIfNoneMatch() {
+    return httpCurrent ? httpCurrent->request.ifNoneMatch : "";
+}
+
+uint8_t httpHexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return 0;
+}
+
+// Find name=value in an urlencoded list and decode value into out
+bool httpFindArg(const char* list, const char* name, char* out, size_t outSize) {
+    size_t nameLen = strlen(name);
+    const char* p = list;
+    while (*p) {
+        const char* end = strchr(p, '&');
+        if (!end) end = p + strlen(p);
+        if ((size_t)(end - p) > nameLen && strncmp(p, name, nameLen) == 0 && p[nameLen] == '=') {
+            size_t n = 0;
+            for (const char* v = p + nameLen + 1; v < end && n + 1 < outSize; v++) {
+                if (*v == '+') out[n++] = ' ';
+                else if (*v == '%' && v + 2 < end) {
+                    out[n++] = (char)((httpHexValue(v[1]) << 4) | httpHexValue(v[2]));
+                    v += 2;
+                }
+                else out[n++] = *v;
+            }
+            out[n] = '\0';
+            return true;
+        }
+        p = (*end == '&') ? end + 1 : end;
+    }
+    return false;
+}
+
+// Look up a query string or urlencoded form argument
+bool httpArg(const char* name, char* out, size_t outSize) {
+    if (!httpCurrent || outSize == 0) return false;
+    HttpRequest& r = httpCurrent->request;
+    return httpFindArg(r.query, name, out, outSize) || httpFindArg(r.body, name, out, outSize);
+}
+
+// Same into a fixed string; a value longer than it sets out.truncated()
+template <size_t N>
+bool httpArg(const char* name, FixedString<N>& out) {
+    char value[N + 2];
+    out.clear();
+    if (!httpArg(name, value, sizeof(value))) return false;
+    out = value;
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Server
+// ---------------------------------------------------------------------------
+
+void httpOn(const char* path, HttpMethod method, HttpHandler handler) {
+    if (httpRouteCount >= HTTP_MAX_ROUTES) {
+        LOG_E(LOG_HTTP, "route table full");
+        return;
+    }
+    httpRoutes[httpRouteCount++] = {path, method, handler};
+}
+
+void httpOn(const char* path, HttpHandler handler) {
+    httpOn(path, HTTP_METHOD_ANY, handler);
+}
+
+void httpOnNotFound(HttpHandler handler) {
+    httpNotFoundHandler = handler;
+}
+
+bool httpServerBegin(uint16_t port) {
+    if (httpServerStarted) return true;
+    for (uint8_t i = 0; i < HTTP_MAX_CONNECTIONS; i++) {
+        httpConnections[i].inUse = false;
+#ifndef ESP8266
+        httpConnections[i].fd = -1;
+#endif
+    }
+    httpServerStarted = httpTransportBegin(port);
+    return httpServerStarted;
+}
+
+void httpDispatch(HttpConnection& c) {
+    httpCurrent = &c;
+    c.extraHeaders[0] = '\0';
+    c.extraHeadersLen = 0;
+    c.closeAfterResponse = !c.request.keepAlive;
+
+    if (c.request.state == HTTP_PARSE_ERROR) {
+        c.closeAfterResponse = true;
+        httpSend(c.request.errorCode, "text/plain", httpStatusText(c.request.errorCode));
+    }
+    else {
+        HttpHandler handler = httpNotFoundHandler;
+        for (uint8_t i = 0; i < httpRouteCount; i++) {
+            HttpRoute& route = httpRoutes[i];
+            if (strcmp(route.path, c.request.target) != 0) continue;
+            bool methodMatches = route.method == HTTP_METHOD_ANY || route.method == c.request.method ||
+                                 (route.method == HTTP_METHOD_GET && c.request.method == HTTP_METHOD_HEAD);
+            if (methodMatches) {
+                handler = route.handler;
+                break;
+            }
+        }
+        if (handler) handler();
+        // Handlers must answer; fall back to 404 if one did not
+        if (!c.responding) httpSend(404, "text/plain", "Not Found");
+    }
+    httpCurrent = NULL;
+}
+
+// Push as much of the pending response as the socket accepts.
+// Returns true once everything has been handed to the transport.
+bool httpPumpResponse(HttpConnection& c) {
+    for (;;) {
+        while (c.txSent < c.txLen) {
+            size_t n = httpTransportWrite(c, (const uint8_t*)c.tx + c.txSent, c.txLen - c.txSent);
+            if (n == 0) break;
+            c.txSent += n;
+        }
+        while (c.txSent == c.txLen && c.bodySent < c.bodyLen) {
+            uint8_t chunk[HTTP_IO_CHUNK];
+            size_t length = c.bodyLen - c.bodySent;
+            if (length > sizeof(chunk)) length = sizeof(chunk);
+            const uint8_t* src = c.body + c.bodySent;
+            if (c.bodyProgmem) {
+                memcpy_P(chunk, src, length);
+                src = chunk;
+            }
+            size_t n = httpTransportWrite(c, src, length);
+            if (n == 0) break;
+            c.bodySent += n;
+        }
+        // Generate the next part of a streamed body once the last one is out
+        if (c.txSent != c.txLen || c.bodySent != c.bodyLen || !c.streamWriter) break;
+        size_t n = c.streamWriter(c.tx, sizeof(c.tx), c.streamIndex++);
+        if (n == 0 || n >= sizeof(c.tx)) {
+            c.streamWriter = NULL;
+            break;
+        }
+        c.txLen = n;
+        c.txSent = 0;
+    }
+    httpTransportFlush(c);
+    return c.txSent == c.txLen && c.bodySent == c.bodyLen && !c.streamWriter;
+}
+
+// Event streams only end when the client goes away, and there are just
+// HTTP_MAX_EVENT_STREAMS of them. A quiet stream gets a comment line every
+// HTTP_EVENT_KEEPALIVE_MS, so a client that vanished shows up as a failed
+// write; one that stops taking data loses its slot after
+// HTTP_EVENT_IDLE_TIMEOUT_MS. Browsers reconnect an EventSource on their own.
+void httpServiceEventStream(HttpConnection& c) {
+    // Anything the client sends on an event stream is ignored
+    uint8_t buf[HTTP_IO_CHUNK];
+    httpTransportConsume(c, httpTransportPeek(c, buf, sizeof(buf)));
+
+    if (c.responding) {
+        uint16_t sent = c.txSent;
+        size_t bodySent = c.bodySent;
+        if (httpPumpResponse(c)) c.responding = false;
+        if (c.txSent != sent || c.bodySent != bodySent) c.lastActivity = millis();
+    }
+    if (!httpTransportOpen(c)) {
+        c.inUse = false;
+        return;
+    }
+    unsigned long idle = millis() - c.lastActivity;
+    if (c.remoteClosed || idle > HTTP_EVENT_IDLE_TIMEOUT_MS) {
+        httpTransportClose(c);
+        return;
+    }
+    if (!c.responding && idle > HTTP_EVENT_KEEPALIVE_MS) {
+        static const char keepalive[] = ": keepalive\n\n";
+        memcpy(c.tx, keepalive, sizeof(keepalive) - 1);
+        httpPushEventStream(c, sizeof(keepalive) - 1);
+    }
+}
+
+void httpServiceConnection(HttpConnection& c) {
+    if (c.eventStream) {
+        httpServiceEventStream(c);
+        return;
+    }
+
+    // Parse whatever has arrived; stop at the end of one request
+    if (!c.responding) {
+        uint8_t buf[HTTP_IO_CHUNK];
+        size_t length = httpTransportPeek(c, buf, sizeof(buf));
+        size_t used = 0;
+        while (used < length) {
+            httpParseByte(c.request, (char)buf[used++]);
+            if (c.request.state == HTTP_PARSE_DONE || c.request.state == HTTP_PARSE_ERROR) break;
+        }
+        httpTransportConsume(c, used);
+        if (c.request.state == HTTP_PARSE_DONE || c.request.state == HTTP_PARSE_ERROR) {
+            c.lastActivity = millis();
+            httpDispatch(c);
+        }
+    }
+
+    if (c.responding && httpPumpResponse(c)) {
+        c.responding = false;
+        c.lastActivity = millis();
+        if (c.closeAfterResponse) {
+            httpTransportClose(c);
+            return;
+        }
+        httpResetRequest(c.request);
+    }
+
+    if (!httpTransportOpen(c)) {
+        c.inUse = false;
+        return;
+    }
+    bool finished = c.remoteClosed && !c.responding && !httpTransportPending(c);
+    if (finished || millis() - c.lastActivity > HTTP_IDLE_TIMEOUT_MS) {
+        httpTransportClose(c);
+    }
+}
+
+// HTTP task: accept, parse and answer without ever waiting on a socket
+void httpServerPoll() {
+    if (!httpServerStarted) return;
+    httpTransportAccept();
+    for (uint8_t i = 0; i < HTTP_MAX_CONNECTIONS; i++) {
+        if (httpConnections[i].inUse) httpServiceConnection(httpConnections[i]);
+    }
+}
+
+#endif // HTTP_UTILS_H
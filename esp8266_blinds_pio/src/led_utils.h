@@ -11,21 +11,84 @@
 // Global LED array
 extern CRGB leds[NEOPIXEL_COUNT];
 
-void printSeparator(int case_num) {
-    switch (case_num) {
-        case 1:
-            Serial.println("\n \n \n");
-            Serial.println("----------------------------------------------------------------");
-            break;
-        case 2:
-            Serial.println("----------------------------------------------------------------");
-            Serial.println("\n \n \n");
-            break;
-        default:
-            Serial.println("----------------------------------------------------------------");
-            break;
-    }
-}
+// LED Pattern Configuration
+#define LED_WAVE_STEPS 64  // samples per period in the breathe/pulse tables
+
+// What the LED shows. Moving is an overlay: it shows while a blind moves,
+// then the LED goes back to the current status.
+enum LedStatus : uint8_t {
+    LED_STATUS_IDLE = 0,  // off
+    LED_STATUS_WIFI_CONNECTING,
+    LED_STATUS_MQTT_CONNECTING,
+    LED_STATUS_AP_PORTAL,
+    LED_STATUS_ERROR,
+    LED_STATUS_MOVING,
+    LED_STATUS_COUNT
+};
+
+enum LedPatternShape : uint8_t {
+    LED_SHAPE_SOLID = 0,
+    LED_SHAPE_BLINK,    // square wave, 50% duty
+    LED_SHAPE_BREATHE,  // raised cosine
+    LED_SHAPE_PULSE     // quick rise, exponential decay
+};
+
+struct LedPattern {
+    uint8_t r, g, b;
+    uint8_t shape;
+    uint16_t periodMs;
+};
+
+// Colors are the raw values this board has always been driven with
+// (0, 255, 0 shows red)
+const LedPattern ledPatterns[LED_STATUS_COUNT] PROGMEM = {
+    {   0,   0,   0, LED_SHAPE_SOLID,      0 },  // idle: off
+    {   0,   0, 255, LED_SHAPE_PULSE,   1000 },  // WiFi connecting: blue
+    { 128,   0, 128, LED_SHAPE_PULSE,   1000 },  // MQTT connecting: purple
+    { 255, 255, 255, LED_SHAPE_BREATHE, 3000 },  // setup portal: white
+    {   0, 255,   0, LED_SHAPE_BLINK,    500 },  // error: red
+    { 255, 255,   0, LED_SHAPE_BREATHE, 1500 },  // moving: yellow
+};
+
+// Perceived brightness -> PWM level (gamma 2.6). The waveform tables are
+// in perceived brightness so fades look even.
+const uint8_t ledGammaTable[256] PROGMEM = {
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   1,   1,   1,   1,   1,   1,   1,   1,
+      1,   1,   1,   1,   2,   2,   2,   2,   2,   2,   2,   2,   3,   3,   3,   3,
+      3,   3,   4,   4,   4,   4,   5,   5,   5,   5,   5,   6,   6,   6,   6,   7,
+      7,   7,   8,   8,   8,   9,   9,   9,  10,  10,  10,  11,  11,  11,  12,  12,
+     13,  13,  13,  14,  14,  15,  15,  16,  16,  17,  17,  18,  18,  19,  19,  20,
+     20,  21,  21,  22,  22,  23,  24,  24,  25,  25,  26,  27,  27,  28,  29,  29,
+     30,  31,  31,  32,  33,  34,  34,  35,  36,  37,  38,  38,  39,  40,  41,  42,
+     42,  43,  44,  45,  46,  47,  48,  49,  50,  51,  52,  53,  54,  55,  56,  57,
+     58,  59,  60,  61,  62,  63,  64,  65,  66,  68,  69,  70,  71,  72,  73,  75,
+     76,  77,  78,  80,  81,  82,  84,  85,  86,  88,  89,  90,  92,  93,  94,  96,
+     97,  99, 100, 102, 103, 105, 106, 108, 109, 111, 112, 114, 115, 117, 119, 120,
+    122, 124, 125, 127, 129, 130, 132, 134, 136, 137, 139, 141, 143, 145, 146, 148,
+    150, 152, 154, 156, 158, 160, 162, 164, 166, 168, 170, 172, 174, 176, 178, 180,
+    182, 184, 186, 188, 191, 193, 195, 197, 199, 202, 204, 206, 209, 211, 213, 215,
+    218, 220, 223, 225, 227, 230, 232, 235, 237, 240, 242, 245, 247, 250, 252, 255,
+};
+
+const uint8_t ledBreatheTable[LED_WAVE_STEPS] PROGMEM = {
+      0,   1,   2,   5,  10,  15,  21,  29,  37,  47,  57,  67,  79,  90, 103, 115,
+    127, 140, 152, 165, 176, 188, 198, 208, 218, 226, 234, 240, 245, 250, 253, 254,
+    255, 254, 253, 250, 245, 240, 234, 226, 218, 208, 198, 188, 176, 165, 152, 140,
+    128, 115, 103,  90,  79,  67,  57,  47,  37,  29,  21,  15,  10,   5,   2,   1,
+};
+
+const uint8_t ledPulseTable[LED_WAVE_STEPS] PROGMEM = {
+     64, 128, 191, 255, 228, 204, 183, 164, 146, 131, 117, 105,  94,  84,  75,  67,
+     60,  54,  48,  43,  39,  35,  31,  28,  25,  22,  20,  18,  16,  14,  13,  11,
+     10,   9,   8,   7,   7,   6,   5,   5,   4,   4,   3,   3,   3,   2,   2,   2,
+      2,   2,   1,   1,   1,   1,   1,   1,   1,   1,   1,   1,   0,   0,   0,   0,
+};
+
+LedStatus ledStatus = LED_STATUS_IDLE;
+bool ledMoving = false;
+unsigned long ledPatternStartTime = 0;
+CRGB ledShownColor;  // what the strip currently shows
 
 // Initialize the LED
 void initLed() {
@@ -33,21 +96,43 @@ void initLed() {
     FastLED.setBrightness(100);
     FastLED.clear();
     FastLED.show();
+    ledShownColor = CRGB::Black;
 }
 
-// Set LED to a specific RGB color
-void setLedColor(uint8_t r, uint8_t g, uint8_t b) {
-    leds[0] = CRGB(r, g, b);
-    FastLED.show();
+// Status changes only record the new state; the LED task renders it
+void ledSetStatus(LedStatus status) {
+    if (status == ledStatus) return;
+    ledStatus = status;
+    if (!ledMoving) ledPatternStartTime = millis();
 }
 
-void setLedOff() {
-    leds[0] = CRGB::Black;
-    delay(1000);
-    FastLED.show();
-    leds[0] = CRGB::Black;
-    delay(1000);
+void ledSetMoving(bool moving) {
+    if (moving == ledMoving) return;
+    ledMoving = moving;
+    ledPatternStartTime = millis();
+}
+
+// Output level 0-255 of a pattern shape at a point in its period
+uint8_t ledShapeLevel(uint8_t shape, uint16_t periodMs, unsigned long elapsedMs) {
+    if (shape == LED_SHAPE_SOLID || periodMs == 0) return 255;
+    uint16_t phase = elapsedMs % periodMs;
+    if (shape == LED_SHAPE_BLINK) return phase < periodMs / 2 ? 255 : 0;
+    uint8_t step = (uint32_t)phase * LED_WAVE_STEPS / periodMs;
+    uint8_t level = pgm_read_byte(shape == LED_SHAPE_BREATHE ? &ledBreatheTable[step] : &ledPulseTable[step]);
+    return pgm_read_byte(&ledGammaTable[level]);
+}
+
+// LED task: render the active pattern, push it to the strip only on change
+void handleLed() {
+    LedPattern pattern;
+    memcpy_P(&pattern, &ledPatterns[ledMoving ? LED_STATUS_MOVING : ledStatus], sizeof(pattern));
+    uint16_t scale = ledShapeLevel(pattern.shape, pattern.periodMs, millis() - ledPatternStartTime) + 1;
+    CRGB color((pattern.r * scale) >> 8, (pattern.g * scale) >> 8, (pattern.b * scale) >> 8);
+
+    if (color == ledShownColor) return;
+    leds[0] = color;
     FastLED.show();
+    ledShownColor = color;
 }
 
 #endif // LED_UTILS_H
@@ -0,0 +1,179 @@
+#ifndef LOG_UTILS_H
+#define LOG_UTILS_H
+
+#include <Arduino.h>
+#include <stdarg.h>
+
+// Log Configuration
+// LOG_LEVEL and LOG_MODULES filter at compile time: a call below the level
+// or outside the module mask compiles to nothing and its arguments are
+// never evaluated.
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+// Modules, one bit each
+#define LOG_SYS 0x01
+#define LOG_WIFI 0x02
+#define LOG_MQTT 0x04
+#define LOG_CONFIG 0x08
+#define LOG_HTTP 0x10
+#define LOG_MOTOR 0x20
+#define LOG_BUTTON 0x40
+#define LOG_POWER 0x80
+
+#ifndef LOG_MODULES
+#define LOG_MODULES 0xFF
+#endif
+
+#define LOG_RING_SIZE 2048  // power of two
+#define LOG_LINE_MAX 120    // longer lines are cut; fits the 128-byte UART FIFO with CR LF
+
+// Lines at this level or more severe also go to the remote sinks: syslog
+// over UDP when LOG_SYSLOG_HOST is defined, MQTT when LOG_MQTT_SINK is 1
+#ifndef LOG_REMOTE_LEVEL
+#define LOG_REMOTE_LEVEL LOG_LEVEL_WARN
+#endif
+#ifndef LOG_SYSLOG_PORT
+#define LOG_SYSLOG_PORT 514
+#endif
+#ifndef LOG_SYSLOG_TAG
+#define LOG_SYSLOG_TAG "blinds"
+#endif
+
+static_assert((LOG_RING_SIZE & (LOG_RING_SIZE - 1)) == 0, "LOG_RING_SIZE must be a power of two");
+
+#ifdef LOG_SYSLOG_HOST
+#include <ESP8266WiFi.h>
+#include <WiFiUdp.h>
+#endif
+
+// Formats stay in flash (PSTR). The sizeof() is never evaluated; it only
+// makes the compiler check the arguments against the format.
+#define LOG_EMIT(level, module, format, ...)                                   \
+    do {                                                                       \
+        if ((module) & LOG_MODULES) {                                          \
+            (void)sizeof(printf(format, ##__VA_ARGS__));                       \
+            logWrite(level, module, PSTR(format), ##__VA_ARGS__);              \
+        }                                                                      \
+    } while (0)
+
+// Disabled levels: nothing is generated, but the arguments still count as
+// used and the format is still checked
+#define LOG_DISCARD(format, ...) do { (void)sizeof(printf(format, ##__VA_ARGS__)); } while (0)
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_E(module, format, ...) LOG_EMIT(LOG_LEVEL_ERROR, module, format, ##__VA_ARGS__)
+#else
+#define LOG_E(module, format, ...) LOG_DISCARD(format, ##__VA_ARGS__)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_W(module, format, ...) LOG_EMIT(LOG_LEVEL_WARN, module, format, ##__VA_ARGS__)
+#else
+#define LOG_W(module, format, ...) LOG_DISCARD(format, ##__VA_ARGS__)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_I(module, format, ...) LOG_EMIT(LOG_LEVEL_INFO, module, format, ##__VA_ARGS__)
+#else
+#define LOG_I(module, format, ...) LOG_DISCARD(format, ##__VA_ARGS__)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_D(module, format, ...) LOG_EMIT(LOG_LEVEL_DEBUG, module, format, ##__VA_ARGS__)
+#else
+#define LOG_D(module, format, ...) LOG_DISCARD(format, ##__VA_ARGS__)
+#endif
+
+// Remote sink for forwarded lines (line is not NUL-terminated)
+typedef void (*LogSink)(uint8_t level, const char* line, size_t len);
+LogSink logMqttSink = NULL;  // set by mqtt_utils.h while connected
+
+// Byte ring of records: level, length, text. logWrite() appends whole
+// lines from task context (never from an ISR); handleLog() drains them.
+struct LogRing {
+    uint8_t data[LOG_RING_SIZE];
+    uint32_t head;  // free-running byte counters
+    uint32_t tail;
+};
+
+LogRing logRing;
+uint32_t logDropped = 0;          // lines lost to a full ring
+uint32_t logDroppedReported = 0;
+
+const char* logModuleName(uint8_t module) {
+    static const char* const names[] = { "sys", "wifi", "mqtt", "config", "http", "motor", "button", "power" };
+    return module ? names[__builtin_ctz(module)] : "?";
+}
+
+void logPush(uint8_t level, const char* line, size_t len) {
+    if (LOG_RING_SIZE - (logRing.head - logRing.tail) < len + 2) {
+        logDropped++;
+        return;
+    }
+    logRing.data[logRing.head++ & (LOG_RING_SIZE - 1)] = level;
+    logRing.data[logRing.head++ & (LOG_RING_SIZE - 1)] = (uint8_t)len;
+    for (size_t i = 0; i < len; i++) logRing.data[logRing.head++ & (LOG_RING_SIZE - 1)] = line[i];
+}
+
+void logWrite(uint8_t level, uint8_t module, PGM_P format, ...) {
+    char line[LOG_LINE_MAX + 1];
+    int prefix = snprintf(line, sizeof(line), "%c %-6s ", "?EWID"[level], logModuleName(module));
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf_P(line + prefix, sizeof(line) - prefix, format, args);
+    va_end(args);
+    if (n < 0) n = 0;
+    if (n > LOG_LINE_MAX - prefix) n = LOG_LINE_MAX - prefix;
+    logPush(level, line, prefix + n);
+}
+
+#ifdef LOG_SYSLOG_HOST
+WiFiUDP logUdp;
+
+// RFC 3164 message, facility local0
+void logSyslog(uint8_t level, const char* line, size_t len) {
+    static const uint8_t severity[] = { 7, 3, 4, 6, 7 };
+    if (WiFi.status() != WL_CONNECTED || !logUdp.beginPacket(LOG_SYSLOG_HOST, LOG_SYSLOG_PORT)) return;
+    logUdp.printf("<%u>" LOG_SYSLOG_TAG ": ", 16 * 8 + severity[level]);
+    logUdp.write((const uint8_t*)line, len);
+    logUdp.endPacket();
+}
+#endif
+
+void logForward(uint8_t level, const char* line, size_t len) {
+    if (level > LOG_REMOTE_LEVEL) return;
+#ifdef LOG_SYSLOG_HOST
+    logSyslog(level, line, len);
+#endif
+    if (logMqttSink) logMqttSink(level, line, len);
+}
+
+// Log task: move whole lines to the UART as long as its FIFO has room, so
+// logging never waits on the 115200 baud line
+void handleLog() {
+    char line[LOG_LINE_MAX];
+    while (logRing.tail != logRing.head) {
+        uint8_t level = logRing.data[logRing.tail & (LOG_RING_SIZE - 1)];
+        uint8_t len = logRing.data[(logRing.tail + 1) & (LOG_RING_SIZE - 1)];
+        if (Serial.availableForWrite() < len + 2) return;
+        for (uint8_t i = 0; i < len; i++) line[i] = logRing.data[(logRing.tail + 2 + i) & (LOG_RING_SIZE - 1)];
+        logRing.tail += len + 2;
+        Serial.write((const uint8_t*)line, len);
+        Serial.write("\r\n");
+        logForward(level, line, len);
+    }
+    if (logDropped != logDroppedReported && Serial.availableForWrite() >= 40) {
+        Serial.printf("W sys    %u log lines dropped\r\n", (unsigned)(logDropped - logDroppedReported));
+        logDroppedReported = logDropped;
+    }
+}
+
+#endif // LOG_UTILS_H
@@ -2,71 +2,77 @@
 ESP8266 AP Mode - WiFi Configuration Portal
 */
 
-#include <EEPROM.h>
 
 #include "led_utils.h"
 #include "mqtt_utils.h"
 #include "wifi_utils.h"
-#include "eeprom_utils.h"
+#include "config_utils.h"
+#include "motor_utils.h"
+#include "scheduler_utils.h"
+#include "power_utils.h"
+#include "button_utils.h"
+#include "log_utils.h"
 
 // Define the LED array (declared as extern in led_utils.h)
 CRGB leds[NEOPIXEL_COUNT];
 
-// Wifi Button Configuration
-#define WIFI_SETUP_BUTTON 4
-bool lastButtonState = HIGH;
-bool currentButtonState = HIGH;
-unsigned long lastDebounceTime = 0;
-unsigned long debounceDelay = 50;  // 50ms debounce delay
-
 void setup() {
     // Initialize Serial
     Serial.begin(115200);
     delay(1000);
-    Serial.println("\n \n \n");
-
-    // Initialize EEPROM
-    EEPROM.begin(EEPROM_SIZE);
-    // clearEEPROM();
+    Serial.println();  // end the boot ROM's line; everything else goes through the log
 
     // Initialize LED
     initLed();
 
-    // Initialize WIFI_SETUP_BUTTON
-    pinMode(WIFI_SETUP_BUTTON, INPUT_PULLUP);
-    lastButtonState = digitalRead(WIFI_SETUP_BUTTON);
-    currentButtonState = lastButtonState;
+    // Load settings from the flash config store
+    configBegin();
+
+    // Initialize the button (pin-change interrupt)
+    initButton();
 
-    // Check if WiFi credentials are already stored
-    if (readWifiCredentialsFromEEPROM())
-      connectToWiFi();
-    else{
+    // Initialize Motor
+    initMotor();
+
+    // Check if WiFi credentials are already stored (both paths are non-blocking)
+    if (readWifiCredentials())
+      startWiFi();
+    else
       setupWifi();
-      connectToWiFi();
-    }
+
+    // Register cooperative tasks (name, callback, interval in ms)
+    addTask("motor", handleMotor, 0);
+    addTask("button", handleButton, 5);
+    addTask("http", handleWiFiServer, 5);
+    addTask("mqtt", handleMQTT, 10);
+    addTask("wifi", handleWiFi, 10);
+    addTask("led", handleLed, 20);
+    addTask("log", handleLog, 5);
+    addTask("status", handleStatusPush, 100);
+    addTask("config", handleConfig, 100);
+    addTask("power", handlePower, 100);
+    addTask("diag", handleDiagnostics, 1000);
+    addTask("stats", printSchedulerStats, SCHEDULER_STATS_INTERVAL_MS);
+
+    LOG_I(LOG_SYS, "Free heap at boot: %u bytes, largest free block: %u bytes",
+          (unsigned)ESP.getFreeHeap(), (unsigned)ESP.getMaxFreeBlockSize());
 }
 
 void loop() {
-    connectToWiFi();
-    handleWiFiServer();
-  
-    if (getWifiStatus()) {
-        setupMQTT();
-        sendMQTTDiscoveryMessage();
-        sendMQTTAvailabilityMessage();
-        // deleteMQTTDevice();
-    }
-    handleMQTTServer();
+    runScheduler();
+    powerIdleWait();
+}
 
-    // Check Wifi Setup Button
-    int reading = digitalRead(WIFI_SETUP_BUTTON);
-    if (reading != lastButtonState) lastDebounceTime = millis();
-    if ((millis() - lastDebounceTime) > debounceDelay && reading != currentButtonState) {
-        currentButtonState = reading;
-        if (currentButtonState == LOW){
-          resetWifiSetup();
-          setupWifi();
-        }
+#if !defined(ESP8266) && !defined(PIO_UNIT_TESTING)
+// env:native: the Arduino core is not there to call setup() and loop().
+// The 10 ms pause keeps a fleet of instances (scripts/fleet_sim.py) from
+// spinning every host core. Tests include this file for setup() and loop()
+// and bring their own main().
+int main() {
+    setup();
+    for (;;) {
+        loop();
+        delay(10);
     }
-    lastButtonState = reading;
 }
+#endif
@@ -0,0 +1,85 @@
+#ifndef METRICS_UTILS_H
+#define METRICS_UTILS_H
+
+#include <Arduino.h>
+
+#include "log_utils.h"
+
+// Latency Histogram Configuration
+// Bucket i counts durations below 16 * 4^i us: 16, 64, 256 us ... 65.5 ms, +Inf
+#define METRICS_HIST_BUCKETS 8
+
+// Fixed-size latency histogram. Recording is a count-leading-zeros and a
+// few increments, cheap enough to wrap every task call.
+struct LatencyHistogram {
+    uint32_t buckets[METRICS_HIST_BUCKETS];  // not cumulative
+    uint32_t count;
+    uint64_t sumUs;
+    uint32_t maxUs;
+};
+
+inline uint32_t metricsBucketBoundUs(uint8_t bucket) {
+    return 16UL << (2 * bucket);
+}
+
+inline void metricsRecord(LatencyHistogram& hist, uint32_t us) {
+    // Bit length of us: 0-4 -> bucket 0, 5-6 -> 1, 7-8 -> 2, ...
+    int bits = 32 - __builtin_clz(us | 1);
+    int bucket = (bits - 3) / 2;
+    if (bucket < 0) bucket = 0;
+    if (bucket >= METRICS_HIST_BUCKETS) bucket = METRICS_HIST_BUCKETS - 1;
+    hist.buckets[bucket]++;
+    hist.count++;
+    hist.sumUs += us;
+    if (us > hist.maxUs) hist.maxUs = us;
+}
+
+// Boot Timing Metrics (ms since reset, 0 = not reached yet)
+uint32_t metricBootToWifiMs = 0;
+uint32_t metricBootToMqttMs = 0;
+bool metricWifiFastConnect = false;  // last connection used the cached BSSID/channel
+uint32_t metricStartupJitterMs = 0;  // power-on network start delay (included above)
+
+// Connection Metrics
+uint32_t metricWifiConnects = 0;
+uint32_t metricWifiDrops = 0;
+uint32_t metricMqttConnects = 0;
+uint32_t metricMqttDrops = 0;  // established sessions that were lost
+uint32_t metricResolverLookups = 0;   // broker name lookups started
+uint32_t metricResolverFailures = 0;  // of those, failed or timed out
+
+// Flash config store commits
+LatencyHistogram metricConfigCommitHist;
+
+// Power Metrics
+uint32_t metricPowerIdleMs = 0;       // time spent in the low-power idle mode
+uint64_t metricCpuSleepUs = 0;        // time the CPU was handed to the SDK to sleep
+uint32_t metricCommandLatencyUs = 0;  // last command-to-first-step latency
+uint32_t metricCommandLatencyMaxUs = 0;
+
+void metricsRecordCommandLatency(uint32_t latencyUs) {
+    metricCommandLatencyUs = latencyUs;
+    if (latencyUs > metricCommandLatencyMaxUs) metricCommandLatencyMaxUs = latencyUs;
+}
+
+// Share of uptime the CPU spent asleep, 0-100 (idle current proxy)
+uint8_t metricsSleepResidencyPct() {
+    uint32_t uptimeMs = millis();
+    if (uptimeMs == 0) return 0;
+    return (uint8_t)(metricCpuSleepUs / 10 / uptimeMs);
+}
+
+void metricsMarkWifiConnected(bool fastConnect) {
+    metricWifiFastConnect = fastConnect;
+    if (metricBootToWifiMs == 0) metricBootToWifiMs = millis();
+}
+
+void metricsMarkMqttConnected() {
+    if (metricBootToMqttMs != 0) return;
+    metricBootToMqttMs = millis();
+    LOG_I(LOG_SYS, "Boot to MQTT connected: %u ms (WiFi %u ms, %s)",
+          (unsigned)metricBootToMqttMs, (unsigned)metricBootToWifiMs,
+          metricWifiFastConnect ? "fast connect" : "full scan");
+}
+
+#endif // METRICS_UTILS_H
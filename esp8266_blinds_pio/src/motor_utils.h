@@ -0,0 +1,413 @@
+#ifndef MOTOR_UTILS_H
+#define MOTOR_UTILS_H
+
+#include <Arduino.h>
+
+#include "profile_utils.h"
+#include "metrics_utils.h"
+#include "event_utils.h"
+#include "led_utils.h"
+
+// Multi-Axis Configuration
+// One timer1 interrupt generates the steps of up to MOTOR_MAX_AXES blinds,
+// one A4988 each (select with build_flags, e.g. -DMOTOR_AXES=2). Axis 0 is
+// the original single blind and keeps its pins and MQTT topics.
+#ifndef MOTOR_AXES
+#define MOTOR_AXES 1
+#endif
+#define MOTOR_MAX_AXES 3
+
+static_assert(MOTOR_AXES >= 1 && MOTOR_AXES <= MOTOR_MAX_AXES, "MOTOR_AXES must be 1-3");
+
+// A4988 Stepper Driver Pins (see main3.cpp prototype)
+// DIR moved off GPIO14, which is used by the NeoPixel LED.
+#define STEPPER_STEP_PIN 12
+#define STEPPER_DIR_PIN 13
+#define STEPPER_ENABLE_PIN 5  // active low; high de-energizes the coils (shared by all drivers)
+
+// Second axis: GPIO15 must be low at boot (matches an idle STEP line) and
+// GPIO0 high (the DIR input does not pull it down)
+#ifndef STEPPER_STEP_PIN_2
+#define STEPPER_STEP_PIN_2 15
+#endif
+#ifndef STEPPER_DIR_PIN_2
+#define STEPPER_DIR_PIN_2 0
+#endif
+
+// The huzzah has no GPIO left for a third axis; free some and set them here.
+// GPIO16 cannot be used: it is not on the GPOS/GPOC registers.
+#if MOTOR_AXES > 2 && !(defined(STEPPER_STEP_PIN_3) && defined(STEPPER_DIR_PIN_3))
+#error "MOTOR_AXES 3 needs STEPPER_STEP_PIN_3 and STEPPER_DIR_PIN_3 in build_flags"
+#endif
+
+// Blind Travel: position 0 = closed, BLIND_TRAVEL_STEPS = fully open
+#define BLIND_TRAVEL_STEPS 20000
+
+// Step Generator Configuration
+// Timer1 runs at STEPPER_TIMER_HZ (0.2 us ticks) with a 23-bit reload.
+#define STEPPER_QUEUE_SIZE 256        // must stay 256: indices wrap as uint8_t
+#define STEPPER_REFILL_PER_CALL 16    // per axis; bounds the time one motor task call takes
+#define STEPPER_DIR_FLAG 0x80000000UL // queue entry bit: step in negative direction
+#define STEPPER_CYCLES_PER_TICK (F_CPU / STEPPER_TIMER_HZ)
+#define STEPPER_COALESCE_TICKS 10     // steps due within 2 us of each other share one interrupt
+#define STEPPER_MIN_LOAD_TICKS 10     // shortest re-arm: fires right after the critical section
+#define STEPPER_PULSE_US 2            // STEP high time (A4988 minimum: 1 us)
+#define STEPPER_PULSE_CYCLES (F_CPU / 1000000 * STEPPER_PULSE_US)
+
+struct StepperPins {
+    uint8_t step;
+    uint8_t dir;
+};
+
+const StepperPins stepperPins[MOTOR_AXES] = {
+    { STEPPER_STEP_PIN, STEPPER_DIR_PIN },
+#if MOTOR_AXES > 1
+    { STEPPER_STEP_PIN_2, STEPPER_DIR_PIN_2 },
+#endif
+#if MOTOR_AXES > 2
+    { STEPPER_STEP_PIN_3, STEPPER_DIR_PIN_3 },
+#endif
+};
+
+// Per-axis step generator state, shared between the motor task and the ISR.
+// The interval queue is single-producer (task writes head) / single-consumer
+// (ISR writes tail). Each entry is the wait in timer ticks before its step,
+// plus STEPPER_DIR_FLAG.
+struct StepperAxis {
+    volatile uint32_t queue[STEPPER_QUEUE_SIZE];
+    volatile uint8_t head;           // written by the motor task only
+    volatile uint8_t tail;           // written by the ISR only
+    volatile bool running;           // steps are being emitted
+    volatile long position;          // actual position in steps, updated by the ISR
+    volatile int8_t nextDirection;   // direction of the step the axis is waiting for
+    uint32_t due;                    // ticks from the last interrupt to this axis' next step
+    uint32_t stepMask;
+    uint32_t dirMask;
+};
+StepperAxis stepperAxes[MOTOR_AXES];
+
+// Shared timer state. Every running axis has its bit in stepperActiveAxes;
+// the ISR only visits those, so its cost is O(1) per moving blind.
+volatile uint8_t stepperActiveAxes = 0;
+volatile uint32_t stepperArmedTicks = 0;  // ticks between the last interrupt and the next
+volatile uint32_t stepperUnderruns = 0;   // a queue ran dry while a move was still planned
+
+// Step timing slip: how much later than planned each step ISR ran, in CPU
+// cycles. Includes a constant ISR entry cost, so compare against idle runs.
+volatile uint32_t stepperLastIsrCycles = 0;
+volatile uint32_t stepperExpectedCycles = 0;  // 0 = no step pending
+volatile uint32_t stepperMaxSlipCycles = 0;
+
+// Move planner state (motor task only). Steps through the precomputed ramp
+// table: level is how many ramp steps the motor is up, i.e. its speed.
+struct StepPlanner {
+    long position;     // position after the last queued step
+    long target;
+    uint32_t level;    // 0 = at rest, PROFILE_RAMP_STEPS = cruising at max speed
+    int8_t direction;  // +1 / -1
+};
+StepPlanner planners[MOTOR_AXES];
+
+// Driver power and command-to-motion latency
+bool motorDriverEnabled = false;
+bool motorLatencyPending[MOTOR_AXES];
+unsigned long motorCommandTimeUs[MOTOR_AXES];
+
+// Last state handed to the event ring (0xFF = nothing reported yet)
+uint8_t motorReportedPosition[MOTOR_AXES];
+uint8_t motorReportedMotion[MOTOR_AXES];
+
+inline void IRAM_ATTR stepperSetDirection(StepperAxis& axis, int8_t direction) {
+    if (direction > 0) GPOC = axis.dirMask;
+    else GPOS = axis.dirMask;
+}
+
+// Pop the next queued interval and add it to the axis deadline.
+// Returns false if the queue is empty.
+inline bool IRAM_ATTR stepperLoadNext(StepperAxis& axis) {
+    uint8_t tail = axis.tail;
+    if (tail == axis.head) return false;
+    uint32_t entry = axis.queue[tail];
+    axis.tail = (uint8_t)(tail + 1);
+
+    int8_t direction = (entry & STEPPER_DIR_FLAG) ? -1 : 1;
+    if (direction != axis.nextDirection) {
+        axis.nextDirection = direction;
+        stepperSetDirection(axis, direction);
+    }
+    axis.due += entry & ~STEPPER_DIR_FLAG;
+    return true;
+}
+
+inline void IRAM_ATTR stepperArm(uint32_t ticks) {
+    stepperArmedTicks = ticks;
+    stepperExpectedCycles = ticks * STEPPER_CYCLES_PER_TICK;
+    timer1_write(ticks);
+}
+
+// Timer1 ISR: emit the steps that are due on every axis, then arm the timer
+// for the earliest next one. Deadlines are kept relative to the last
+// interrupt and carry the coalescing error forward, so no axis drifts.
+// STEP stays high for the bookkeeping between the two GPIO writes, and at
+// least STEPPER_PULSE_US however fast that was.
+void IRAM_ATTR stepperISR() {
+    uint32_t elapsed = stepperArmedTicks;
+    uint8_t active = stepperActiveAxes;
+
+    uint32_t stepBits = 0;
+    uint8_t stepping = 0;
+    for (uint8_t pending = active; pending; pending &= pending - 1) {
+        uint8_t a = __builtin_ctz(pending);
+        StepperAxis& axis = stepperAxes[a];
+        axis.due = (axis.due > elapsed) ? axis.due - elapsed : 0;
+        if (axis.due <= STEPPER_COALESCE_TICKS) {
+            stepBits |= axis.stepMask;
+            stepping |= 1 << a;
+        }
+    }
+    GPOS = stepBits;
+
+    uint32_t now = ESP.getCycleCount();
+    int32_t slip = (int32_t)(now - stepperLastIsrCycles - stepperExpectedCycles);
+    if (slip > (int32_t)stepperMaxSlipCycles) stepperMaxSlipCycles = slip;
+    stepperLastIsrCycles = now;
+
+    uint32_t next = 0xFFFFFFFFUL;
+    for (uint8_t pending = active; pending; pending &= pending - 1) {
+        uint8_t a = __builtin_ctz(pending);
+        StepperAxis& axis = stepperAxes[a];
+        if (stepping & (1 << a)) {
+            axis.position += axis.nextDirection;
+            if (!stepperLoadNext(axis)) {
+                axis.running = false;
+                active &= ~(1 << a);
+                const StepPlanner& planner = planners[a];
+                if (planner.position != planner.target || planner.level != 0) {
+                    stepperUnderruns++;
+                    eventPush(stepperIsrEvents, EVENT_ERROR, eventAxisValue(a, MOTOR_ERROR_STEP_UNDERRUN));
+                }
+                continue;
+            }
+        }
+        if (axis.due < next) next = axis.due;
+    }
+    while (stepBits && ESP.getCycleCount() - now < STEPPER_PULSE_CYCLES) {}
+    GPOC = stepBits;
+
+    stepperActiveAxes = active;
+    if (active) {
+        stepperArm(next);
+    }
+    else {
+        stepperExpectedCycles = 0;
+        timer1_disable();
+    }
+}
+
+// Ticks since the last interrupt. Once the armed interval has run out the
+// counter reads 0 or has wrapped past it; the interrupt is then pending, so
+// the whole interval counts as elapsed.
+inline uint32_t stepperTimerElapsed() {
+    uint32_t remaining = timer1_read();
+    if (remaining > stepperArmedTicks) remaining = 0;
+    return stepperArmedTicks - remaining;
+}
+
+// Hand an axis with a filled queue to the ISR. If the timer is already
+// running for another axis, the new deadline is expressed relative to the
+// last interrupt like the others, and the timer re-armed if it comes first.
+// The re-arm measures the timer again just before writing it: if the armed
+// deadline passed meanwhile, the load is the minimum so that the edge that
+// was due goes out at once instead of being pushed back.
+void stepperStartAxis(uint8_t a) {
+    StepperAxis& axis = stepperAxes[a];
+    noInterrupts();
+    axis.running = true;
+    if (!stepperActiveAxes) {
+        axis.due = 0;
+        stepperLoadNext(axis);
+        stepperLastIsrCycles = ESP.getCycleCount();
+        timer1_enable(TIM_DIV16, TIM_EDGE, TIM_SINGLE);
+        stepperArm(axis.due);
+    }
+    else {
+        axis.due = stepperTimerElapsed();
+        stepperLoadNext(axis);
+        if (axis.due < stepperArmedTicks) {
+            uint32_t elapsed = stepperTimerElapsed();
+            uint32_t load = (axis.due > elapsed + STEPPER_MIN_LOAD_TICKS) ? axis.due - elapsed : STEPPER_MIN_LOAD_TICKS;
+            stepperArmedTicks = elapsed + load;
+            stepperExpectedCycles = stepperArmedTicks * STEPPER_CYCLES_PER_TICK;
+            timer1_write(load);
+        }
+    }
+    stepperActiveAxes |= 1 << a;
+    interrupts();
+}
+
+// Compute the interval of the next step of the current move.
+// Returns false when the target has been reached and the motor is at rest.
+bool planNextStep(StepPlanner& planner, uint32_t* ticks) {
+    long remaining = planner.target - planner.position;
+
+    if (planner.level == 0) {
+        if (remaining == 0) return false;
+        // Direction can only change at rest
+        planner.direction = (remaining > 0) ? 1 : -1;
+    }
+
+    // Distance left in the direction of travel (negative when heading away)
+    long distance = remaining * planner.direction;
+    long level = (long)planner.level;
+
+    if (distance <= level) {
+        // Decelerating from level r takes exactly r steps
+        planner.level--;
+        *ticks = rampInterval(planner.level);
+    }
+    else if (planner.level < PROFILE_RAMP_STEPS && distance >= level + 2) {
+        // Still room to stop after one more acceleration step
+        *ticks = rampInterval(planner.level);
+        planner.level++;
+    }
+    else if (planner.level > 0) {
+        // Cruise at the current speed
+        *ticks = rampInterval(planner.level - 1);
+    }
+    else {
+        // A single step from rest: no room to speed up and nothing to slow
+        // down from, so it is taken at the first ramp interval
+        *ticks = rampInterval(0);
+    }
+
+    planner.position += planner.direction;
+    return true;
+}
+
+// The coils are energized only while a blind moves: refillStepperAxis()
+// enables the driver for a move and handlePower() releases it once the
+// motor has settled, whatever the power mode
+void motorSetDriverEnabled(bool enabled) {
+    digitalWrite(STEPPER_ENABLE_PIN, enabled ? LOW : HIGH);
+    motorDriverEnabled = enabled;
+}
+
+void initMotor() {
+    pinMode(STEPPER_ENABLE_PIN, OUTPUT);
+    motorSetDriverEnabled(false);
+
+    for (uint8_t a = 0; a < MOTOR_AXES; a++) {
+        StepperAxis& axis = stepperAxes[a];
+        axis.stepMask = 1UL << stepperPins[a].step;
+        axis.dirMask = 1UL << stepperPins[a].dir;
+        axis.nextDirection = 1;
+        pinMode(stepperPins[a].step, OUTPUT);
+        pinMode(stepperPins[a].dir, OUTPUT);
+        digitalWrite(stepperPins[a].step, LOW);
+        stepperSetDirection(axis, axis.nextDirection);
+
+        planners[a] = {0, 0, 0, 1};
+        motorReportedPosition[a] = 0xFF;
+        motorReportedMotion[a] = 0xFF;
+    }
+
+    timer1_isr_init();
+    timer1_attachInterrupt(stepperISR);
+}
+
+bool motorAxisMoving(uint8_t axis) {
+    const StepPlanner& planner = planners[axis];
+    return stepperAxes[axis].running || planner.position != planner.target || planner.level != 0;
+}
+
+// True while any blind is moving
+bool motorIsMoving() {
+    for (uint8_t a = 0; a < MOTOR_AXES; a++) {
+        if (motorAxisMoving(a)) return true;
+    }
+    return false;
+}
+
+// Set a new absolute target; the planner turns around smoothly if needed
+void motorMoveTo(uint8_t axis, long target) {
+    if (!motorAxisMoving(axis) && target != planners[axis].position) {
+        motorCommandTimeUs[axis] = micros();
+        motorLatencyPending[axis] = true;
+    }
+    planners[axis].target = target;
+}
+
+// Decelerate to a stop as quickly as the acceleration allows
+void motorStop(uint8_t axis) {
+    StepPlanner& planner = planners[axis];
+    planner.target = planner.position + planner.direction * (long)planner.level;
+}
+
+// Move a blind to a 0-100 position (100 = open)
+void blindMoveToPercent(uint8_t axis, uint8_t percent) {
+    if (percent > 100) percent = 100;
+    motorMoveTo(axis, (long)percent * BLIND_TRAVEL_STEPS / 100);
+}
+
+// Current blind position as 0-100, rounded to the nearest percent
+uint8_t blindPositionPercent(uint8_t axis = 0) {
+    long position = stepperAxes[axis].position;
+    if (position <= 0) return 0;
+    if (position >= BLIND_TRAVEL_STEPS) return 100;
+    return (uint8_t)((position * 100 + BLIND_TRAVEL_STEPS / 2) / BLIND_TRAVEL_STEPS);
+}
+
+// Push position and motion changes to the event ring. A full ring is not
+// an error: the change is simply reported on a later pass.
+void reportMotorState(uint8_t axis) {
+    uint8_t position = blindPositionPercent(axis);
+    if (position != motorReportedPosition[axis] &&
+        eventPush(motionEvents, EVENT_POSITION, eventAxisValue(axis, position)))
+        motorReportedPosition[axis] = position;
+
+    uint8_t motion = !motorAxisMoving(axis) ? MOTION_STOPPED
+                   : (planners[axis].direction > 0 ? MOTION_OPENING : MOTION_CLOSING);
+    if (motion != motorReportedMotion[axis] &&
+        eventPush(motionEvents, EVENT_MOTION, eventAxisValue(axis, motion)))
+        motorReportedMotion[axis] = motion;
+}
+
+// Keep one axis' interval queue topped up and start it if idle
+void refillStepperAxis(uint8_t a) {
+    StepperAxis& axis = stepperAxes[a];
+    StepPlanner& planner = planners[a];
+
+    // The queue ran dry mid-move: the motor has physically stopped, so restart
+    // the ramp from standstill instead of resuming at speed
+    if (!axis.running && axis.tail == axis.head && planner.level != 0) planner.level = 0;
+
+    for (uint8_t i = 0; i < STEPPER_REFILL_PER_CALL; i++) {
+        uint8_t head = axis.head;
+        if ((uint8_t)(head + 1) == axis.tail) break;  // queue full
+
+        uint32_t ticks;
+        if (!planNextStep(planner, &ticks)) break;
+        axis.queue[head] = ticks | (planner.direction < 0 ? STEPPER_DIR_FLAG : 0);
+        axis.head = (uint8_t)(head + 1);
+    }
+
+    if (!axis.running && axis.tail != axis.head) {
+        if (!motorDriverEnabled) motorSetDriverEnabled(true);
+        if (motorLatencyPending[a]) {
+            metricsRecordCommandLatency(micros() - motorCommandTimeUs[a]);
+            motorLatencyPending[a] = false;
+        }
+        stepperStartAxis(a);
+    }
+}
+
+// Motor task: feed every axis, then report state changes
+void handleMotor() {
+    for (uint8_t a = 0; a < MOTOR_AXES; a++) {
+        refillStepperAxis(a);
+        reportMotorState(a);
+    }
+    ledSetMoving(motorIsMoving());
+}
+
+#endif // MOTOR_UTILS_H
@@ -1,191 +1,624 @@
 #ifndef MQTT_UTILS_H
 #define MQTT_UTILS_H
 
-#include <ArduinoJson.h>
 #include <ESP8266WiFi.h>
 #include <PubSubClient.h>
 
+#include "config_utils.h"
+#include "motor_utils.h"
+#include "metrics_utils.h"
+#include "resolver_utils.h"
+#include "string_utils.h"
+#include "log_utils.h"
+
 #define BLIND_NO 1
 #define BLIND_NAME "Family Room Blinds"
 
+// Names of the blinds when one controller drives several (MOTOR_AXES > 1)
+#ifndef BLIND_AXIS_NAMES
+#define BLIND_AXIS_NAMES { BLIND_NAME, BLIND_NAME " 2", BLIND_NAME " 3" }
+#endif
+
+// Constants
+#define MQTT_CONNECTION_ATTEMPTS 10       // failures before the LED turns red
+#define MQTT_BACKOFF_MIN_MS 1000          // first retry delay, doubled per failure
+#define MQTT_BACKOFF_MAX_MS 60000
+#define MQTT_KEEPALIVE_S 15               // broker declares us gone after 1.5x this
+#define MQTT_SOCKET_TIMEOUT_S 2           // bounds the wait for CONNACK
+#define MQTT_TCP_CONNECT_TIMEOUT_MS 2000  // bounds the TCP handshake
+#define MQTT_SUBSCRIBE_QOS 1              // commands are queued by the broker while offline
+#define POSITION_PUBLISH_INTERVAL_MS 250  // max 4 position updates/s while moving
+#define STATE_EVENTS_PER_CALL 32          // bounds one drain of the event rings
+#define MQTT_TOPIC_MAX_LEN 80
+#define MQTT_OBJECT_ID_MAX_LEN 40
+
+// 1 = also send forwarded log lines (LOG_REMOTE_LEVEL) to <client id>/log
+#ifndef LOG_MQTT_SINK
+#define LOG_MQTT_SINK 0
+#endif
+
+#define STRINGIFY_(x) #x
+#define STRINGIFY(x) STRINGIFY_(x)
+#define MQTT_CLIENT_ID "mintek_blinds_" STRINGIFY(BLIND_NO)
+
 // MQTT Configuration
-String mqttServer = "homeassistant.local";
+// Broker and credentials are fixed strings so they can be overridden at
+// runtime (see setMQTTBroker) without touching the heap.
+#define MQTT_SERVER_MAX_LEN 64
+#define MQTT_CREDENTIAL_MAX_LEN 32
+FixedString<MQTT_SERVER_MAX_LEN> mqttServer("homeassistant.local");
 const int mqttPort = 1883;
-String mqttUsername = "mintek_blinds";
-String mqttPassword = "123";
-String mqttClientId = "mintek_blinds_" + String(BLIND_NO);
-
-// Home Assistant MQTT Configuration
-String discoveryTopic = "homeassistant/cover/" + mqttClientId + "/config";
-String commandTopic = mqttClientId + "/set";
-String positionTopic = mqttClientId + "/position"; // Used for reporting current state (0-100)
-String setPositionTopic = mqttClientId + "/set_position"; // Used for setting the position (0-100)
-String availabilityTopic = mqttClientId + "/availability";
-
-// MQTT Payloads
-const char* payloadAvailable = "online";
-const char* payloadNotAvailable = "offline";
-const char* payloadOpen = "OPEN";
-const char* payloadClose = "CLOSE";
-const char* payloadStop = "STOP";
+FixedString<MQTT_CREDENTIAL_MAX_LEN> mqttUsername("mintek_blinds");
+FixedString<MQTT_CREDENTIAL_MAX_LEN> mqttPassword("123");
+
+typedef FixedString<MQTT_TOPIC_MAX_LEN> MqttTopic;
+typedef FixedString<MQTT_OBJECT_ID_MAX_LEN> MqttObjectId;
+
+// Identity and Home Assistant topic table, built at compile time.
+// These stay in .rodata rather than PROGMEM: PubSubClient reads topic strings
+// byte by byte, which flash does not allow on the ESP8266.
+constexpr char mqttClientId[] = MQTT_CLIENT_ID;
+constexpr char deviceDiscoveryTopic[] = "homeassistant/device/" MQTT_CLIENT_ID "/config";
+constexpr char haStatusTopic[] = "homeassistant/status";  // Home Assistant birth/will messages
+constexpr char commandTopic[] = MQTT_CLIENT_ID "/set";
+constexpr char positionTopic[] = MQTT_CLIENT_ID "/position"; // Used for reporting current state (0-100)
+constexpr char setPositionTopic[] = MQTT_CLIENT_ID "/set_position"; // Used for setting the position (0-100)
+constexpr char availabilityTopic[] = MQTT_CLIENT_ID "/availability";
+constexpr char stateTopic[] = MQTT_CLIENT_ID "/state"; // opening/closing/stopped/open/closed
+constexpr char errorTopic[] = MQTT_CLIENT_ID "/error";
+constexpr char diagnosticsTopic[] = MQTT_CLIENT_ID "/diagnostics";
+constexpr char logTopic[] = MQTT_CLIENT_ID "/log";
+
+// Every blind axis has its own object id and topics: axis 0 uses
+// mqttClientId as before, axis n uses "<mqttClientId>_<n+1>", e.g.
+// mintek_blinds_1_2/set_position. Availability stays per controller.
+const char* const blindAxisNames[MOTOR_MAX_AXES] = BLIND_AXIS_NAMES;
+
+MqttObjectId axisObjectId(uint8_t axis) {
+    MqttObjectId id(mqttClientId);
+    if (axis > 0) id.appendf("_%u", (unsigned)axis + 1);
+    return id;
+}
+
+MqttTopic axisTopic(uint8_t axis, StringView suffix) {
+    MqttTopic topic(axisObjectId(axis));
+    topic += suffix;
+    return topic;
+}
+
+// Diagnostic sensors (METRICS_HA_SENSORS), announced with the device and
+// published by the diagnostics task in telemetry_utils.h
+#ifndef METRICS_HA_SENSORS
+#define METRICS_HA_SENSORS 0  // 1 = also publish Home Assistant diagnostic sensors
+#endif
+
+struct DiagnosticSensor {
+    const char* key;   // JSON field in the diagnostics payload
+    const char* name;
+    const char* unit;  // "" = unitless
+};
+
+const DiagnosticSensor diagnosticSensors[] = {
+    { "heap", "Free heap", "B" },
+    { "max_block", "Largest free block", "B" },
+    { "heap_frag", "Heap fragmentation", "%" },
+    { "loop_max_us", "Max loop time", "us" },
+    { "reconnects", "Reconnects", "" },
+    { "step_slip_us", "Step slip", "us" },
+};
+
+// MQTT Payloads (macros so they can be baked into the discovery template)
+#define PAYLOAD_AVAILABLE "online"
+#define PAYLOAD_NOT_AVAILABLE "offline"
+#define PAYLOAD_OPEN "OPEN"
+#define PAYLOAD_CLOSE "CLOSE"
+#define PAYLOAD_STOP "STOP"
+const char* payloadAvailable = PAYLOAD_AVAILABLE;
+const char* payloadNotAvailable = PAYLOAD_NOT_AVAILABLE;
+const char* payloadOpen = PAYLOAD_OPEN;
+const char* payloadClose = PAYLOAD_CLOSE;
+const char* payloadStop = PAYLOAD_STOP;
 
 // MQTT State Variables
 bool mqttSetupActive = false;
 bool mqttAvailableMsgSent = false;
 bool mqttDiscoveryMsgSent = false;
+bool discoveryRepublishRequested = false;  // Home Assistant came back online
+int mqttConnectAttempt = 0;
+unsigned long mqttLastAttemptTime = 0;
+unsigned long mqttBackoffMs = MQTT_BACKOFF_MIN_MS;
+unsigned long mqttRetryDelayMs = 0;
 
 WiFiClient espClient;
 PubSubClient mqttClient(espClient);
 
-void checkMQTTCallBack(char* topic, byte* payload, unsigned int length) {
-    printSeparator(1);
-    Serial.println("MQTT Message received");
-    Serial.println("Topic: " + String(topic));
-    // Properly create string from payload using the length parameter
-    String payloadStr;
-    payloadStr.reserve(length);
+// Typed command handlers
+void handleOpenCommand(uint8_t axis) {
+    blindMoveToPercent(axis, 100);
+}
+
+void handleCloseCommand(uint8_t axis) {
+    blindMoveToPercent(axis, 0);
+}
+
+void handleStopCommand(uint8_t axis) {
+    motorStop(axis);
+}
+
+void handleSetPositionCommand(uint8_t axis, uint8_t percent) {
+    blindMoveToPercent(axis, percent);
+}
+
+// Compare a raw (not NUL-terminated) payload against a constant
+bool payloadEquals(const byte* payload, unsigned int length, StringView value) {
+    return StringView((const char*)payload, length) == value;
+}
+
+// Parse a 0-100 decimal position in place. Returns -1 if invalid.
+int parsePositionPayload(const byte* payload, unsigned int length) {
+    if (length == 0 || length > 3) return -1;
+    int value = 0;
     for (unsigned int i = 0; i < length; i++) {
-        payloadStr += (char)payload[i];
+        if (payload[i] < '0' || payload[i] > '9') return -1;
+        value = value * 10 + (payload[i] - '0');
     }
-    Serial.println("Payload: " + payloadStr);
-    Serial.println("Length: " + String(length));
-    printSeparator(3);
+    return (value <= 100) ? value : -1;
+}
+
+void dispatchCommandPayload(uint8_t axis, const byte* payload, unsigned int length) {
+    if (payloadEquals(payload, length, payloadOpen)) handleOpenCommand(axis);
+    else if (payloadEquals(payload, length, payloadClose)) handleCloseCommand(axis);
+    else if (payloadEquals(payload, length, payloadStop)) handleStopCommand(axis);
+    else LOG_W(LOG_MQTT, "unknown command");
+}
+
+void dispatchSetPositionPayload(uint8_t axis, const byte* payload, unsigned int length) {
+    int percent = parsePositionPayload(payload, length);
+    if (percent < 0) LOG_W(LOG_MQTT, "position out of range");
+    else handleSetPositionCommand(axis, (uint8_t)percent);
+}
+
+// FNV-1a, usable at compile time to build the routing table
+constexpr uint32_t topicHash(StringView s) {
+    uint32_t hash = 2166136261UL;
+    for (size_t i = 0; i < s.len; i++) hash = (hash ^ (uint8_t)s[i]) * 16777619UL;
+    return hash;
+}
+
+// Routes are keyed by the topic suffix after "<mqttClientId>[_<axis>]"
+typedef void (*PayloadHandler)(uint8_t axis, const byte* payload, unsigned int length);
+struct TopicRoute {
+    uint32_t hash;
+    const char* suffix;
+    PayloadHandler handler;
+};
+
+const TopicRoute topicRoutes[] = {
+    { topicHash("/set"), "/set", dispatchCommandPayload },
+    { topicHash("/set_position"), "/set_position", dispatchSetPositionPayload },
+};
+static_assert(topicHash("/set") != topicHash("/set_position"), "MQTT route hash collision");
+
+// Override the broker and credentials (e.g. from stored configuration).
+// Values longer than the buffers are truncated.
+void setMQTTBroker(StringView server, StringView username, StringView password) {
+    if (mqttServer != server) resolverReset();
+    mqttServer = server;
+    mqttUsername = username;
+    mqttPassword = password;
+    if (mqttServer.truncated() || mqttUsername.truncated() || mqttPassword.truncated())
+        LOG_W(LOG_MQTT, "broker setting too long, truncated");
+
+    // Reconnect with the new settings
+    mqttClient.disconnect();
+    mqttSetupActive = false;
+}
+
+// MQTT callback: routes the message without touching the heap
+void checkMQTTCallBack(char* topic, byte* payload, unsigned int length) {
+#ifdef MQTT_DISPATCH_HEAP_CHECK
+    uint32_t freeHeapBefore = ESP.getFreeHeap();
+#endif
+    LOG_D(LOG_MQTT, "received %s = %.*s", topic, (int)length, (const char*)payload);
+
+    // Home Assistant restarted: it may have lost the retained discovery
+    StringView topicView(topic);
+    if (topicView == haStatusTopic) {
+        if (payloadEquals(payload, length, payloadAvailable)) discoveryRepublishRequested = true;
+        return;
+    }
+
+    StringView clientId(mqttClientId, sizeof(mqttClientId) - 1);
+    if (!topicView.startsWith(clientId)) return;
+
+    StringView suffix = topicView.substring(clientId.len);
+    uint8_t axis = 0;
+    if (suffix.len >= 2 && suffix[0] == '_' && suffix[1] >= '2' && suffix[1] < '1' + MOTOR_AXES) {
+        axis = suffix[1] - '1';
+        suffix = suffix.substring(2);
+    }
+    uint32_t hash = topicHash(suffix);
+    for (const TopicRoute& route : topicRoutes) {
+        if (route.hash == hash && suffix == route.suffix) {
+            route.handler(axis, payload, length);
+            break;
+        }
+    }
+
+#ifdef MQTT_DISPATCH_HEAP_CHECK
+    uint32_t freeHeapAfter = ESP.getFreeHeap();
+    if (freeHeapAfter != freeHeapBefore) {
+        LOG_E(LOG_MQTT, "dispatch heap delta %d bytes", (int)(freeHeapBefore - freeHeapAfter));
+    }
+#endif
+}
+
+// Latest value per topic and axis still waiting to be published. Draining
+// the event rings overwrites these (latest value wins); a failed publish
+// leaves the slot pending so it is retried on the next call.
+struct PendingState {
+    bool pending;
+    uint32_t value;
+};
+PendingState pendingPosition[MOTOR_AXES];
+PendingState pendingMotion[MOTOR_AXES];
+PendingState pendingError[MOTOR_AXES];
+unsigned long lastPositionPublishTime[MOTOR_AXES];
+
+void drainEventRing(EventRing& ring) {
+    uint8_t type;
+    uint32_t value;
+    for (uint8_t i = 0; i < STATE_EVENTS_PER_CALL && eventPop(ring, &type, &value); i++) {
+        uint8_t axis = eventAxis(value);
+        if (axis >= MOTOR_AXES) continue;
+        PendingState* slot = (type == EVENT_POSITION) ? &pendingPosition[axis]
+                           : (type == EVENT_MOTION) ? &pendingMotion[axis]
+                           : (type == EVENT_ERROR) ? &pendingError[axis] : NULL;
+        if (!slot) continue;
+        slot->value = value & 0xFFFF;
+        slot->pending = true;
+    }
+}
+
+const char* motionStatePayload(uint8_t motion, uint8_t position) {
+    if (motion == MOTION_OPENING) return "opening";
+    if (motion == MOTION_CLOSING) return "closing";
+    if (position >= 100) return "open";
+    if (position == 0) return "closed";
+    return "stopped";
 }
 
+// Publish pending state of one axis. Position is coalesced to one update
+// per POSITION_PUBLISH_INTERVAL_MS while moving plus the final value at rest.
+void publishAxisState(uint8_t axis) {
+    char payload[12];
+    PendingState& position = pendingPosition[axis];
+    PendingState& motion = pendingMotion[axis];
+    PendingState& error = pendingError[axis];
+
+    bool moving = motion.value != MOTION_STOPPED;
+    if (position.pending && (!moving || millis() - lastPositionPublishTime[axis] >= POSITION_PUBLISH_INTERVAL_MS)) {
+        snprintf(payload, sizeof(payload), "%u", (unsigned)position.value);
+        if (mqttClient.publish(axisTopic(axis, "/position").c_str(), payload, true)) {
+            position.pending = false;
+            lastPositionPublishTime[axis] = millis();
+        }
+    }
+    if (motion.pending) {
+        if (mqttClient.publish(axisTopic(axis, "/state").c_str(), motionStatePayload(motion.value, position.value), true)) motion.pending = false;
+    }
+    if (error.pending) {
+        snprintf(payload, sizeof(payload), "%u", (unsigned)error.value);
+        if (mqttClient.publish(axisTopic(axis, "/error").c_str(), payload)) error.pending = false;
+    }
+}
+
+void publishStateEvents() {
+    drainEventRing(motionEvents);
+    drainEventRing(stepperIsrEvents);
+    for (uint8_t axis = 0; axis < MOTOR_AXES; axis++) publishAxisState(axis);
+}
+
+// Jittered exponential backoff: a random delay in [backoff/2, backoff], so a
+// fleet that lost the broker together does not reconnect in lockstep
+unsigned long mqttNextRetryDelay() {
+    unsigned long delayMs = mqttBackoffMs / 2 + random(mqttBackoffMs / 2 + 1);
+    mqttBackoffMs = (mqttBackoffMs * 2 > MQTT_BACKOFF_MAX_MS) ? MQTT_BACKOFF_MAX_MS : mqttBackoffMs * 2;
+    return delayMs;
+}
+
+// Log sink: lines logged while the session is down are not queued
+void mqttLogSink(uint8_t level, const char* line, size_t len) {
+    (void)level;
+    if (mqttSetupActive) mqttClient.publish(logTopic, (const uint8_t*)line, len);
+}
+
+// Connection manager: at most one bounded connect attempt per call, spaced
+// by the backoff. PubSubClient's connect() is synchronous, so the TCP and
+// CONNACK timeouts cap how long a single attempt can hold up the other tasks.
+// The broker is connected by address (resolver_utils.h), so an attempt
+// never includes a name lookup.
 void setupMQTT() {
     if (mqttSetupActive) return;
-    setLedColor(128, 0, 128); // purple
-    printSeparator(1);
-    Serial.println("Connecting to MQTT...");
-
-    // Increase buffer size to handle larger messages
-    mqttClient.setBufferSize(512);
-
-    int attempt = 0;
-    mqttClient.setServer(mqttServer.c_str(), mqttPort);
-    while (!mqttClient.connect(mqttClientId.c_str(), mqttUsername.c_str(), mqttPassword.c_str()) && attempt < 10) {
-        Serial.print(".");
-        delay(5000);
-        attempt++;
-    }
-    if (mqttClient.connect(mqttClientId.c_str(), mqttUsername.c_str(), mqttPassword.c_str())) {
-        Serial.println("Connected");
+    if (mqttConnectAttempt > 0 && millis() - mqttLastAttemptTime < mqttRetryDelayMs) return;
+
+    // Nothing cached yet: wait for the first lookup instead of failing
+    IPAddress brokerIp;
+    bool haveAddress = resolverAddress(mqttServer.c_str(), brokerIp);
+    if (!haveAddress && resolverPending()) return;
+    mqttLastAttemptTime = millis();
+
+    if (mqttConnectAttempt == 0) {
+        ledSetStatus(LED_STATUS_MQTT_CONNECTING);
+        LOG_I(LOG_MQTT, "Connecting to MQTT...");
+        espClient.setTimeout(MQTT_TCP_CONNECT_TIMEOUT_MS);
+        mqttClient.setKeepAlive(MQTT_KEEPALIVE_S);
+        mqttClient.setSocketTimeout(MQTT_SOCKET_TIMEOUT_S);
         mqttClient.setCallback(checkMQTTCallBack);
-        mqttSetupActive = true;
+        if (LOG_MQTT_SINK) logMqttSink = mqttLogSink;
     }
-    else{
-        Serial.println("Failed to connect to MQTT after " + String(attempt) + " attempts");
-        setLedColor(0, 255, 0); // red
+    mqttConnectAttempt++;
+
+    // Persistent session (cleanSession = false): the broker keeps our QoS 1
+    // subscriptions and queues commands sent while we are away. The retained
+    // will marks the blind unavailable if the connection dies.
+    if (!haveAddress) {
+        mqttRetryDelayMs = mqttNextRetryDelay();
+        LOG_W(LOG_MQTT, "MQTT connect failed (%s not resolved), retrying in %lu ms", mqttServer.c_str(), mqttRetryDelayMs);
+        if (mqttConnectAttempt == MQTT_CONNECTION_ATTEMPTS) ledSetStatus(LED_STATUS_ERROR);
+        return;
+    }
+    mqttClient.setServer(brokerIp, mqttPort);
+    if (!mqttClient.connect(mqttClientId, mqttUsername.c_str(), mqttPassword.c_str(),
+                            availabilityTopic, 1, true, payloadNotAvailable, false)) {
+        resolverConnectFailed();
+        mqttRetryDelayMs = mqttNextRetryDelay();
+        LOG_W(LOG_MQTT, "MQTT connect failed (state %d), retrying in %lu ms", mqttClient.state(), mqttRetryDelayMs);
+        if (mqttConnectAttempt == MQTT_CONNECTION_ATTEMPTS) ledSetStatus(LED_STATUS_ERROR);
+        return;
     }
 
-    mqttClient.subscribe(discoveryTopic.c_str());
-    mqttClient.subscribe(commandTopic.c_str());
-    mqttClient.subscribe(setPositionTopic.c_str());
-    mqttClient.subscribe(availabilityTopic.c_str());
-    mqttClient.subscribe(positionTopic.c_str());
+    LOG_I(LOG_MQTT, "Connected");
+    metricsMarkMqttConnected();
+    metricMqttConnects++;
+    mqttSetupActive = true;
+    mqttConnectAttempt = 0;
+    mqttBackoffMs = MQTT_BACKOFF_MIN_MS;
+    mqttAvailableMsgSent = false;  // the will may have replaced it
+
+    // Re-subscribing is harmless if the broker still has the session
+    for (uint8_t axis = 0; axis < MOTOR_AXES; axis++) {
+        mqttClient.subscribe(axisTopic(axis, "/set").c_str(), MQTT_SUBSCRIBE_QOS);
+        mqttClient.subscribe(axisTopic(axis, "/set_position").c_str(), MQTT_SUBSCRIBE_QOS);
+    }
+    mqttClient.subscribe(haStatusTopic, MQTT_SUBSCRIBE_QOS);
+
+    ledSetStatus(LED_STATUS_IDLE);
+}
+
+// Notice a dead session, either from PubSubClient (socket closed or keepalive
+// timed out) or because WiFi itself is gone, and start reconnecting
+void checkMQTTConnection() {
+    if (!mqttSetupActive) return;
+    if (WiFi.status() == WL_CONNECTED && mqttClient.connected()) return;
 
-    delay(1000);
-    setLedOff();
-    printSeparator(3);
+    LOG_W(LOG_MQTT, "connection lost (state %d)", mqttClient.state());
+    mqttClient.disconnect();
+    mqttSetupActive = false;
+    mqttConnectAttempt = 0;  // first retry is immediate, then back off
+    metricMqttDrops++;
 }
 
-// source: https://www.home-assistant.io/integrations/mqtt/#mqtt-discovery
+// Home Assistant device-based discovery: one retained message per controller
+// that carries every entity (a cover per axis, plus the diagnostic sensors).
+// source: https://www.home-assistant.io/integrations/mqtt/#device-discovery-payload
 // source: https://www.home-assistant.io/integrations/cover.mqtt/
+// Uses abbreviated keys to save bytes (cmd_t = command_topic, etc.).
+// Options shared by all entities (availability, QoS) sit at device level.
+static constexpr char discoveryDeviceHeader[] PROGMEM =
+    "{"
+    "\"dev\":{"
+        "\"ids\":\"" MQTT_CLIENT_ID "\","
+        "\"name\":\"" BLIND_NAME "\","
+        "\"mf\":\"Mintek\","
+        "\"mdl\":\"\","
+        "\"sw\":\"\""
+    "},"
+    "\"o\":{"
+        "\"name\":\"" BLIND_NAME "\","
+        "\"sw\":\"\""
+    "},"
+    "\"avty_t\":\"" MQTT_CLIENT_ID "/availability\","
+    "\"pl_avail\":\"" PAYLOAD_AVAILABLE "\","
+    "\"pl_not_avail\":\"" PAYLOAD_NOT_AVAILABLE "\","
+    "\"qos\":1,"  // HA publishes commands at QoS 1, so the broker queues them while we are offline
+    "\"cmps\":{";
+
+// One cover component. Every DISCOVERY_ID_MARKER is replaced by the axis
+// object id and every DISCOVERY_NAME_MARKER by its JSON name while streaming.
+#define DISCOVERY_ID_MARKER '\x01'
+#define DISCOVERY_ID "\x01"
+#define DISCOVERY_NAME_MARKER '\x02'
+#define DISCOVERY_NAME "\x02"
+static constexpr char discoveryCoverTemplate[] PROGMEM =
+    "\"" DISCOVERY_ID "\":{"
+    "\"p\":\"cover\","
+    "\"name\":" DISCOVERY_NAME ","
+    "\"uniq_id\":\"" DISCOVERY_ID "\","
+    "\"retain\":true,"
+    "\"optimistic\":false,"
+    "\"cmd_t\":\"" DISCOVERY_ID "/set\","
+    "\"pos_t\":\"" DISCOVERY_ID "/position\","
+    "\"stat_t\":\"" DISCOVERY_ID "/state\","
+    "\"set_pos_t\":\"" DISCOVERY_ID "/set_position\","
+    "\"pl_open\":\"" PAYLOAD_OPEN "\","
+    "\"pl_cls\":\"" PAYLOAD_CLOSE "\","
+    "\"pl_stop\":\"" PAYLOAD_STOP "\","
+    "\"pos_open\":100,"
+    "\"pos_closed\":0"
+    "}";
+
+// Discovery output. The payload is generated twice: once to measure and
+// hash it, then streamed to the broker if the hash changed. No JSON
+// document and no payload-sized buffer: PubSubClient only needs room for
+// the header, so the default buffer size is enough.
+struct DiscoveryWriter {
+    bool publish;   // false = only measure and hash
+    size_t length;
+    uint32_t hash;  // FNV-1a of everything written
+};
+
+void discoveryWrite(DiscoveryWriter& w, const char* data, size_t len) {
+    for (size_t i = 0; i < len; i++) w.hash = (w.hash ^ (uint8_t)data[i]) * 16777619UL;
+    w.length += len;
+    if (w.publish) mqttClient.write((const uint8_t*)data, len);
+}
+
+// Copy a template from flash with the object id and name spliced in
+void writeDiscoveryTemplate(DiscoveryWriter& w, const char* tmpl, StringView objectId, StringView name) {
+    char chunk[64];
+    size_t chunkLen = 0;
+    for (size_t i = 0;; i++) {
+        char c = pgm_read_byte(&tmpl[i]);
+        bool marker = (c == DISCOVERY_ID_MARKER || c == DISCOVERY_NAME_MARKER);
+        if (c == '\0' || marker || chunkLen == sizeof(chunk)) {
+            discoveryWrite(w, chunk, chunkLen);
+            chunkLen = 0;
+        }
+        if (c == '\0') break;
+        if (c == DISCOVERY_ID_MARKER) discoveryWrite(w, objectId.data, objectId.len);
+        else if (c == DISCOVERY_NAME_MARKER) discoveryWrite(w, name.data, name.len);
+        else chunk[chunkLen++] = c;
+    }
+}
+
+void writeDiagnosticComponent(DiscoveryWriter& w, const DiagnosticSensor& sensor) {
+    char component[256];
+    int n = snprintf(component, sizeof(component),
+        ",\"%s_%s\":{\"p\":\"sensor\",\"name\":\"%s\",\"uniq_id\":\"%s_%s\",\"stat_t\":\"%s\","
+        "\"val_tpl\":\"{{value_json.%s}}\",\"ent_cat\":\"diagnostic\"%s%s%s}",
+        mqttClientId, sensor.key, sensor.name, mqttClientId, sensor.key, diagnosticsTopic, sensor.key,
+        sensor.unit[0] ? ",\"unit_of_meas\":\"" : "", sensor.unit, sensor.unit[0] ? "\"" : "");
+    if (n > 0 && (size_t)n < sizeof(component)) discoveryWrite(w, component, n);
+}
+
+void writeDeviceDiscovery(DiscoveryWriter& w) {
+    writeDiscoveryTemplate(w, discoveryDeviceHeader, "", "");
+
+    for (uint8_t axis = 0; axis < MOTOR_AXES; axis++) {
+        if (axis > 0) discoveryWrite(w, ",", 1);
+        // A single blind is the device's main feature and takes the device name
+        FixedString<48> name;
+        if (MOTOR_AXES == 1) name = "null";
+        else name.appendf("\"%s\"", blindAxisNames[axis]);
+        writeDiscoveryTemplate(w, discoveryCoverTemplate, axisObjectId(axis), name);
+    }
+
+    if (METRICS_HA_SENSORS) {
+        for (const DiagnosticSensor& sensor : diagnosticSensors) writeDiagnosticComponent(w, sensor);
+    }
+    discoveryWrite(w, "}}", 2);
+}
+
+// Firmware before device-based discovery announced every entity on its own
+// topic; clear those so Home Assistant does not show the entities twice
+void clearComponentDiscovery() {
+    for (uint8_t axis = 0; axis < MOTOR_AXES; axis++) {
+        MqttTopic topic;
+        topic.appendf("homeassistant/cover/%s/config", axisObjectId(axis).c_str());
+        mqttClient.publish(topic.c_str(), "", true);
+    }
+    for (const DiagnosticSensor& sensor : diagnosticSensors) {
+        MqttTopic topic;
+        topic.appendf("homeassistant/sensor/%s_%s/config", mqttClientId, sensor.key);
+        mqttClient.publish(topic.c_str(), "", true);
+    }
+}
+
+// Publish the device payload unless the broker already holds this exact
+// content (hash kept in the config store), so reconnects and fleet
+// power-ups cost no discovery traffic. force = Home Assistant restarted.
+bool publishDeviceDiscovery(bool force) {
+    DiscoveryWriter measure = {false, 0, 2166136261UL};
+    writeDeviceDiscovery(measure);
+
+    uint32_t publishedHash = 0;
+    bool published = configGet(CONFIG_KEY_DISCOVERY_HASH, &publishedHash, sizeof(publishedHash)) == sizeof(publishedHash);
+    if (published && publishedHash == measure.hash && !force) {
+        LOG_I(LOG_MQTT, "Discovery unchanged, not republished");
+        return true;
+    }
+
+    LOG_I(LOG_MQTT, "Discovery message size: %u", (unsigned)measure.length);
+    if (!mqttClient.beginPublish(deviceDiscoveryTopic, measure.length, true)) return false;
+    DiscoveryWriter out = {true, 0, 2166136261UL};
+    writeDeviceDiscovery(out);
+    if (mqttClient.endPublish() <= 0) return false;
+
+    if (!published) clearComponentDiscovery();
+    configSet(CONFIG_KEY_DISCOVERY_HASH, &measure.hash, sizeof(measure.hash));
+    return true;
+}
+
 void sendMQTTDiscoveryMessage() {
-    if (mqttDiscoveryMsgSent) return;
-    printSeparator(1);
-    Serial.println("Sending MQTT Discovery Message...");
-
-    DynamicJsonDocument doc(1024);
-    char buffer[512];
-    bool retain = true;
-
-    // Basic config with abbreviations to save memory
-    doc["name"] = "ESP8266_" + mqttClientId;
-    doc["uniq_id"] = mqttClientId;      // abbreviated: uniq_id
-    doc["qos"] = 0;
-    doc["retain"] = retain;
-    doc["optimistic"] = false;
-
-    // Topics (using abbreviations)
-    doc["cmd_t"] = commandTopic;            // abbreviated: command_topic
-    doc["pos_t"] = positionTopic;           // abbreviated: position_topic
-    doc["set_pos_t"] = setPositionTopic;    // abbreviated: set_pos_t
-    doc["avty_t"] = availabilityTopic;      // abbreviated: avty_t
-
-    // Payloads (using abbreviations)
-    doc["pl_open"] = payloadOpen;               // abbreviated: pl_open
-    doc["pl_cls"] = payloadClose;               // abbreviated: pl_cls
-    doc["pl_stop"] = payloadStop;               // abbreviated: pl_stop
-    doc["pl_avail"] = payloadAvailable;         // abbreviated: pl_avail
-    doc["pl_not_avail"] = payloadNotAvailable;  // abbreviated: pl_not_avail
-
-    // Position Mapping
-    doc["pos_open"] = 100;  // abbreviated: position_open
-    doc["pos_closed"] = 0;  // abbreviated: position_closed
-
-    // Device Info (Required for device-based discovery)
-    JsonObject device = doc.createNestedObject("dev");      // abbreviated: device
-    device["ids"] = mqttClientId;                          // abbreviated: ids (can be string or array)
-    device["name"] = String(BLIND_NAME);
-    device["mf"] = "Mintek";                               // abbreviated: mf
-    device["mdl"] = "";                                    // abbreviated: mdl
-    device["sw"] = "";                                     // abbreviated: sw
-
-    // Origin Info (Recommended/Required for device-based discovery)
-    JsonObject origin = doc.createNestedObject("o");        // abbreviated: origin
-    origin["name"] = String(BLIND_NAME);
-    origin["sw"] = "";                                     // abbreviated: sw
-
-    size_t n = serializeJson(doc, buffer);
-    Serial.println("Discovery message size: " + String(n));
-
-    // mqttDiscoveryMsgSent = mqttClient.publish(discoveryTopic.c_str(), payload.c_str(), retain);
-    mqttDiscoveryMsgSent = mqttClient.publish(discoveryTopic.c_str(), (const uint8_t*)buffer, n, retain);
-    if (mqttDiscoveryMsgSent)
-        Serial.println("Discovery message published successfully");
-    else
-        Serial.println("ERROR: Failed to publish discovery message");
+    if (mqttDiscoveryMsgSent && !discoveryRepublishRequested) return;
+    LOG_I(LOG_MQTT, "Sending MQTT Discovery Message...");
 
-    delay(500);
-    printSeparator(3);
+    mqttDiscoveryMsgSent = publishDeviceDiscovery(discoveryRepublishRequested);
+    if (mqttDiscoveryMsgSent) {
+        discoveryRepublishRequested = false;
+        LOG_I(LOG_MQTT, "Discovery message published successfully");
+    }
+    else {
+        LOG_E(LOG_MQTT, "Failed to publish discovery message");
+    }
 }
 
 void deleteMQTTDevice() {
-    printSeparator(1);
-    Serial.println("Deleting MQTT Device from Home Assistant...");
+    LOG_I(LOG_MQTT, "Deleting MQTT Device from Home Assistant...");
     
-    // Publish empty payload to discovery topic with retain flag
-    // This will remove the component and clear the published discovery payload
-    bool success = mqttClient.publish(discoveryTopic.c_str(), "", true);
+    // Publish empty payload to the device discovery topic with retain flag
+    // This will remove all components and clear the published discovery payload
+    bool success = mqttClient.publish(deviceDiscoveryTopic, "", true);
     
     if (success) {
-        Serial.println("Device deletion message published successfully");
-        Serial.println("Discovery topic: " + discoveryTopic);
-        // Reset the discovery message sent flag so it can be re-sent if needed
+        LOG_I(LOG_MQTT, "Device deletion message published to %s", deviceDiscoveryTopic);
+        // Forget the published payload so it is re-sent if needed
+        configRemove(CONFIG_KEY_DISCOVERY_HASH);
         mqttDiscoveryMsgSent = false;
     } else {
-        Serial.println("ERROR: Failed to publish device deletion message");
+        LOG_E(LOG_MQTT, "Failed to publish device deletion message");
     }
-    
-    delay(500);
-    printSeparator(3);
 }
 
 void sendMQTTAvailabilityMessage() {
     if (mqttAvailableMsgSent) return;
-    printSeparator(1);
-    Serial.println("Sending MQTT Availability Message...");
-    mqttAvailableMsgSent = mqttClient.publish(availabilityTopic.c_str(), payloadAvailable);
+    LOG_I(LOG_MQTT, "Sending MQTT Availability Message...");
+    // Retained, so it replaces the retained "offline" will
+    mqttAvailableMsgSent = mqttClient.publish(availabilityTopic, payloadAvailable, true);
     if (mqttAvailableMsgSent)
-        Serial.println("Availability message published successfully");
+        LOG_I(LOG_MQTT, "Availability message published successfully");
     else
-        Serial.println("ERROR: Failed to publish availability message");
-    printSeparator(3);
+        LOG_E(LOG_MQTT, "Failed to publish availability message");
 }
 
 void handleMQTTServer() {
     mqttClient.loop();
 }
 
+// MQTT task: connect, announce and service the client once WiFi is up
+void handleMQTT() {
+    checkMQTTConnection();
+    if (WiFi.status() == WL_CONNECTED) {
+        handleResolver(mqttServer.c_str());
+        setupMQTT();
+        if (mqttSetupActive) {
+            sendMQTTDiscoveryMessage();
+            sendMQTTAvailabilityMessage();
+            publishStateEvents();
+        }
+    }
+    handleMQTTServer();
+}
+
 #endif // MQTT_UTILS_H
\ No newline at end of file
@@ -0,0 +1,86 @@
+#ifndef POWER_UTILS_H
+#define POWER_UTILS_H
+
+#include <ESP8266WiFi.h>
+
+#include "motor_utils.h"
+#include "metrics_utils.h"
+#include "scheduler_utils.h"
+#include "log_utils.h"
+
+// Power Modes (select per blind with build_flags, e.g. -DPOWER_MODE=2).
+// They set what the radio and CPU do while idle; the motor driver is
+// released after every move in all of them.
+#define POWER_MODE_NONE 0   // radio always on, no sleep
+#define POWER_MODE_MODEM 1  // modem sleep between beacons while idle
+#define POWER_MODE_LIGHT 2  // light sleep: the CPU also pauses while idle
+#ifndef POWER_MODE
+#define POWER_MODE POWER_MODE_NONE
+#endif
+
+// Upper bound on how long an MQTT command may wait at the access point
+// while idle. The radio wakes every POWER_LISTEN_INTERVAL beacons.
+#ifndef POWER_WAKE_LATENCY_MS
+#define POWER_WAKE_LATENCY_MS 300
+#endif
+
+// Power Configuration
+#define POWER_BEACON_INTERVAL_MS 102   // typical AP beacon interval (100 TU)
+#define POWER_IDLE_DELAY_MS 5000       // stay at full power this long after a move
+#define POWER_IDLE_TICK_MS 10          // scheduler pause per pass while idle
+#define POWER_DRIVER_OFF_DELAY_MS 500  // de-energize the coils after the motor settles
+
+#define POWER_LISTEN_INTERVAL_RAW (POWER_WAKE_LATENCY_MS / POWER_BEACON_INTERVAL_MS)
+#define POWER_LISTEN_INTERVAL \
+    (POWER_LISTEN_INTERVAL_RAW < 1 ? 1 : (POWER_LISTEN_INTERVAL_RAW > 10 ? 10 : POWER_LISTEN_INTERVAL_RAW))
+
+bool powerIdle = false;
+unsigned long powerLastActiveTime = 0;
+unsigned long powerIdleSince = 0;
+
+void powerEnterIdle() {
+    WiFi.setSleepMode(POWER_MODE == POWER_MODE_LIGHT ? WIFI_LIGHT_SLEEP : WIFI_MODEM_SLEEP, POWER_LISTEN_INTERVAL);
+    powerIdle = true;
+    powerIdleSince = millis();
+    LOG_I(LOG_POWER, "idle (listen interval %d)", (int)POWER_LISTEN_INTERVAL);
+}
+
+void powerExitIdle() {
+    WiFi.setSleepMode(WIFI_NONE_SLEEP);
+    powerIdle = false;
+    metricPowerIdleMs += millis() - powerIdleSince;
+    LOG_I(LOG_POWER, "full");
+}
+
+// Called from loop() after each scheduler pass. While idle, hand the CPU
+// back to the SDK until the next task is due (at most a tick) so it can
+// sleep; returns at once for a move or a task due within a millisecond.
+void powerIdleWait() {
+    if (!powerIdle || motorIsMoving()) return;
+    unsigned long waitUs = schedulerNextDueUs();
+    if (waitUs > POWER_IDLE_TICK_MS * 1000UL) waitUs = POWER_IDLE_TICK_MS * 1000UL;
+    if (waitUs < 1000) return;
+    unsigned long start = micros();
+    delay(waitUs / 1000);
+    metricCpuSleepUs += micros() - start;
+}
+
+// Power task: full power while moving; once the blind has settled the
+// coils are released, then the radio sleeps if the power mode allows it
+void handlePower() {
+    if (motorIsMoving()) {
+        powerLastActiveTime = millis();
+        if (powerIdle) powerExitIdle();
+        return;
+    }
+
+    unsigned long idleTime = millis() - powerLastActiveTime;
+    if (motorDriverEnabled && idleTime >= POWER_DRIVER_OFF_DELAY_MS) motorSetDriverEnabled(false);
+    if (POWER_MODE == POWER_MODE_NONE) return;
+
+    // Station sleep only applies once associated; the setup portal stays awake
+    if (!powerIdle && idleTime >= POWER_IDLE_DELAY_MS && WiFi.status() == WL_CONNECTED) powerEnterIdle();
+    else if (powerIdle && WiFi.status() != WL_CONNECTED) powerExitIdle();
+}
+
+#endif // POWER_UTILS_H
@@ -0,0 +1,92 @@
+#ifndef PROFILE_UTILS_H
+#define PROFILE_UTILS_H
+
+#include <Arduino.h>
+
+// Motion Configuration
+#define MOTOR_MAX_SPEED 1000     // steps/s
+#define MOTOR_ACCELERATION 500   // steps/s^2 (average over the ramp for the S-curve)
+
+// Step timer tick rate (timer1, TIM_DIV16 from the 80 MHz APB clock)
+#define STEPPER_TIMER_HZ 5000000UL
+
+// Acceleration Profiles
+#define MOTION_PROFILE_TRAPEZOID 0  // constant acceleration
+#define MOTION_PROFILE_SCURVE 1     // jerk-limited: acceleration ramps up, then down
+#ifndef MOTION_PROFILE
+#define MOTION_PROFILE MOTION_PROFILE_TRAPEZOID
+#endif
+
+// Both profiles reach MOTOR_MAX_SPEED after the same number of steps
+#define PROFILE_RAMP_STEPS ((uint32_t)MOTOR_MAX_SPEED * MOTOR_MAX_SPEED / (2 * MOTOR_ACCELERATION))
+#define PROFILE_CRUISE_INTERVAL (STEPPER_TIMER_HZ / MOTOR_MAX_SPEED)
+
+// The ramp is precomputed at compile time into a table of step intervals in
+// timer ticks: entry i is the wait before step i+1 when starting from rest.
+// Decelerating from ramp level r replays entries r-1 .. 0, so the motor
+// engine only needs integer compares and one flash read per step.
+template <uint32_t N>
+struct RampTable {
+    uint32_t interval[N];
+};
+
+constexpr double profileSqrt(double x) {
+    if (x <= 0) return 0;
+    double r = x > 1 ? x : 1;
+    for (int i = 0; i < 64; i++) r = 0.5 * (r + x / r);
+    return r;
+}
+
+// Trapezoid: s = a*t^2/2, so step n is reached at t = sqrt(2n/a)
+constexpr double trapezoidStepTime(uint32_t n) {
+    return profileSqrt(2.0 * n / MOTOR_ACCELERATION);
+}
+
+// S-curve over ramp time Tr = vmax/a: v = 2*vmax*(t/Tr)^2 in the first half,
+// mirrored in the second half, i.e. constant jerk 4*vmax/Tr^2.
+constexpr double scurvePosition(double t) {
+    const double vmax = MOTOR_MAX_SPEED;
+    const double tr = (double)MOTOR_MAX_SPEED / MOTOR_ACCELERATION;
+    if (t <= tr / 2) return 2 * vmax * t * t * t / (3 * tr * tr);
+    double u = tr - t;
+    return vmax * tr / 2 - vmax * u + 2 * vmax * u * u * u / (3 * tr * tr);
+}
+
+constexpr double scurveStepTime(uint32_t n) {
+    double lo = 0;
+    double hi = (double)MOTOR_MAX_SPEED / MOTOR_ACCELERATION;
+    for (int i = 0; i < 48; i++) {
+        double mid = (lo + hi) / 2;
+        if (scurvePosition(mid) < n) lo = mid;
+        else hi = mid;
+    }
+    return hi;
+}
+
+constexpr double profileStepTime(uint32_t n) {
+    return (MOTION_PROFILE == MOTION_PROFILE_SCURVE) ? scurveStepTime(n) : trapezoidStepTime(n);
+}
+
+constexpr RampTable<PROFILE_RAMP_STEPS> makeRampTable() {
+    RampTable<PROFILE_RAMP_STEPS> table = {};
+    double previous = 0;
+    for (uint32_t i = 0; i < PROFILE_RAMP_STEPS; i++) {
+        double next = profileStepTime(i + 1);
+        uint32_t ticks = (uint32_t)((next - previous) * STEPPER_TIMER_HZ + 0.5);
+        table.interval[i] = (ticks < PROFILE_CRUISE_INTERVAL) ? PROFILE_CRUISE_INTERVAL : ticks;
+        previous = next;
+    }
+    return table;
+}
+
+static_assert(PROFILE_RAMP_STEPS > 0, "MOTOR_MAX_SPEED too low for MOTOR_ACCELERATION");
+static_assert(makeRampTable().interval[0] <= 0x7FFFFF, "first ramp step does not fit the 23-bit timer");
+
+// Lives in flash; read with pgm_read_dword()
+const RampTable<PROFILE_RAMP_STEPS> rampTable PROGMEM = makeRampTable();
+
+inline uint32_t rampInterval(uint32_t level) {
+    return pgm_read_dword(&rampTable.interval[level]);
+}
+
+#endif // PROFILE_UTILS_H
@@ -0,0 +1,172 @@
+#ifndef RESOLVER_UTILS_H
+#define RESOLVER_UTILS_H
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+
+#include "config_utils.h"
+#include "metrics_utils.h"
+#include "log_utils.h"
+
+// Lookups: lwIP's asynchronous resolver on the ESP8266 (DNS, and mDNS for
+// .local names), so the MQTT task never waits on a multicast query. That
+// holds only on the device: the host build resolves synchronously through
+// the shim, so handleResolver() blocks in WiFi.hostByName() for the whole
+// simulated mDNS delay (NATIVE_MDNS_DELAY_MS).
+#ifdef ESP8266
+#include <lwip/dns.h>
+#endif
+
+// Resolver Configuration
+#define RESOLVER_TTL_MS 300000UL        // refresh the cached address after this
+#define RESOLVER_TIMEOUT_MS 3000        // a lookup still running after this has failed
+#define RESOLVER_RETRY_MS 30000UL       // wait after a failed lookup
+
+// Used when the name has never resolved (e.g. "192.168.1.10"; "" = none)
+#ifndef RESOLVER_FALLBACK_IP
+#define RESOLVER_FALLBACK_IP ""
+#endif
+
+// Cached broker address. Kept in the config store with the CRC of the name
+// it belongs to, so the first connect after a reboot needs no lookup either
+// and a changed broker name never uses a stale address.
+struct ResolverCache {
+    uint32_t ip;       // 0 = none
+    uint16_t hostCrc;
+    uint16_t reserved;
+};
+
+ResolverCache resolverCache;
+bool resolverLoaded = false;
+unsigned long resolverRefreshedAt = 0;
+bool resolverStale = true;              // refresh on the next poll
+bool resolverLookupActive = false;
+unsigned long resolverLookupStart = 0;
+unsigned long resolverLastFailure = 0;
+bool resolverFailedOnce = false;
+
+// Set from lwIP's callback; resolverGeneration drops answers to lookups
+// that already timed out
+volatile bool resolverResultReady = false;
+volatile uint32_t resolverResultIp = 0;
+uint8_t resolverGeneration = 0;
+
+uint16_t resolverHostCrc(const char* host) {
+    return configCrc16(0xFFFF, (const uint8_t*)host, strlen(host));
+}
+
+// Load the persisted address for host, once
+void resolverLoad(const char* host) {
+    if (resolverLoaded) return;
+    resolverLoaded = true;
+    if (configGet(CONFIG_KEY_BROKER_ADDRESS, &resolverCache, sizeof(resolverCache)) != sizeof(resolverCache) ||
+        resolverCache.hostCrc != resolverHostCrc(host))
+        resolverCache.ip = 0;
+}
+
+// Broker name changed (setMQTTBroker): forget the old address
+void resolverReset() {
+    resolverCache.ip = 0;
+    resolverLoaded = false;
+    resolverStale = true;
+    resolverFailedOnce = false;
+    resolverLookupActive = false;
+    resolverGeneration++;
+    configRemove(CONFIG_KEY_BROKER_ADDRESS);
+}
+
+// A connect to the cached address failed: the broker may have moved, so
+// look it up again now instead of waiting out the TTL
+void resolverConnectFailed() {
+    resolverStale = true;
+}
+
+void resolverFinish(const char* host, uint32_t ip) {
+    resolverLookupActive = false;
+    if (ip == 0) {
+        metricResolverFailures++;
+        resolverLastFailure = millis();
+        resolverFailedOnce = true;
+        LOG_W(LOG_MQTT, "lookup of %s failed%s", host,
+              resolverCache.ip ? ", keeping the cached address" : "");
+        return;
+    }
+    resolverRefreshedAt = millis();
+    resolverStale = false;
+    resolverFailedOnce = false;
+    if (ip == resolverCache.ip) return;
+
+    IPAddress address(ip);
+    LOG_I(LOG_MQTT, "%s is %u.%u.%u.%u", host, address[0], address[1], address[2], address[3]);
+    resolverCache.ip = ip;
+    resolverCache.hostCrc = resolverHostCrc(host);
+    resolverCache.reserved = 0;
+    configSet(CONFIG_KEY_BROKER_ADDRESS, &resolverCache, sizeof(resolverCache));
+}
+
+#ifdef ESP8266
+void resolverFound(const char* name, const ip_addr_t* addr, void* arg) {
+    (void)name;
+    if ((uint8_t)(uintptr_t)arg != resolverGeneration) return;
+    resolverResultIp = addr ? ip_addr_get_ip4_u32(addr) : 0;
+    resolverResultReady = true;
+}
+#endif
+
+void resolverStartLookup(const char* host) {
+    metricResolverLookups++;
+    resolverLookupActive = true;
+    resolverLookupStart = millis();
+    resolverResultReady = false;
+    resolverGeneration++;
+#ifdef ESP8266
+    ip_addr_t addr;
+    err_t err = dns_gethostbyname(host, &addr, resolverFound, (void*)(uintptr_t)resolverGeneration);
+    if (err == ERR_OK) resolverFinish(host, ip_addr_get_ip4_u32(&addr));
+    else if (err != ERR_INPROGRESS) resolverFinish(host, 0);
+#else
+    IPAddress addr;
+    resolverFinish(host, WiFi.hostByName(host, addr) ? (uint32_t)addr : 0);
+#endif
+}
+
+// MQTT task: start a lookup when the address is missing, stale or past its
+// TTL, and collect the answer. The cached address stays in use meanwhile.
+void handleResolver(const char* host) {
+    IPAddress literal;
+    if (literal.fromString(host)) return;
+    resolverLoad(host);
+
+    if (resolverLookupActive) {
+        if (resolverResultReady) resolverFinish(host, resolverResultIp);
+        else if (millis() - resolverLookupStart >= RESOLVER_TIMEOUT_MS) {
+            resolverGeneration++;
+            resolverFinish(host, 0);
+        }
+        return;
+    }
+    if (WiFi.status() != WL_CONNECTED) return;
+    if (resolverFailedOnce && millis() - resolverLastFailure < RESOLVER_RETRY_MS) return;
+    if (resolverStale || resolverCache.ip == 0 || millis() - resolverRefreshedAt >= RESOLVER_TTL_MS)
+        resolverStartLookup(host);
+}
+
+// Address to connect to: a literal IP as is, else the cached address (even
+// past its TTL), else RESOLVER_FALLBACK_IP once a lookup has failed.
+// False while there is nothing to try yet.
+bool resolverAddress(const char* host, IPAddress& out) {
+    if (out.fromString(host)) return true;
+    if (resolverCache.ip) {
+        out = IPAddress(resolverCache.ip);
+        return true;
+    }
+    return resolverFailedOnce && out.fromString(RESOLVER_FALLBACK_IP);
+}
+
+// The first lookup is still running: worth waiting for rather than
+// counting a failed connect attempt
+bool resolverPending() {
+    return resolverCache.ip == 0 && resolverLookupActive;
+}
+
+#endif // RESOLVER_UTILS_H
@@ -0,0 +1,126 @@
+#ifndef SCHEDULER_UTILS_H
+#define SCHEDULER_UTILS_H
+
+#include <Arduino.h>
+#include <limits.h>
+
+#include "led_utils.h"
+#include "metrics_utils.h"
+#include "log_utils.h"
+
+// Scheduler Configuration
+#define SCHEDULER_MAX_TASKS 12
+#define SCHEDULER_STATS_INTERVAL_MS 60000  // 60 sec
+
+// Every subsystem is a resumable state machine: a task callback does a small
+// slice of work and returns, it never waits inside delay().
+typedef void (*TaskCallback)();
+
+struct Task {
+    const char* name;
+    TaskCallback callback;
+    unsigned long intervalUs;  // 0 = run on every scheduler pass
+    unsigned long lastRunUs;
+    unsigned long maxRunUs;    // worst-case time spent inside the callback
+    unsigned long maxGapUs;    // worst-case time between two runs (responsiveness)
+    uint32_t runCount;
+    LatencyHistogram runHist;  // cumulative since boot, for /metrics
+};
+
+Task tasks[SCHEDULER_MAX_TASKS];
+uint8_t taskCount = 0;
+
+// Worst-case duration of one full pass over all tasks since the last stats
+// report; printSchedulerStats() logs and resets it
+unsigned long schedulerWindowMaxPassUs = 0;
+
+// Cumulative pass times since boot (never reset; its maxUs is the exported
+// blinds_loop_max_us), and the time spent recording them, in CPU cycles
+LatencyHistogram schedulerPassHist;
+uint64_t schedulerBusyCycles = 0;
+uint64_t schedulerMetricsCycles = 0;
+
+void addTask(const char* name, TaskCallback callback, unsigned long intervalMs) {
+    if (taskCount >= SCHEDULER_MAX_TASKS) {
+        LOG_E(LOG_SYS, "scheduler full, task not added: %s", name);
+        return;
+    }
+    Task& task = tasks[taskCount++];
+    task.name = name;
+    task.callback = callback;
+    task.intervalUs = intervalMs * 1000UL;
+    task.lastRunUs = micros();
+    task.maxRunUs = 0;
+    task.maxGapUs = 0;
+    task.runCount = 0;
+    memset(&task.runHist, 0, sizeof(task.runHist));
+}
+
+// Run every task that is due. Called from loop().
+void runScheduler() {
+    unsigned long passStart = micros();
+
+    for (uint8_t i = 0; i < taskCount; i++) {
+        Task& task = tasks[i];
+        unsigned long start = micros();
+        unsigned long gap = start - task.lastRunUs;
+        if (gap < task.intervalUs) continue;
+
+        task.callback();
+
+        unsigned long end = micros();
+        uint32_t metricsStart = ESP.getCycleCount();
+        unsigned long runTime = end - start;
+        if (runTime > task.maxRunUs) task.maxRunUs = runTime;
+        if (gap > task.maxGapUs) task.maxGapUs = gap;
+        task.lastRunUs = start;
+        task.runCount++;
+        metricsRecord(task.runHist, runTime);
+        schedulerMetricsCycles += ESP.getCycleCount() - metricsStart;
+    }
+
+    unsigned long passTime = micros() - passStart;
+    if (passTime > schedulerWindowMaxPassUs) schedulerWindowMaxPassUs = passTime;
+    uint32_t metricsStart = ESP.getCycleCount();
+    metricsRecord(schedulerPassHist, passTime);
+    schedulerBusyCycles += (uint64_t)passTime * (F_CPU / 1000000);
+    schedulerMetricsCycles += ESP.getCycleCount() - metricsStart;
+}
+
+// Microseconds until the next task is due, 0 if one already is, ULONG_MAX
+// if none has an interval. Tasks that run on every pass don't count.
+unsigned long schedulerNextDueUs() {
+    unsigned long now = micros();
+    unsigned long next = ULONG_MAX;
+    for (uint8_t i = 0; i < taskCount; i++) {
+        const Task& task = tasks[i];
+        if (task.intervalUs == 0) continue;
+        unsigned long elapsed = now - task.lastRunUs;
+        if (elapsed >= task.intervalUs) return 0;
+        if (task.intervalUs - elapsed < next) next = task.intervalUs - elapsed;
+    }
+    return next;
+}
+
+// Share of scheduler time spent on instrumentation, in 1/10000 (0.01%)
+uint32_t schedulerMetricsOverheadBp() {
+    if (schedulerBusyCycles == 0) return 0;
+    return (uint32_t)(schedulerMetricsCycles * 10000 / schedulerBusyCycles);
+}
+
+// Print worst-case latencies since the last report, then reset them
+void printSchedulerStats() {
+    LOG_I(LOG_SYS, "Scheduler stats (worst case since last report):");
+    LOG_I(LOG_SYS, "%-8s %10s %10s %10s", "task", "runs", "max_run_us", "max_gap_us");
+    for (uint8_t i = 0; i < taskCount; i++) {
+        Task& task = tasks[i];
+        LOG_I(LOG_SYS, "%-8s %10u %10lu %10lu", task.name, (unsigned)task.runCount, task.maxRunUs, task.maxGapUs);
+        task.maxRunUs = 0;
+        task.maxGapUs = 0;
+        task.runCount = 0;
+    }
+    LOG_I(LOG_SYS, "Max loop pass: %lu us", schedulerWindowMaxPassUs);
+    schedulerWindowMaxPassUs = 0;
+}
+
+#endif // SCHEDULER_UTILS_H
@@ -0,0 +1,145 @@
+#ifndef STATUS_UTILS_H
+#define STATUS_UTILS_H
+
+#include <ESP8266WiFi.h>
+
+#include "config_utils.h"
+#include "http_utils.h"
+#include "motor_utils.h"
+#include "metrics_utils.h"
+
+// Status Push Configuration
+#define STATUS_EVENT_INTERVAL_MS 1000  // max one event per client per interval
+#define STATUS_JSON_MAX_LEN 160
+
+// Live device status shown on the home page
+struct StatusSnapshot {
+    uint8_t position;   // 0-100
+    bool moving;
+    int8_t rssi;        // dBm
+    uint32_t freeHeap;
+    uint32_t uptime;    // seconds
+    uint8_t sleep;      // CPU sleep residency, percent of uptime
+    uint32_t latency;   // last command-to-motion latency, us
+};
+
+// What each event stream client has already been sent
+StatusSnapshot statusLastSent[HTTP_MAX_CONNECTIONS];
+bool statusNeedsFull[HTTP_MAX_CONNECTIONS];
+unsigned long statusLastEventTime[HTTP_MAX_CONNECTIONS];
+
+void readStatusSnapshot(StatusSnapshot& s) {
+    s.position = blindPositionPercent();
+    s.moving = motorIsMoving();
+    s.rssi = (int8_t)WiFi.RSSI();
+    s.freeHeap = ESP.getFreeHeap();
+    s.uptime = millis() / 1000;
+    s.sleep = metricsSleepResidencyPct();
+    s.latency = metricCommandLatencyUs;
+}
+
+// Append ,"key":value to a JSON object under construction
+void appendStatusField(char* out, size_t size, size_t& len, const char* key, long value) {
+    int n = snprintf(out + len, size - len, "%s\"%s\":%ld", len > 1 ? "," : "", key, value);
+    if (n > 0 && len + n < size) len += n;
+}
+
+// Build a JSON object with the fields of `now` that differ from `last`
+// (all fields if `last` is NULL). Returns the number of fields written.
+uint8_t buildStatusJson(char* out, size_t size, const StatusSnapshot& now, const StatusSnapshot* last) {
+    size_t len = 0;
+    out[len++] = '{';
+    out[len] = '\0';
+    uint8_t fields = 0;
+    if (!last || now.position != last->position) { appendStatusField(out, size, len, "position", now.position); fields++; }
+    if (!last || now.moving != last->moving) {
+        int n = snprintf(out + len, size - len, "%s\"moving\":%s", len > 1 ? "," : "", now.moving ? "true" : "false");
+        if (n > 0 && len + n < size) len += n;
+        fields++;
+    }
+    if (!last || now.rssi != last->rssi) { appendStatusField(out, size, len, "rssi", now.rssi); fields++; }
+    if (!last || now.freeHeap != last->freeHeap) { appendStatusField(out, size, len, "heap", now.freeHeap); fields++; }
+    if (!last || now.uptime != last->uptime) { appendStatusField(out, size, len, "uptime", now.uptime); fields++; }
+    if (!last || now.sleep != last->sleep) { appendStatusField(out, size, len, "sleep", now.sleep); fields++; }
+    if (!last || now.latency != last->latency) { appendStatusField(out, size, len, "latency", now.latency); fields++; }
+    if (len + 2 <= size) {
+        out[len++] = '}';
+        out[len] = '\0';
+    }
+    return fields;
+}
+
+// Copy a string into JSON, escaping quotes and backslashes
+void appendJsonString(char* out, size_t size, size_t& len, const char* value) {
+    if (len + 1 < size) out[len++] = '"';
+    for (const char* p = value; *p && len + 3 < size; p++) {
+        if (*p == '"' || *p == '\\') out[len++] = '\\';
+        if ((uint8_t)*p >= 0x20) out[len++] = *p;
+    }
+    if (len + 1 < size) out[len++] = '"';
+    out[len] = '\0';
+}
+
+// GET /status: full snapshot plus the static connection details
+void handleStatusRequest() {
+    static char json[STATUS_JSON_MAX_LEN + 64];
+    StatusSnapshot now;
+    readStatusSnapshot(now);
+    buildStatusJson(json, sizeof(json), now, NULL);
+
+    // Reopen the object to add ssid and ip
+    size_t len = strlen(json) - 1;
+    char ip[16];
+    IPAddress local = WiFi.localIP();
+    snprintf(ip, sizeof(ip), "%u.%u.%u.%u", local[0], local[1], local[2], local[3]);
+    const char* keys[] = {",\"ssid\":", ",\"ip\":"};
+    WifiSsid ssid;  // the network we join, without WiFi.SSID()'s heap String
+    configGetString(CONFIG_KEY_WIFI_SSID, ssid);
+    const char* values[] = {ssid.c_str(), ip};
+    for (uint8_t i = 0; i < 2; i++) {
+        size_t keyLen = strlen(keys[i]);
+        if (len + keyLen >= sizeof(json)) break;
+        memcpy(json + len, keys[i], keyLen);
+        len += keyLen;
+        appendJsonString(json, sizeof(json), len, values[i]);
+    }
+    if (len + 2 <= sizeof(json)) {
+        json[len++] = '}';
+        json[len] = '\0';
+    }
+
+    httpSendHeader("Cache-Control", "no-store");
+    httpSend(200, "application/json", json);
+}
+
+// GET /events: Server-Sent Events stream of changed status fields
+void handleStatusEvents() {
+    if (!httpBeginEventStream()) return;
+    uint8_t index = httpCurrentIndex();
+    statusNeedsFull[index] = true;
+    statusLastEventTime[index] = millis() - STATUS_EVENT_INTERVAL_MS;
+}
+
+// Status task: push changes to every event stream, rate-limited per client
+void handleStatusPush() {
+    if (httpEventStreamCount() == 0) return;
+
+    StatusSnapshot now;
+    readStatusSnapshot(now);
+    char json[STATUS_JSON_MAX_LEN];
+
+    for (uint8_t i = 0; i < HTTP_MAX_CONNECTIONS; i++) {
+        if (!httpIsEventStream(i)) continue;
+        if (millis() - statusLastEventTime[i] < STATUS_EVENT_INTERVAL_MS) continue;
+
+        const StatusSnapshot* last = statusNeedsFull[i] ? NULL : &statusLastSent[i];
+        if (buildStatusJson(json, sizeof(json), now, last) == 0) continue;
+        if (!httpSendEvent(i, json)) continue;  // client still busy, retry next time
+
+        statusLastSent[i] = now;
+        statusNeedsFull[i] = false;
+        statusLastEventTime[i] = millis();
+    }
+}
+
+#endif // STATUS_UTILS_H
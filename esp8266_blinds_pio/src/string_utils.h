@@ -0,0 +1,112 @@
+#ifndef STRING_UTILS_H
+#define STRING_UTILS_H
+
+#include <Arduino.h>
+#include <stdarg.h>
+
+// Fixed-capacity strings for everything the firmware keeps or builds as text
+// (credentials, broker settings, MQTT topics). They live in globals or on the
+// stack, never on the heap, so a long uptime cannot fragment the ~40 KB heap
+// the way Arduino String does. Appends past the capacity are cut and noted
+// in truncated().
+
+// Non-owning view of a run of chars, not necessarily NUL-terminated
+struct StringView {
+    const char* data;
+    size_t len;
+
+    constexpr StringView() : data(""), len(0) {}
+    constexpr StringView(const char* s) : data(s), len(__builtin_strlen(s)) {}
+    constexpr StringView(const char* s, size_t n) : data(s), len(n) {}
+
+    constexpr size_t length() const { return len; }
+    constexpr bool empty() const { return len == 0; }
+    constexpr char operator[](size_t i) const { return data[i]; }
+
+    // [from, to), clamped to the view
+    constexpr StringView substring(size_t from, size_t to = SIZE_MAX) const {
+        if (to > len) to = len;
+        if (from > to) from = to;
+        return StringView(data + from, to - from);
+    }
+
+    bool startsWith(StringView prefix) const {
+        return prefix.len <= len && memcmp(data, prefix.data, prefix.len) == 0;
+    }
+
+    bool operator==(StringView other) const {
+        return len == other.len && memcmp(data, other.data, len) == 0;
+    }
+    bool operator!=(StringView other) const { return !(*this == other); }
+};
+
+template <size_t N>
+class FixedString {
+public:
+    FixedString() { clear(); }
+    FixedString(StringView s) { clear(); append(s); }
+
+    // Safe when s points into this string
+    FixedString& operator=(StringView s) {
+        len = 0;
+        cut = false;
+        return append(s);
+    }
+
+    void clear() {
+        len = 0;
+        buf[0] = '\0';
+        cut = false;
+    }
+
+    FixedString& append(StringView s) {
+        size_t n = s.len <= N - len ? s.len : N - len;
+        memmove(buf + len, s.data, n);
+        len += n;
+        buf[len] = '\0';
+        if (n < s.len) cut = true;
+        return *this;
+    }
+
+    FixedString& append(char c) {
+        return append(StringView(&c, 1));
+    }
+
+    FixedString& appendf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+        va_list args;
+        va_start(args, format);
+        int n = vsnprintf(buf + len, N + 1 - len, format, args);
+        va_end(args);
+        if (n < 0) n = 0;
+        if ((size_t)n > N - len) {
+            n = N - len;
+            cut = true;
+        }
+        len += n;
+        return *this;
+    }
+
+    FixedString& operator+=(StringView s) { return append(s); }
+    FixedString& operator+=(char c) { return append(c); }
+
+    const char* c_str() const { return buf; }
+    size_t length() const { return len; }
+    bool empty() const { return len == 0; }
+    bool truncated() const { return cut; }
+    static constexpr size_t capacity() { return N; }
+
+    char operator[](size_t i) const { return buf[i]; }
+    StringView view() const { return StringView(buf, len); }
+    operator StringView() const { return view(); }
+    StringView substring(size_t from, size_t to = SIZE_MAX) const { return view().substring(from, to); }
+
+    bool operator==(StringView other) const { return view() == other; }
+    bool operator!=(StringView other) const { return view() != other; }
+
+private:
+    char buf[N + 1];
+    size_t len;
+    bool cut;  // an append did not fit
+};
+
+#endif // STRING_UTILS_H
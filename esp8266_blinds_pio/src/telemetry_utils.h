@@ -0,0 +1,185 @@
+#ifndef TELEMETRY_UTILS_H
+#define TELEMETRY_UTILS_H
+
+#include <ESP8266WiFi.h>
+#include <stdarg.h>
+
+#include "http_utils.h"
+#include "metrics_utils.h"
+#include "motor_utils.h"
+#include "mqtt_utils.h"
+#include "scheduler_utils.h"
+
+// Telemetry Configuration
+#define METRICS_HA_INTERVAL_MS 60000
+
+// Append printf-style text at len; output that does not fit is dropped whole
+void metricsAppend(char* buf, size_t size, size_t& len, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(buf + len, size - len, format, args);
+    va_end(args);
+    if (n > 0 && len + n < size) len += n;
+    else buf[len] = '\0';
+}
+
+// printf on the ESP8266 has no %llu
+const char* metricsFormatU64(char* out, uint64_t value) {
+    char digits[21];
+    uint8_t n = 0;
+    do {
+        digits[n++] = '0' + (char)(value % 10);
+        value /= 10;
+    } while (value);
+    for (uint8_t i = 0; i < n; i++) out[i] = digits[n - 1 - i];
+    out[n] = '\0';
+    return out;
+}
+
+uint32_t stepperMaxSlipUs() {
+    return stepperMaxSlipCycles / (F_CPU / 1000000);
+}
+
+// ---------------------------------------------------------------------------
+// Prometheus text exposition (GET /metrics)
+// ---------------------------------------------------------------------------
+
+// Fixed sections, then METRICS_HIST_PARTS parts per histogram.
+// Every part stays well under HTTP_TX_BUFFER_LEN.
+#define METRICS_FIXED_SECTIONS 6
+
+size_t writeMetricsSection(char* buf, size_t size, uint8_t section) {
+    size_t len = 0;
+    buf[0] = '\0';
+    switch (section) {
+        case 0:
+            metricsAppend(buf, size, len, "# TYPE blinds_heap_free_bytes gauge\nblinds_heap_free_bytes %u\n", (unsigned)ESP.getFreeHeap());
+            metricsAppend(buf, size, len, "# TYPE blinds_heap_max_block_bytes gauge\nblinds_heap_max_block_bytes %u\n", (unsigned)ESP.getMaxFreeBlockSize());
+            metricsAppend(buf, size, len, "# TYPE blinds_heap_fragmentation_percent gauge\nblinds_heap_fragmentation_percent %u\n", (unsigned)ESP.getHeapFragmentation());
+            metricsAppend(buf, size, len, "# TYPE blinds_uptime_seconds counter\nblinds_uptime_seconds %u\n", (unsigned)(millis() / 1000));
+            break;
+        case 1:
+            metricsAppend(buf, size, len, "# TYPE blinds_wifi_connects_total counter\nblinds_wifi_connects_total %u\n", (unsigned)metricWifiConnects);
+            metricsAppend(buf, size, len, "# TYPE blinds_wifi_drops_total counter\nblinds_wifi_drops_total %u\n", (unsigned)metricWifiDrops);
+            metricsAppend(buf, size, len, "# TYPE blinds_mqtt_connects_total counter\nblinds_mqtt_connects_total %u\n", (unsigned)metricMqttConnects);
+            metricsAppend(buf, size, len, "# TYPE blinds_mqtt_drops_total counter\nblinds_mqtt_drops_total %u\n", (unsigned)metricMqttDrops);
+            metricsAppend(buf, size, len, "# TYPE blinds_wifi_rssi_dbm gauge\nblinds_wifi_rssi_dbm %d\n", (int)WiFi.RSSI());
+            break;
+        case 2:
+            metricsAppend(buf, size, len, "# TYPE blinds_boot_to_wifi_ms gauge\nblinds_boot_to_wifi_ms %u\n", (unsigned)metricBootToWifiMs);
+            metricsAppend(buf, size, len, "# TYPE blinds_boot_to_mqtt_ms gauge\nblinds_boot_to_mqtt_ms %u\n", (unsigned)metricBootToMqttMs);
+            metricsAppend(buf, size, len, "# TYPE blinds_startup_jitter_ms gauge\nblinds_startup_jitter_ms %u\n", (unsigned)metricStartupJitterMs);
+            // Worst pass since boot; the windowed max only goes to the log
+            metricsAppend(buf, size, len, "# TYPE blinds_loop_max_us gauge\nblinds_loop_max_us %u\n", (unsigned)schedulerPassHist.maxUs);
+            metricsAppend(buf, size, len, "# TYPE blinds_metrics_overhead_ratio gauge\nblinds_metrics_overhead_ratio %u.%04u\n",
+                          (unsigned)(schedulerMetricsOverheadBp() / 10000), (unsigned)(schedulerMetricsOverheadBp() % 10000));
+            break;
+        case 3:
+            metricsAppend(buf, size, len, "# TYPE blinds_step_underruns_total counter\nblinds_step_underruns_total %u\n", (unsigned)stepperUnderruns);
+            metricsAppend(buf, size, len, "# TYPE blinds_step_slip_max_us gauge\nblinds_step_slip_max_us %u\n", (unsigned)stepperMaxSlipUs());
+            metricsAppend(buf, size, len, "# TYPE blinds_event_drops_total counter\nblinds_event_drops_total %u\n",
+                          (unsigned)(motionEvents.dropped + stepperIsrEvents.dropped));
+            metricsAppend(buf, size, len, "# TYPE blinds_log_dropped_total counter\nblinds_log_dropped_total %u\n", (unsigned)logDropped);
+            metricsAppend(buf, size, len, "# TYPE blinds_position_percent gauge\n");
+            for (uint8_t axis = 0; axis < MOTOR_AXES; axis++)
+                metricsAppend(buf, size, len, "blinds_position_percent{axis=\"%u\"} %u\n", (unsigned)axis, (unsigned)blindPositionPercent(axis));
+            break;
+        case 4:
+            metricsAppend(buf, size, len, "# TYPE blinds_sleep_residency_percent gauge\nblinds_sleep_residency_percent %u\n", (unsigned)metricsSleepResidencyPct());
+            metricsAppend(buf, size, len, "# TYPE blinds_power_idle_ms_total counter\nblinds_power_idle_ms_total %u\n", (unsigned)metricPowerIdleMs);
+            metricsAppend(buf, size, len, "# TYPE blinds_command_latency_us gauge\nblinds_command_latency_us %u\n", (unsigned)metricCommandLatencyUs);
+            metricsAppend(buf, size, len, "# TYPE blinds_command_latency_max_us gauge\nblinds_command_latency_max_us %u\n", (unsigned)metricCommandLatencyMaxUs);
+            break;
+        case 5:
+            metricsAppend(buf, size, len, "# TYPE blinds_broker_lookups_total counter\nblinds_broker_lookups_total %u\n", (unsigned)metricResolverLookups);
+            metricsAppend(buf, size, len, "# TYPE blinds_broker_lookup_failures_total counter\nblinds_broker_lookup_failures_total %u\n", (unsigned)metricResolverFailures);
+            break;
+    }
+    return len;
+}
+
+// One part of a histogram: 0 = TYPE line and the lower buckets, 1 = the
+// upper buckets, 2 = sum and count
+#define METRICS_HIST_PARTS 3
+
+size_t writeHistogramPart(char* buf, size_t size, const char* name, const char* task,
+                          const LatencyHistogram& hist, uint8_t part, bool withType) {
+    size_t len = 0;
+    buf[0] = '\0';
+    char label[24] = "";
+
+    if (part < 2) {
+        if (task) snprintf(label, sizeof(label), "task=\"%s\",", task);
+        if (part == 0 && withType) metricsAppend(buf, size, len, "# TYPE %s histogram\n", name);
+        uint8_t first = part * (METRICS_HIST_BUCKETS / 2);
+        uint32_t cumulative = 0;
+        for (uint8_t b = 0; b < first; b++) cumulative += hist.buckets[b];
+        for (uint8_t b = first; b < first + METRICS_HIST_BUCKETS / 2; b++) {
+            cumulative += hist.buckets[b];
+            if (b + 1 < METRICS_HIST_BUCKETS)
+                metricsAppend(buf, size, len, "%s_bucket{%sle=\"%u\"} %u\n", name, label,
+                              (unsigned)(metricsBucketBoundUs(b) - 1), (unsigned)cumulative);
+            else
+                metricsAppend(buf, size, len, "%s_bucket{%sle=\"+Inf\"} %u\n", name, label, (unsigned)cumulative);
+        }
+    }
+    else {
+        char sum[21];
+        if (task) snprintf(label, sizeof(label), "{task=\"%s\"}", task);
+        metricsAppend(buf, size, len, "%s_sum%s %s\n%s_count%s %u\n", name, label,
+                      metricsFormatU64(sum, hist.sumUs), name, label, (unsigned)hist.count);
+    }
+    return len;
+}
+
+// HttpStreamWriter for /metrics
+size_t writeMetrics(char* buf, size_t size, uint16_t index) {
+    if (index < METRICS_FIXED_SECTIONS) return writeMetricsSection(buf, size, index);
+
+    uint16_t histogram = (index - METRICS_FIXED_SECTIONS) / METRICS_HIST_PARTS;
+    uint8_t part = (index - METRICS_FIXED_SECTIONS) % METRICS_HIST_PARTS;
+    if (histogram < taskCount)
+        return writeHistogramPart(buf, size, "blinds_task_run_us", tasks[histogram].name,
+                                  tasks[histogram].runHist, part, histogram == 0);
+    if (histogram == taskCount)
+        return writeHistogramPart(buf, size, "blinds_loop_pass_us", NULL, schedulerPassHist, part, true);
+    if (histogram == taskCount + 1)
+        return writeHistogramPart(buf, size, "blinds_config_commit_us", NULL, metricConfigCommitHist, part, true);
+    return 0;
+}
+
+void handleMetricsRequest() {
+    httpSendHeader("Cache-Control", "no-store");
+    httpSendStream(200, "text/plain; version=0.0.4", writeMetrics);
+}
+
+// ---------------------------------------------------------------------------
+// Home Assistant diagnostic sensors (METRICS_HA_SENSORS)
+// ---------------------------------------------------------------------------
+
+// The sensors are announced with the device discovery payload (mqtt_utils.h)
+bool diagnosticsPublished = false;
+unsigned long diagnosticsLastPublishTime = 0;
+
+bool publishDiagnostics() {
+    char payload[160];
+    size_t len = 0;
+    payload[0] = '\0';
+    metricsAppend(payload, sizeof(payload), len,
+        "{\"heap\":%u,\"max_block\":%u,\"heap_frag\":%u,\"loop_max_us\":%u,\"reconnects\":%u,\"step_slip_us\":%u}",
+        (unsigned)ESP.getFreeHeap(), (unsigned)ESP.getMaxFreeBlockSize(), (unsigned)ESP.getHeapFragmentation(),
+        (unsigned)schedulerPassHist.maxUs, (unsigned)(metricWifiDrops + metricMqttDrops), (unsigned)stepperMaxSlipUs());
+    return mqttClient.publish(diagnosticsTopic, payload);
+}
+
+// Diagnostics task: publish once connected, then periodically
+void handleDiagnostics() {
+    if (!METRICS_HA_SENSORS || !mqttSetupActive) return;
+    if (diagnosticsPublished && millis() - diagnosticsLastPublishTime < METRICS_HA_INTERVAL_MS) return;
+    if (publishDiagnostics()) {
+        diagnosticsPublished = true;
+        diagnosticsLastPublishTime = millis();
+    }
+}
+
+#endif // TELEMETRY_UTILS_H
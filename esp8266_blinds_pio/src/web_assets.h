@@ -0,0 +1,204 @@
+// Generated by scripts/build_web_assets.py from wifi-config.html, wifi-home.html. Do not edit.
+#ifndef WEB_ASSETS_H
+#define WEB_ASSETS_H
+
+#include <Arduino.h>
+
+// wifi-config.html: 8285 bytes, 4221 minified, 1538 gzipped
+const uint8_t WIFI_SETUP_GZ[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xcd, 0x58, 0x5b, 0x6f, 0xdb, 0x36,
+    0x14, 0x7e, 0xf7, 0xaf, 0x60, 0x55, 0xac, 0x70, 0x36, 0xcb, 0x76, 0x12, 0x37, 0x4d, 0x7d, 0xc9,
+    0xd0, 0x26, 0xe9, 0x5a, 0xa0, 0x5d, 0x83, 0x26, 0xc5, 0x36, 0x0c, 0x7d, 0xa0, 0xa4, 0x23, 0x9b,
+    0x2d, 0x4d, 0x6a, 0x24, 0x65, 0xc7, 0x1b, 0xf2, 0xdf, 0x77, 0x0e, 0x29, 0x29, 0xb6, 0x13, 0xa7,
+    0xc5, 0xb0, 0x87, 0xc2, 0x89, 0x25, 0x1e, 0xf2, 0xdc, 0xbe, 0x73, 0x63, 0x32, 0x7e, 0x74, 0xf6,
+    0xfe, 0xf4, 0xea, 0x8f, 0x8b, 0x73, 0x36, 0x73, 0x73, 0x79, 0xd2, 0x1a, 0xd3, 0x83, 0x49, 0xae,
+    0xa6, 0x93, 0x08, 0x54, 0x44, 0x04, 0xe0, 0x19, 0x3e, 0xe6, 0xe0, 0x38, 0x4b, 0x67, 0xdc, 0x58,
+    0x70, 0x93, 0xe8, 0xe3, 0xd5, 0xab, 0xf8, 0x38, 0xaa, 0xc9, 0x8a, 0xcf, 0x61, 0x12, 0x2d, 0x04,
+    0x2c, 0x0b, 0x6d, 0x5c, 0xc4, 0x52, 0xad, 0x1c, 0x28, 0x3c, 0xb6, 0x14, 0x99, 0x9b, 0x4d, 0x32,
+    0x58, 0x88, 0x14, 0x62, 0xbf, 0xe8, 0x30, 0xa1, 0x84, 0x13, 0x5c, 0xc6, 0x36, 0xe5, 0x12, 0x26,
+    0xfb, 0xdd, 0x3e, 0x89, 0x71, 0xc2, 0x49, 0x38, 0xf9, 0x4d, 0xbc, 0x12, 0xec, 0x54, 0xab, 0x5c,
+    0x4c, 0x4b, 0xc3, 0x9d, 0xd0, 0x6a, 0xdc, 0x0b, 0x3b, 0xad, 0xb1, 0x75, 0x2b, 0x7a, 0xfe, 0xc8,
+    0xfe, 0x69, 0xcd, 0xb9, 0x99, 0x0a, 0x35, 0x64, 0xfd, 0x51, 0xab, 0xe0, 0x59, 0x26, 0xd4, 0xd4,
+    0xbf, 0x27, 0xfa, 0x3a, 0xb6, 0xe2, 0x6f, 0xbf, 0x4c, 0xb4, 0xc9, 0xc0, 0xc4, 0x48, 0x1a, 0xb5,
+    0x6e, 0x70, 0x27, 0x5b, 0x21, 0x5f, 0x8e, 0x66, 0xc5, 0x39, 0x9f, 0x0b, 0xb9, 0x1a, 0xb2, 0x17,
+    0x06, 0x8d, 0xe8, 0x30, 0xcb, 0x95, 0x8d, 0x2d, 0x18, 0x91, 0xa3, 0x00, 0x9e, 0x7e, 0x99, 0x1a,
+    0x5d, 0xaa, 0x2c, 0x4e, 0xb5, 0xd4, 0x66, 0xc8, 0x1e, 0xef, 0x73, 0xfa, 0x8c, 0x5a, 0x99, 0xb0,
+    0x85, 0xe4, 0xc8, 0x96, 0x4b, 0x40, 0x91, 0x9f, 0x4b, 0xeb, 0x44, 0xbe, 0x8a, 0x2b, 0x47, 0x87,
+    0x2c, 0xc5, 0x6f, 0x30, 0xa3, 0x16, 0x97, 0x62, 0xaa, 0x62, 0xe1, 0x60, 0x6e, 0x6f, 0x89, 0x73,
+    0xa1, 0xe2, 0x19, 0x88, 0xe9, 0x0c, 0x0f, 0xee, 0xf7, 0xfb, 0x8b, 0x19, 0xd9, 0xd4, 0x25, 0x5e,
+    0x2e, 0x14, 0x18, 0xb4, 0xec, 0x1e, 0xcd, 0x07, 0x19, 0x7d, 0xc8, 0x2b, 0xef, 0x89, 0xe1, 0x99,
+    0x28, 0x51, 0xe6, 0x71, 0x71, 0x5d, 0x79, 0x3a, 0xe3, 0x99, 0x5e, 0xa2, 0xe3, 0xec, 0xa0, 0xb8,
+    0x46, 0xb1, 0xf8, 0x65, 0xa6, 0x09, 0x6f, 0xf7, 0x3b, 0xac, 0xfa, 0xe9, 0x3e, 0xdd, 0x1b, 0xb5,
+    0x3c, 0xe8, 0x5e, 0xed, 0x0f, 0x68, 0x08, 0xbf, 0x8e, 0x2b, 0xc2, 0xa0, 0xdf, 0x27, 0x49, 0xeb,
+    0xf8, 0xa1, 0x4d, 0x1e, 0xec, 0x38, 0xe1, 0x3b, 0x6c, 0x7a, 0x9e, 0x3c, 0xcb, 0x93, 0xe3, 0x51,
+    0xab, 0x5a, 0x2f, 0x67, 0xe8, 0xe8, 0x9a, 0x8c, 0x03, 0x2f, 0xd2, 0xc1, 0xb5, 0x8b, 0x3d, 0x0e,
+    0xb7, 0x08, 0xdc, 0x75, 0xc2, 0xff, 0xf6, 0x49, 0xad, 0x8f, 0x0a, 0xc6, 0x0d, 0x50, 0xc0, 0x80,
+    0x04, 0x78, 0xc2, 0xb2, 0xc2, 0x2b, 0xd1, 0x32, 0xf3, 0xa6, 0xe5, 0xda, 0xcc, 0xe3, 0x75, 0xcc,
+    0x1a, 0xb5, 0x87, 0x5e, 0xed, 0x03, 0x10, 0xd6, 0xdc, 0xb4, 0x5d, 0x34, 0xf9, 0x83, 0xc9, 0xe1,
+    0x9c, 0x9e, 0xd7, 0x66, 0xdf, 0xb4, 0x24, 0x4f, 0x40, 0xe2, 0x76, 0x13, 0xeb, 0x44, 0xea, 0xf4,
+    0xcb, 0x68, 0xfb, 0xb8, 0x8f, 0x40, 0xad, 0x02, 0xfa, 0xf4, 0xd9, 0xb2, 0xf9, 0x69, 0xdf, 0xa3,
+    0x29, 0x54, 0x51, 0xba, 0x3f, 0xdd, 0xaa, 0xc0, 0xda, 0x20, 0x50, 0xa2, 0x4f, 0x9d, 0x0d, 0x5a,
+    0xc1, 0xad, 0x5d, 0x22, 0x30, 0xd1, 0x27, 0x54, 0xba, 0x11, 0xa7, 0xc6, 0xb5, 0xfd, 0x83, 0x10,
+    0x6e, 0x42, 0x0f, 0x57, 0x08, 0x99, 0xd5, 0x52, 0x64, 0xec, 0xf1, 0x60, 0x30, 0xb8, 0x83, 0xea,
+    0x2d, 0x78, 0x01, 0xcd, 0xfd, 0xa3, 0x1d, 0xb8, 0xd4, 0x49, 0xbd, 0xed, 0x84, 0x33, 0x58, 0x0c,
+    0x82, 0xca, 0xae, 0x29, 0x20, 0x7f, 0x04, 0x53, 0xe9, 0xd0, 0xde, 0xef, 0xd1, 0x30, 0xd7, 0x69,
+    0x69, 0x77, 0xf9, 0x15, 0x76, 0xd1, 0x3b, 0x5d, 0x3a, 0x89, 0x61, 0x1b, 0x32, 0xa5, 0x15, 0x34,
+    0x86, 0xd7, 0xfa, 0x93, 0x67, 0xcf, 0x07, 0xf9, 0x91, 0x8f, 0x93, 0x2d, 0x93, 0xb9, 0x70, 0x71,
+    0x52, 0x22, 0xd6, 0xea, 0x6b, 0xb0, 0x7c, 0x6b, 0x82, 0xd6, 0xf8, 0x6d, 0x28, 0x7f, 0x18, 0xb5,
+    0x7b, 0x72, 0x30, 0x2d, 0x8d, 0x25, 0xa1, 0x85, 0x16, 0x21, 0xa9, 0x37, 0xe0, 0xda, 0xb2, 0xa5,
+    0x81, 0x6c, 0xd3, 0xa3, 0xe1, 0x4c, 0x2f, 0x76, 0x15, 0xfc, 0x2e, 0x14, 0x86, 0x3c, 0x75, 0x62,
+    0x01, 0xf7, 0x33, 0x1d, 0x27, 0x47, 0x39, 0x3f, 0x0e, 0xfd, 0x44, 0x02, 0x37, 0xff, 0x19, 0xb9,
+    0xec, 0xf0, 0x20, 0x3f, 0xc8, 0xbf, 0x1f, 0xe4, 0xaa, 0xa2, 0x73, 0xba, 0x18, 0xfa, 0xe6, 0x76,
+    0xc7, 0xc5, 0x87, 0xa0, 0xcc, 0x07, 0x83, 0xc3, 0xc3, 0xa3, 0xbb, 0x2c, 0x0f, 0x21, 0x99, 0x3c,
+    0xdb, 0x4f, 0xf7, 0x53, 0xe2, 0x19, 0xf7, 0xaa, 0x59, 0x33, 0xee, 0x55, 0xb3, 0x8f, 0xe6, 0x07,
+    0x3e, 0x32, 0xb1, 0x60, 0xa9, 0xc4, 0xec, 0x9e, 0x44, 0x4d, 0x23, 0x8a, 0x36, 0xe9, 0x4d, 0x03,
+    0x45, 0xfa, 0xdd, 0x69, 0x86, 0x12, 0xf1, 0xec, 0x26, 0xc7, 0x66, 0x5f, 0x23, 0x71, 0x44, 0x61,
+    0x22, 0xa3, 0xe9, 0x99, 0x8b, 0x57, 0xb8, 0x88, 0x18, 0x4e, 0xd9, 0x99, 0x46, 0xca, 0xc5, 0xfb,
+    0xcb, 0xab, 0x88, 0x91, 0x1b, 0x5a, 0x4d, 0xa2, 0x1e, 0x1d, 0x20, 0x5e, 0xd4, 0x10, 0xdd, 0x23,
+    0xd5, 0xf7, 0x3b, 0xda, 0x08, 0x9d, 0x0d, 0x69, 0x41, 0xe6, 0xaf, 0x38, 0xae, 0xa3, 0x30, 0x6c,
+    0xe9, 0x95, 0xb5, 0x2f, 0x2f, 0xdf, 0x9c, 0xed, 0x0d, 0xc7, 0x3d, 0x7f, 0x0e, 0xcf, 0xfb, 0x6a,
+    0x66, 0x6b, 0x75, 0xde, 0x98, 0xe3, 0x59, 0xab, 0x79, 0x6f, 0xad, 0xc8, 0x22, 0x66, 0xe0, 0xaf,
+    0x52, 0x18, 0x20, 0x98, 0x76, 0x38, 0xb7, 0xcb, 0x8c, 0x8b, 0xba, 0x4f, 0x9c, 0xd4, 0x6f, 0x3b,
+    0x4c, 0x68, 0x1a, 0x4a, 0x63, 0x46, 0xc3, 0x5a, 0x99, 0x72, 0x7b, 0xe2, 0xae, 0x39, 0x55, 0x45,
+    0x04, 0x51, 0xa1, 0xb2, 0xa2, 0xda, 0xbe, 0x8d, 0x42, 0x8b, 0x4e, 0x2e, 0xfd, 0x72, 0xdc, 0x0b,
+    0x6b, 0x12, 0x41, 0x0e, 0x6c, 0xcb, 0xa8, 0x4e, 0x37, 0xa9, 0xb0, 0x96, 0x61, 0xc1, 0x42, 0x4f,
+    0x79, 0x59, 0xc9, 0x3c, 0xa5, 0x05, 0xbb, 0x04, 0xe7, 0xb0, 0x00, 0xed, 0xba, 0xec, 0x60, 0x5e,
+    0xf5, 0xb0, 0xa9, 0x11, 0xc5, 0x3a, 0xe6, 0xbd, 0xcf, 0x7c, 0xc1, 0x03, 0x15, 0xb1, 0xcb, 0x4b,
+    0xe5, 0x83, 0xce, 0x2c, 0xa8, 0x8c, 0x22, 0x77, 0xc6, 0x1d, 0xa7, 0x6c, 0x68, 0x53, 0x14, 0x3a,
+    0xac, 0x06, 0x60, 0x0f, 0x93, 0x7b, 0x81, 0xfa, 0xae, 0x67, 0xce, 0x15, 0x6c, 0xc2, 0x14, 0x2c,
+    0xd9, 0xef, 0xef, 0xde, 0xbe, 0xc6, 0xd5, 0x07, 0x44, 0x06, 0xac, 0x6b, 0xe3, 0xa5, 0xc0, 0xef,
+    0x76, 0xb5, 0x32, 0x98, 0xde, 0x2b, 0xeb, 0xb8, 0x03, 0xbc, 0xd8, 0xa9, 0x29, 0x20, 0x43, 0xad,
+    0xa8, 0x4d, 0x92, 0x44, 0xce, 0xda, 0x6e, 0x26, 0x6c, 0xd7, 0x1f, 0xbc, 0xa4, 0x83, 0x6c, 0x32,
+    0x61, 0x03, 0xf6, 0xe4, 0x09, 0xf3, 0x74, 0xe2, 0xc5, 0x06, 0x8f, 0xb4, 0x83, 0x7e, 0x9f, 0x38,
+    0xf0, 0x4a, 0x67, 0x5c, 0x3b, 0xf2, 0xb9, 0x95, 0x62, 0x18, 0x70, 0xfe, 0xe3, 0x35, 0xcb, 0xb2,
+    0x00, 0xb4, 0x83, 0x0c, 0xdf, 0xd2, 0x14, 0xac, 0xcd, 0x4b, 0x29, 0x57, 0x8f, 0x22, 0x34, 0xe6,
+    0x86, 0x81, 0xb4, 0xc0, 0xbe, 0x55, 0xd7, 0xa3, 0x6d, 0x5d, 0xe7, 0xc6, 0x60, 0xd7, 0xa8, 0x14,
+    0x20, 0xc6, 0x6c, 0x5b, 0x79, 0x97, 0x5d, 0x7a, 0xd6, 0x21, 0x8b, 0xd8, 0x4f, 0xeb, 0xb2, 0x48,
+    0x79, 0xeb, 0xa6, 0x81, 0xa3, 0x00, 0xd5, 0x0e, 0x15, 0xd6, 0x61, 0x9b, 0xb5, 0xd5, 0x61, 0xce,
+    0x94, 0xd0, 0x00, 0x87, 0x37, 0xe0, 0x0a, 0xcc, 0xd7, 0x68, 0x2b, 0x98, 0x76, 0x74, 0x1a, 0xee,
+    0x81, 0x31, 0x85, 0x8f, 0xb8, 0x79, 0x51, 0x48, 0x91, 0xfa, 0x9a, 0xef, 0xe1, 0x95, 0x6b, 0xb9,
+    0x8c, 0x7d, 0x25, 0x94, 0x46, 0x82, 0x4a, 0x75, 0x06, 0x59, 0xb4, 0x26, 0x4c, 0x65, 0x6d, 0x5f,
+    0x4b, 0x13, 0x32, 0x2f, 0xec, 0x7f, 0xfc, 0xf0, 0xe6, 0x54, 0xcf, 0x0b, 0xec, 0xba, 0xca, 0xf9,
+    0x08, 0xef, 0xe1, 0x56, 0xf4, 0xa4, 0x8e, 0xf2, 0xae, 0x93, 0x4d, 0x16, 0x78, 0xcf, 0x9a, 0x9c,
+    0xf1, 0xf9, 0x78, 0x7e, 0x7e, 0xf1, 0xe1, 0xfd, 0xbb, 0x26, 0xac, 0xde, 0x33, 0x33, 0x6f, 0x47,
+    0x2f, 0x0c, 0xb0, 0x95, 0x2e, 0x11, 0xc0, 0xea, 0x65, 0xc9, 0x15, 0xe6, 0xa1, 0x0e, 0x5c, 0x8c,
+    0x4b, 0x89, 0x77, 0xe4, 0x05, 0x06, 0xce, 0xc3, 0x6a, 0xab, 0x3c, 0xfe, 0x99, 0x5d, 0x21, 0x8e,
+    0x55, 0x27, 0x62, 0x29, 0x57, 0x4a, 0x3b, 0x96, 0x00, 0xc3, 0x8e, 0x8a, 0xa6, 0x74, 0xa3, 0xbd,
+    0xef, 0x24, 0x11, 0x83, 0xd7, 0xc1, 0x97, 0xed, 0xe4, 0x63, 0x2f, 0xd0, 0xb7, 0x0d, 0xaf, 0xd8,
+    0x0c, 0x3d, 0x45, 0x37, 0x40, 0x31, 0x30, 0xdc, 0x42, 0xd6, 0xa5, 0x38, 0x21, 0x54, 0x78, 0xeb,
+    0x82, 0xae, 0xd4, 0xd3, 0x6d, 0x81, 0x6b, 0x29, 0x65, 0xc0, 0x62, 0x14, 0x2c, 0x5c, 0x61, 0xed,
+    0xfe, 0x6f, 0x59, 0xed, 0xd5, 0x50, 0x4e, 0x07, 0xb5, 0x0f, 0x65, 0x72, 0x6d, 0x25, 0x10, 0xe3,
+    0x0e, 0xfe, 0x6f, 0xaa, 0x80, 0x5f, 0xce, 0x43, 0x01, 0x84, 0xbe, 0x06, 0x50, 0x18, 0x3d, 0xbf,
+    0x5b, 0x01, 0x98, 0xb4, 0x81, 0xb9, 0x95, 0xe1, 0x1d, 0x6f, 0x8e, 0xd9, 0xd7, 0x9d, 0x82, 0x3b,
+    0x97, 0x40, 0xaf, 0x2f, 0x57, 0x6f, 0x30, 0xa7, 0x9b, 0xf1, 0xb5, 0xd7, 0xc5, 0xeb, 0xc7, 0xf9,
+    0x02, 0x37, 0xde, 0x0a, 0x8b, 0x75, 0x42, 0x15, 0x53, 0x35, 0xe2, 0xce, 0x6d, 0x9c, 0x81, 0x0e,
+    0x10, 0x02, 0xfe, 0xa5, 0x5b, 0x18, 0xff, 0x3c, 0x83, 0x9c, 0x97, 0x92, 0x92, 0x85, 0xf5, 0x7a,
+    0xec, 0x22, 0x10, 0x59, 0x16, 0xa8, 0xcc, 0x8f, 0x4a, 0x2f, 0x0a, 0x8b, 0x04, 0xe7, 0x2b, 0x65,
+    0x1c, 0x95, 0x0b, 0xe6, 0xcf, 0x83, 0x66, 0xf9, 0x31, 0xb6, 0xd7, 0x5d, 0x70, 0x59, 0xe2, 0xbd,
+    0x86, 0xb8, 0xea, 0xd2, 0xf9, 0x1a, 0x67, 0x33, 0x79, 0x1a, 0xee, 0x8d, 0xf4, 0xa0, 0x49, 0x1a,
+    0x50, 0xf6, 0x55, 0xbb, 0xb5, 0xdb, 0xcc, 0x39, 0x7f, 0xa2, 0xa9, 0xd6, 0x91, 0xcf, 0x6f, 0x6f,
+    0x37, 0xa6, 0xc5, 0x7a, 0x2b, 0xff, 0x5a, 0xb7, 0x6f, 0xf2, 0xac, 0xc9, 0x9b, 0x0b, 0x8c, 0x1a,
+    0xae, 0xfd, 0xdf, 0x5d, 0x78, 0xfd, 0x72, 0xb3, 0x90, 0xe1, 0x34, 0x26, 0x19, 0x57, 0x59, 0xc3,
+    0xea, 0x33, 0x1b, 0xc3, 0x87, 0xdf, 0x3b, 0xfd, 0x5d, 0x9f, 0x63, 0xf7, 0xc5, 0x30, 0xc5, 0x1e,
+    0xf7, 0x65, 0x3d, 0x84, 0x64, 0xf2, 0x46, 0xb3, 0x19, 0x79, 0x05, 0x78, 0xa1, 0xf2, 0x73, 0x8c,
+    0xa6, 0x5d, 0x75, 0x95, 0xea, 0xf9, 0xff, 0x36, 0xfc, 0x0b, 0xc7, 0x49, 0x3c, 0x4d, 0x7d, 0x10,
+    0x00, 0x00,
+};
+const size_t WIFI_SETUP_GZ_LEN = 1538;
+const char WIFI_SETUP_ETAG[] = "\"397e8f798383de23\"";
+
+// wifi-home.html: 6261 bytes, 4087 minified, 1394 gzipped
+const uint8_t WIFI_HOME_GZ[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xad, 0x57, 0x6d, 0x6f, 0xdb, 0x36,
+    0x10, 0xfe, 0xee, 0x5f, 0xc1, 0xa9, 0x28, 0x60, 0xaf, 0x91, 0x2c, 0xb7, 0x49, 0x96, 0xc5, 0x71,
+    0x86, 0x35, 0x6d, 0xd0, 0x0c, 0xed, 0x1a, 0x2c, 0x2d, 0x86, 0x7d, 0xa4, 0xc5, 0xb3, 0xc5, 0x56,
+    0x22, 0x05, 0x91, 0xb6, 0xe3, 0xb6, 0xf9, 0xef, 0xbb, 0xa3, 0x28, 0x45, 0x96, 0xdd, 0xd5, 0x03,
+    0x0c, 0x25, 0x96, 0x74, 0xbc, 0x97, 0xe7, 0x8e, 0x0f, 0x8f, 0xd4, 0xc5, 0x4f, 0xaf, 0xde, 0x5f,
+    0x7d, 0xf8, 0xe7, 0xf6, 0x35, 0x4b, 0x6d, 0x9e, 0x5d, 0xf6, 0x2e, 0xe8, 0xc6, 0x32, 0xae, 0xe6,
+    0x93, 0x00, 0x54, 0x40, 0x02, 0xe0, 0x02, 0x6f, 0x39, 0x58, 0xce, 0x92, 0x94, 0x97, 0x06, 0xec,
+    0x24, 0xf8, 0xf8, 0xe1, 0x3a, 0x3c, 0x0b, 0x6a, 0xb1, 0xe2, 0x39, 0x4c, 0x82, 0xa5, 0x84, 0x55,
+    0xa1, 0x4b, 0x1b, 0xb0, 0x44, 0x2b, 0x0b, 0x0a, 0xd5, 0x56, 0x52, 0xd8, 0x74, 0x22, 0x60, 0x29,
+    0x13, 0x08, 0xdd, 0xcb, 0x11, 0x93, 0x4a, 0x5a, 0xc9, 0xb3, 0xd0, 0x24, 0x3c, 0x83, 0xc9, 0x28,
+    0x8a, 0xc9, 0x8d, 0x95, 0x36, 0x83, 0xcb, 0x77, 0xda, 0xea, 0x52, 0x7e, 0x01, 0xc1, 0x5e, 0x66,
+    0x52, 0x09, 0xc3, 0x42, 0xf6, 0x46, 0xe7, 0x70, 0x31, 0xac, 0x86, 0x7b, 0x17, 0xc6, 0xae, 0xe9,
+    0xfe, 0x33, 0xfb, 0xda, 0xcb, 0x79, 0x39, 0x97, 0xea, 0x9c, 0xc5, 0xe3, 0x5e, 0xc1, 0x85, 0x90,
+    0x6a, 0xee, 0x9e, 0xa7, 0xfa, 0x3e, 0x34, 0xf2, 0x8b, 0x7b, 0x9d, 0xea, 0x52, 0x40, 0x19, 0xa2,
+    0x68, 0xdc, 0x7b, 0xc0, 0x11, 0xb1, 0x46, 0xbb, 0x19, 0x62, 0x0b, 0x67, 0x3c, 0x97, 0xd9, 0xfa,
+    0x9c, 0xfd, 0x5e, 0x22, 0x92, 0x23, 0x66, 0xb8, 0x32, 0xa1, 0x81, 0x52, 0xce, 0xd0, 0x01, 0x4f,
+    0x3e, 0xcf, 0x4b, 0xbd, 0x50, 0x22, 0x4c, 0x74, 0xa6, 0xcb, 0x73, 0xf6, 0x64, 0xc4, 0xe9, 0x1a,
+    0xf7, 0x84, 0x34, 0x45, 0xc6, 0xd1, 0x6c, 0x96, 0x01, 0xba, 0xfc, 0xb4, 0x30, 0x56, 0xce, 0xd6,
+    0xa1, 0xcf, 0xf6, 0x9c, 0x25, 0xf8, 0x0b, 0xe5, 0xb8, 0xc7, 0x33, 0x39, 0x57, 0xa1, 0xb4, 0x90,
+    0x9b, 0x47, 0x61, 0x2e, 0x55, 0x98, 0x82, 0x9c, 0xa7, 0xa8, 0x38, 0x8a, 0xe3, 0x65, 0xda, 0xc2,
+    0xfd, 0x3c, 0x2e, 0x1c, 0xc4, 0x88, 0x5c, 0x71, 0xa9, 0xa0, 0x44, 0xa0, 0x3b, 0x80, 0x3c, 0x17,
+    0x74, 0x51, 0x92, 0x2e, 0xb1, 0x92, 0x0b, 0xb9, 0xc0, 0x10, 0x67, 0x64, 0xed, 0x12, 0x4f, 0xb9,
+    0xd0, 0x2b, 0xac, 0x03, 0x7b, 0x5e, 0xdc, 0x63, 0x14, 0xfc, 0x29, 0xe7, 0x53, 0xde, 0x8f, 0x8f,
+    0x98, 0xff, 0x8b, 0x4e, 0x06, 0xe3, 0x9e, 0x9b, 0x08, 0x87, 0xe2, 0x29, 0xe2, 0xe2, 0xf7, 0xa1,
+    0x17, 0x9c, 0xc4, 0x0e, 0x47, 0xbb, 0x9c, 0x88, 0xc9, 0xd5, 0x3e, 0x9c, 0xf2, 0xef, 0x60, 0xfa,
+    0x75, 0xfa, 0xcb, 0x6c, 0x7a, 0x36, 0xee, 0xf9, 0xf7, 0x55, 0x8a, 0x79, 0x6f, 0xa5, 0x66, 0xe1,
+    0xde, 0x86, 0xae, 0x2c, 0x8f, 0x05, 0xd9, 0x4e, 0xc2, 0xfd, 0xc7, 0x14, 0xd6, 0x4d, 0x12, 0x4e,
+    0x23, 0xa0, 0x83, 0x63, 0x72, 0xe0, 0x04, 0x2b, 0x5f, 0xbe, 0xa9, 0xce, 0x44, 0x53, 0x2e, 0xf4,
+    0x86, 0xc0, 0x9a, 0x78, 0x2f, 0x5c, 0xbc, 0xff, 0xa8, 0x1d, 0x9a, 0x19, 0xcb, 0xed, 0x82, 0x26,
+    0x3c, 0xb1, 0x52, 0xab, 0x86, 0x4b, 0x48, 0x14, 0x6b, 0x75, 0x8e, 0x21, 0x4f, 0xfc, 0x74, 0x78,
+    0x45, 0x9a, 0x49, 0xd4, 0xfa, 0xd1, 0xf4, 0x9b, 0x82, 0x23, 0xcb, 0xa7, 0x60, 0x57, 0x00, 0xaa,
+    0x55, 0x82, 0x11, 0x4d, 0x46, 0xdc, 0x24, 0x5c, 0x47, 0x19, 0xa1, 0xd4, 0xe8, 0x4c, 0x0a, 0xf6,
+    0xe4, 0xf8, 0xf8, 0xb8, 0x29, 0xe0, 0x13, 0x88, 0xe9, 0xea, 0xc6, 0x3f, 0xcf, 0xb8, 0xb1, 0x61,
+    0x92, 0xca, 0x4c, 0xd0, 0x3c, 0x6c, 0xba, 0x52, 0x5a, 0x41, 0xdb, 0x20, 0xe3, 0x53, 0xc8, 0x6a,
+    0xae, 0xd7, 0x55, 0xc3, 0xd9, 0x7d, 0x0c, 0x32, 0x8d, 0xe9, 0x6a, 0xdb, 0x2c, 0x79, 0xb6, 0x00,
+    0xb4, 0xe9, 0xc2, 0xd8, 0x5d, 0xf9, 0xb6, 0x11, 0x4d, 0x83, 0xc2, 0x5a, 0x82, 0x68, 0x99, 0x1f,
+    0x27, 0x7c, 0x76, 0x52, 0x05, 0x90, 0x6a, 0xa6, 0xb7, 0x8b, 0x6d, 0x75, 0x51, 0xcf, 0x96, 0xaf,
+    0x54, 0x25, 0xaa, 0x08, 0xe3, 0x13, 0x74, 0x92, 0x6e, 0xa1, 0x6a, 0x97, 0x44, 0xaa, 0x56, 0xc4,
+    0x3a, 0xa5, 0x16, 0x77, 0x46, 0x8e, 0x3b, 0xd8, 0x4a, 0xe0, 0x71, 0xe9, 0x45, 0xa7, 0xbb, 0xe9,
+    0x48, 0x5e, 0x13, 0x07, 0xb0, 0x99, 0x67, 0xa9, 0x9c, 0xe9, 0x34, 0xd3, 0xc9, 0xe7, 0x71, 0x8d,
+    0xbb, 0xac, 0xfc, 0x9c, 0x55, 0x14, 0xb9, 0x18, 0xfa, 0x96, 0x74, 0x31, 0xf4, 0x7d, 0x92, 0xda,
+    0x0c, 0xde, 0x84, 0x5c, 0xb2, 0x04, 0xe7, 0xcc, 0x4c, 0x82, 0x66, 0x51, 0x07, 0x9b, 0xf2, 0x66,
+    0x61, 0xa1, 0xbc, 0xdb, 0xf9, 0xd0, 0x1f, 0x6a, 0x6e, 0xfb, 0x41, 0xb0, 0x1d, 0x2f, 0x9b, 0x64,
+    0xde, 0x3d, 0x48, 0x04, 0xa2, 0x11, 0x64, 0xa8, 0xea, 0x0c, 0x39, 0xaa, 0x04, 0x97, 0x7f, 0xcb,
+    0x6b, 0xc9, 0xee, 0x9c, 0x08, 0x53, 0x42, 0xb5, 0xdd, 0xda, 0x15, 0x49, 0x9a, 0xf9, 0x0e, 0x2e,
+    0xaf, 0xea, 0xc7, 0xc6, 0x6a, 0x1b, 0xf7, 0xde, 0x20, 0x5e, 0xb9, 0x7d, 0x82, 0xdd, 0xdc, 0xfe,
+    0x10, 0x42, 0xc0, 0xa4, 0x98, 0x04, 0xd5, 0xbe, 0x72, 0x73, 0x1b, 0x5c, 0xbe, 0xd5, 0x9c, 0x18,
+    0x14, 0x45, 0xd1, 0x21, 0x70, 0xdc, 0xdd, 0xdd, 0xbc, 0xda, 0x13, 0x82, 0x31, 0x52, 0x1c, 0x3c,
+    0x3c, 0xf2, 0x92, 0x67, 0x7b, 0x02, 0x28, 0x11, 0x41, 0x70, 0x19, 0x1e, 0x22, 0xae, 0x63, 0x1e,
+    0xbb, 0xd5, 0x46, 0x12, 0x93, 0xf6, 0x8c, 0x5f, 0x78, 0xf5, 0x03, 0x61, 0x70, 0xeb, 0x60, 0xcf,
+    0xd0, 0xb9, 0x5e, 0x62, 0xd1, 0x0f, 0x14, 0xf8, 0xba, 0x04, 0x60, 0x6f, 0x80, 0x17, 0x7b, 0x06,
+    0xc7, 0xd5, 0x5e, 0x1c, 0x28, 0xf4, 0xc7, 0xc2, 0x4a, 0x3a, 0xe4, 0xec, 0x15, 0x77, 0xe1, 0x94,
+    0x0f, 0x14, 0xf9, 0x2e, 0x03, 0x28, 0xd8, 0x5f, 0x80, 0x24, 0x06, 0x95, 0xac, 0xf7, 0xe5, 0x3c,
+    0x59, 0x1d, 0x08, 0xc1, 0x95, 0xce, 0x73, 0x8e, 0xac, 0x7b, 0xcb, 0xed, 0xff, 0x40, 0x90, 0x55,
+    0xda, 0x3b, 0x30, 0x6c, 0x43, 0x69, 0xef, 0x3e, 0x84, 0xa5, 0xd8, 0x18, 0xa0, 0x9d, 0x00, 0xa5,
+    0xbe, 0xf3, 0x48, 0xc3, 0xb4, 0xeb, 0xf9, 0x8c, 0x30, 0x95, 0xd8, 0xd0, 0xd7, 0xcc, 0x6a, 0xb6,
+    0x30, 0x10, 0xa1, 0xeb, 0x62, 0x2b, 0x8c, 0xbf, 0x99, 0xa4, 0x94, 0x85, 0x65, 0x76, 0x5d, 0xe0,
+    0x29, 0x98, 0x3c, 0x0e, 0x3f, 0xf1, 0x25, 0xaf, 0xa4, 0xe8, 0x7c, 0xb6, 0x50, 0xd5, 0xde, 0x87,
+    0x27, 0xe7, 0x0f, 0x38, 0xda, 0x97, 0xe2, 0x88, 0x91, 0xda, 0x80, 0x36, 0x1b, 0x9d, 0x2c, 0x72,
+    0xec, 0xea, 0xd1, 0x1c, 0xec, 0xeb, 0x0c, 0xe8, 0xf1, 0xe5, 0xfa, 0x46, 0xa0, 0xce, 0x20, 0x22,
+    0x9d, 0x2b, 0x7f, 0xc4, 0x99, 0x38, 0x0b, 0xda, 0x72, 0x1a, 0x77, 0x33, 0x5d, 0xe6, 0xdc, 0x56,
+    0xec, 0xe9, 0x63, 0x86, 0x1a, 0xf7, 0x0d, 0x72, 0xb9, 0xc4, 0xa3, 0x9a, 0x40, 0x83, 0x77, 0xdc,
+    0xa6, 0xd1, 0x2c, 0xd3, 0xba, 0xac, 0x47, 0xd9, 0x90, 0x9d, 0x9d, 0x1e, 0xc7, 0x31, 0x9e, 0x01,
+    0x49, 0x29, 0xdd, 0xad, 0xf4, 0xb4, 0x52, 0x42, 0xe5, 0x17, 0xa7, 0x8d, 0x6e, 0xfe, 0x3d, 0x5d,
+    0xd2, 0x41, 0xd5, 0x53, 0x52, 0x2c, 0xc1, 0x2e, 0x4a, 0xc5, 0xfa, 0x82, 0xfd, 0x86, 0x08, 0x9e,
+    0xb1, 0x40, 0xb0, 0x80, 0x9d, 0xb3, 0x20, 0x18, 0xe0, 0x4b, 0x4a, 0x82, 0x14, 0x05, 0xcf, 0xd0,
+    0x19, 0x3e, 0xe6, 0xc1, 0x46, 0x36, 0xbc, 0x28, 0xb2, 0x75, 0xb5, 0x03, 0xf5, 0x5d, 0x1a, 0x72,
+    0xc6, 0xfa, 0x81, 0x2c, 0x70, 0xc6, 0xb1, 0x72, 0x83, 0xa6, 0x78, 0x8f, 0x5d, 0x1f, 0xcf, 0xed,
+    0x91, 0x2c, 0x30, 0xac, 0xd3, 0x74, 0x9d, 0xb8, 0xab, 0xeb, 0x84, 0xa4, 0x47, 0x0f, 0xb5, 0xa6,
+    0x6b, 0x99, 0x5d, 0x4d, 0x27, 0x24, 0x4d, 0x7a, 0x20, 0x78, 0x4c, 0xbc, 0xcc, 0x83, 0xda, 0xa4,
+    0xe9, 0x72, 0x5d, 0xb3, 0x66, 0x80, 0x4c, 0xeb, 0x17, 0x32, 0x7f, 0xda, 0xd8, 0xfa, 0x36, 0xd5,
+    0xb5, 0xf4, 0x62, 0xb2, 0xab, 0x1e, 0xb1, 0x66, 0xc1, 0x3b, 0xaf, 0x8b, 0x35, 0xbb, 0x11, 0x19,
+    0x34, 0x3e, 0x5c, 0xb7, 0xe9, 0x7a, 0x70, 0x42, 0xb2, 0xa7, 0x07, 0x07, 0x79, 0xba, 0xb6, 0x60,
+    0x1a, 0x23, 0xdf, 0x2a, 0xba, 0x66, 0x5e, 0x7c, 0xd4, 0xe1, 0x4f, 0x54, 0xc9, 0x07, 0x4d, 0x3d,
+    0xdd, 0x2a, 0xdf, 0x2a, 0xa8, 0x93, 0xba, 0x8a, 0xba, 0xde, 0xb1, 0x91, 0x69, 0xbd, 0x2c, 0xbb,
+    0x46, 0xb5, 0xfc, 0x88, 0x61, 0x18, 0xff, 0x82, 0x94, 0xc1, 0xef, 0x8f, 0x18, 0x49, 0xae, 0xaf,
+    0xe5, 0x3d, 0x88, 0xfe, 0x68, 0xe0, 0x52, 0xc8, 0x1d, 0xfe, 0x07, 0xfc, 0x46, 0x51, 0xf8, 0x29,
+    0x13, 0xe1, 0x72, 0xc4, 0xbd, 0x15, 0xb9, 0x57, 0xf3, 0xa4, 0x4f, 0xd4, 0xd8, 0xc5, 0x05, 0x6f,
+    0x80, 0x67, 0x35, 0x4e, 0x7a, 0x51, 0xaa, 0x8d, 0xa5, 0xef, 0x52, 0xf6, 0xed, 0x1b, 0x0b, 0x3e,
+    0xaa, 0xcf, 0x4a, 0xaf, 0x14, 0xb9, 0x9e, 0x81, 0x4d, 0xd2, 0x7e, 0x30, 0xac, 0xba, 0x4a, 0x80,
+    0x00, 0x52, 0x50, 0xfd, 0xc6, 0x7d, 0x89, 0xfe, 0x99, 0xe7, 0x71, 0x19, 0x7d, 0x32, 0x14, 0x71,
+    0xcc, 0x1e, 0xbc, 0x5a, 0x8b, 0xa4, 0x83, 0x08, 0x03, 0xa1, 0xa7, 0x36, 0xb0, 0x07, 0x5f, 0x09,
+    0x8f, 0xe5, 0xf5, 0x12, 0x57, 0xee, 0x9d, 0x5e, 0x94, 0x09, 0xd4, 0xeb, 0x12, 0x48, 0x64, 0x30,
+    0x1f, 0x05, 0x2b, 0xd6, 0x1a, 0x47, 0x40, 0xd5, 0x10, 0x41, 0xac, 0x9e, 0x30, 0xf7, 0x1c, 0x8c,
+    0xe1, 0x73, 0x68, 0xa7, 0x4f, 0x9e, 0x36, 0xd6, 0xca, 0x1f, 0x77, 0xef, 0xff, 0x8c, 0x0a, 0xfa,
+    0x2c, 0xef, 0x43, 0x24, 0xb8, 0xe5, 0x03, 0xc2, 0x4b, 0x25, 0xc4, 0x1f, 0x6c, 0x8f, 0xae, 0x0b,
+    0x51, 0xaf, 0xf2, 0x07, 0xd3, 0xa1, 0xfb, 0xce, 0xff, 0x17, 0x42, 0x49, 0x9e, 0xfc, 0xf7, 0x0f,
+    0x00, 0x00,
+};
+const size_t WIFI_HOME_GZ_LEN = 1394;
+const char WIFI_HOME_ETAG[] = "\"e28b3131ec360378\"";
+
+#endif // WEB_ASSETS_H
@@ -1,18 +1,34 @@
 #ifndef WIFI_UTILS_H
 #define WIFI_UTILS_H
 
-#include <ESP8266WebServer.h>
 #include <ESP8266WiFi.h>
 
+#include "http_utils.h"
 #include "led_utils.h"
-#include "html_pages.h"
-#include "eeprom_utils.h"
+#include "web_assets.h"
+#include "config_utils.h"
+#include "status_utils.h"
+#include "metrics_utils.h"
+#include "telemetry_utils.h"
+#include "log_utils.h"
 
 // Constants
 #define WIFI_SETUP_TIMEOUT_MS 600000  // 60 sec
 #define WIFI_CONNECTION_ATTEMPTS 10
 #define WIFI_CONNECTION_DELAY_MS 5000
-#define SERVER_POLL_DELAY_MS 100  // Reduced from 100ms
+#define WIFI_FAST_CONNECT_TIMEOUT_MS 3000  // then fall back to a full scan
+#define WIFI_BACKOFF_MIN_MS 10000          // wait after a failed connection, doubled per failure
+#define WIFI_BACKOFF_MAX_MS 300000
+#define WIFI_RTC_BLOCK 0                   // RTC user memory offset (4-byte blocks)
+
+// Power-restore Jitter
+// After a house-wide power cut every blind boots in the same second and
+// would hit the router and the broker together. On a power-on reset the
+// network start is held back by up to STARTUP_JITTER_MAX_MS. The delay is
+// derived from the chip id, so it differs per device but not per boot.
+#ifndef STARTUP_JITTER_MAX_MS
+#define STARTUP_JITTER_MAX_MS 10000
+#endif
 
 // AP Configuration
 const char* ap_ssid = "Mintek_Blinds";
@@ -21,65 +37,125 @@ IPAddress ap_gateway(192, 168, 1, 1);  // Gateway IP (usually same as AP IP)
 IPAddress ap_subnet(255, 255, 255, 0); // Subnet mask
 
 // Web Server
-ESP8266WebServer server(80);
+#ifndef HTTP_PORT
+#define HTTP_PORT 80
+#endif
 
 // WiFi State Variables
 bool credentialsSubmitted = false;  // Flag to track when credentials are submitted
 bool wifiConnection = false;        // reset flag to false when Wifi reset
+bool serverRoutesRegistered = false;
+
+// WiFi State Machine
+enum WifiState {
+  WIFI_STATE_STARTUP_HOLD,
+  WIFI_STATE_DISCONNECTED,
+  WIFI_STATE_PORTAL,
+  WIFI_STATE_CONNECTING,
+  WIFI_STATE_CONNECTED
+};
+WifiState wifiState = WIFI_STATE_DISCONNECTED;
+unsigned long wifiPortalStartTime = 0;
+unsigned long wifiConnectStartTime = 0;
+unsigned long wifiLastProgressTime = 0;
+unsigned long wifiStartupHoldMs = 0;
+unsigned long wifiDisconnectedAt = 0;
+unsigned long wifiRetryDelayMs = 0;  // 0 = reconnect at once
+unsigned long wifiBackoffMs = WIFI_BACKOFF_MIN_MS;
 
 // WiFi Station Static IP Configuration
 IPAddress wifi_ip(192, 168, 68, 136);      // Static IP address for WiFi station
 IPAddress wifi_gateway(192, 168, 68, 1);   // Gateway IP (usually your router IP)
 IPAddress wifi_subnet(255, 255, 255, 0);  // Subnet mask
 
+// Fast Reconnect Cache
+// Last good access point and IP settings. Joining with a known BSSID and
+// channel skips the scan, and a known IP skips DHCP. Kept in RTC memory,
+// which survives resets and deep sleep, with the config store as the
+// fallback after a power cycle.
+struct WifiFastConnect {
+  uint32_t crc;       // over the rest of the struct
+  uint32_t ip;
+  uint32_t gateway;
+  uint32_t subnet;
+  uint32_t dns;
+  uint16_t ssidCrc;   // only valid for the network it was learned on
+  uint8_t channel;
+  uint8_t bssid[6];
+  uint8_t reserved;
+};
+static_assert(sizeof(WifiFastConnect) % 4 == 0, "RTC memory is accessed in 4-byte blocks");
+static_assert(sizeof(WifiFastConnect) <= CONFIG_MAX_VALUE_LEN, "fast connect cache does not fit a config value");
+
+WifiFastConnect wifiFastConnect;
+bool wifiFastConnectActive = false;  // current attempt uses the cache
+
+// Serve a gzipped page straight from flash. Browsers revalidate with
+// If-None-Match and get a bodyless 304 while the firmware is unchanged.
+void sendGzipAsset(const uint8_t* data, size_t length, const char* etag) {
+  httpSendHeader("ETag", etag);
+  httpSendHeader("Cache-Control", "no-cache");
+  if (strcmp(httpIfNoneMatch(), etag) == 0) {
+    httpSend(304);
+    return;
+  }
+  httpSendHeader("Content-Encoding", "gzip");
+  httpSend_P(200, "text/html", data, length);
+}
+
 // Handle AP Configuration Page
 void handleAPSetupPage(){
-  String s = WIFI_SETUP;
-  server.send(200,"text/html",s);
+  sendGzipAsset(WIFI_SETUP_GZ, WIFI_SETUP_GZ_LEN, WIFI_SETUP_ETAG);
 }
 
 void handleWifiHomePage(){
-  String s = WIFI_HOME;
-  server.send(200,"text/html",s);
+  sendGzipAsset(WIFI_HOME_GZ, WIFI_HOME_GZ_LEN, WIFI_HOME_ETAG);
 }
 
+// The form body, every SSID and password byte percent-encoded as
+// encodeURIComponent() does for non-ASCII: "ssid=...&password=..."
+static_assert(HTTP_BODY_MAX_LEN >= 5 + 3 * MAX_SSID_LEN + 10 + 3 * MAX_PASSWORD_LEN,
+              "HTTP_BODY_MAX_LEN too small for the WiFi form");
+
 // Handle WiFi configuration POST request
 void handleWiFiConfig() {
-    if (server.hasArg("ssid") && server.hasArg("password")) {
-        String ssid = server.arg("ssid");
-        String password = server.arg("password");
-
-        // Limit length to prevent overflow
-        if (ssid.length() > MAX_SSID_LEN) ssid = ssid.substring(0, MAX_SSID_LEN);
-        if (password.length() > MAX_PASSWORD_LEN) password = password.substring(0, MAX_PASSWORD_LEN);
-
-        // Store credentials in EEPROM
-        writeStringToEEPROM(SSID_ADDR, ssid);
-        writeStringToEEPROM(PASSWORD_ADDR, password);
+    WifiSsid ssidArg;
+    WifiPassword passwordArg;
+    if (httpArg("ssid", ssidArg) && httpArg("password", passwordArg)) {
+        // A cut SSID or password could never join the network
+        if (ssidArg.truncated() || passwordArg.truncated()) {
+            httpSend(400, "text/plain", "SSID or password too long");
+            return;
+        }
+        // Both values go to flash in one commit; unchanged values are skipped
+        configSetString(CONFIG_KEY_WIFI_SSID, ssidArg);
+        configSetString(CONFIG_KEY_WIFI_PASSWORD, passwordArg);
+        configCommit();
 
-        Serial.println("WiFi credentials saved:");
-        Serial.println("SSID: " + ssid);
-        Serial.println("Password: " + password);
+        LOG_I(LOG_WIFI, "WiFi credentials saved, SSID: %s", ssidArg.c_str());
 
         // Set flag to indicate credentials have been submitted
         credentialsSubmitted = true;
 
         // Send success response
-        server.send(200, "text/plain", "WiFi credentials saved successfully!");
+        httpSend(200, "text/plain", "WiFi credentials saved successfully!");
     } else {
-        server.send(400, "text/plain", "Missing SSID or password");
+        httpSend(400, "text/plain", "Missing SSID or password");
     }
 }
 
-// Handle EEPROM clear request
+// Handle credentials clear request (URL kept for the setup page)
 void handleClearEEPROM() {
-    clearEEPROM();
-    server.send(200, "text/plain", "EEPROM cleared successfully! SSID and password fields erased.");
+    configRemove(CONFIG_KEY_WIFI_SSID);
+    configRemove(CONFIG_KEY_WIFI_PASSWORD);
+    configCommit();
+    LOG_I(LOG_WIFI, "Config cleared: SSID and password erased");
+    httpSend(200, "text/plain", "EEPROM cleared successfully! SSID and password fields erased.");
 }
 
 // Handle 404 - Not Found
 void handleNotFound() {
-    server.send(404, "text/plain", "Not Found");
+    httpSend(404, "text/plain", "Not Found");
 }
 
 void resetWifiSetup() {
@@ -91,11 +167,26 @@ bool getWifiStatus() {
   return (WiFi.status() == WL_CONNECTED);
 }
 
-// Setup Passwordless Access Point to intake WIFI credentials
+// Set up web server routes (only register once)
+void registerServerRoutes() {
+    if (serverRoutesRegistered) return;
+    httpOn("/", HTTP_METHOD_GET, handleWifiHomePage);
+    httpOn("/setup", HTTP_METHOD_GET, handleAPSetupPage);
+    httpOn("/wifi-config", HTTP_METHOD_POST, handleWiFiConfig);
+    httpOn("/clear-eeprom", HTTP_METHOD_GET, handleClearEEPROM);  // Clear EEPROM via GET request
+    httpOn("/status", HTTP_METHOD_GET, handleStatusRequest);
+    httpOn("/events", HTTP_METHOD_GET, handleStatusEvents);
+    httpOn("/metrics", HTTP_METHOD_GET, handleMetricsRequest);
+    httpOnNotFound(handleNotFound);
+    serverRoutesRegistered = true;
+}
+
+// Setup Passwordless Access Point to intake WIFI credentials.
+// Non-blocking: the portal is served by the HTTP task and handleWiFi()
+// moves on once credentials are submitted or the portal times out.
 void setupWifi() {
-    setLedColor(255, 255, 255);
-    printSeparator(1);
-    Serial.println("Starting WiFi Configuration Portal...");
+    ledSetStatus(LED_STATUS_AP_PORTAL);
+    LOG_I(LOG_WIFI, "Starting WiFi Configuration Portal...");
 
     // Set up Access Point
     WiFi.mode(WIFI_AP);
@@ -107,111 +198,233 @@ void setupWifi() {
     WiFi.softAP(ap_ssid, "");
 
     IPAddress IP = WiFi.softAPIP();
-    Serial.print("AP IP address: ");
-    Serial.println(IP);
-    Serial.print("AP SSID: ");
-    Serial.println(ap_ssid);
-    Serial.println("Connect to this network and navigate to http://" + IP.toString() + "/setup");
-
-    // Set up web server routes (only register once)
-    server.on("/setup", handleAPSetupPage);
-    server.on("/wifi-config", HTTP_POST, handleWiFiConfig);
-    server.on("/clear-eeprom", HTTP_GET, handleClearEEPROM);  // Clear EEPROM via GET request
-    server.onNotFound(handleNotFound);
+    LOG_I(LOG_WIFI, "AP SSID: %s, setup page: http://%u.%u.%u.%u/setup", ap_ssid, IP[0], IP[1], IP[2], IP[3]);
 
     // Start server on submitting WiFi credentials
-    server.begin();
-    Serial.println("HTTP server started");
-
-    printSeparator(3);
-    Serial.println("Waiting for WiFi credentials to be submitted...");
-
-    // Wait for credentials to be submitted
-    unsigned long startTime = millis();
-    unsigned long timeout = WIFI_SETUP_TIMEOUT_MS; // 5 minutes timeout (300000 ms)
+    registerServerRoutes();
+    httpServerBegin(HTTP_PORT);
+    LOG_I(LOG_HTTP, "HTTP server started");
+    LOG_I(LOG_WIFI, "Waiting for WiFi credentials to be submitted...");
 
-    while (!credentialsSubmitted) {
-        server.handleClient();
-
-        // Check for timeout
-        if (millis() - startTime > timeout) {
-            Serial.println("Timeout: No credentials submitted within " + String(WIFI_SETUP_TIMEOUT_MS / 1000) + " seconds");
-            break;
-        }
-        delay(SERVER_POLL_DELAY_MS);
-    }
-
-    if (credentialsSubmitted) {
-        Serial.println("WiFi credentials have been submitted!");
-    }
-    printSeparator(2);
-    setLedOff();
+    wifiPortalStartTime = millis();
+    wifiState = WIFI_STATE_PORTAL;
 }
 
-bool readWifiCredentialsFromEEPROM() {
-  printSeparator(1);
-  Serial.println("Checking for WiFi credentials in EEPROM...");
+bool readWifiCredentials() {
   bool result = false;
-    String savedSSID = readStringFromEEPROM(SSID_ADDR);
-    String savedPassword = readStringFromEEPROM(PASSWORD_ADDR);
-
-    if (savedSSID.length() > 0) {
-        Serial.println("Found saved WiFi credentials in EEPROM:");
-        Serial.println("SSID: " + savedSSID);
-        Serial.println("Password: " + savedPassword);
+    WifiSsid savedSSID;
+    if (configGetString(CONFIG_KEY_WIFI_SSID, savedSSID)) {
+        LOG_I(LOG_WIFI, "Found saved WiFi credentials, SSID: %s", savedSSID.c_str());
         result = true;
     }
     else
-        Serial.println("No saved WiFi credentials found.");
-    printSeparator(3);
+        LOG_I(LOG_WIFI, "No saved WiFi credentials found");
     return result;
 }
 
+uint16_t wifiSSIDCrc(StringView ssid) {
+  return configCrc16(0xFFFF, (const uint8_t*)ssid.data, ssid.len);
+}
+
+uint32_t wifiFastConnectCrc(const WifiFastConnect& cache) {
+  return configCrc16(0xFFFF, (const uint8_t*)&cache + 4, sizeof(cache) - 4);
+}
+
+bool wifiFastConnectValid(StringView ssid) {
+  return wifiFastConnect.crc == wifiFastConnectCrc(wifiFastConnect) &&
+         wifiFastConnect.ssidCrc == wifiSSIDCrc(ssid) && wifiFastConnect.channel != 0;
+}
+
+// Load the cache from RTC memory, else from the config store
+bool loadWifiFastConnect(StringView ssid) {
+  if (ESP.rtcUserMemoryRead(WIFI_RTC_BLOCK, (uint32_t*)&wifiFastConnect, sizeof(wifiFastConnect)) &&
+      wifiFastConnectValid(ssid))
+    return true;
+  return configGet(CONFIG_KEY_WIFI_FAST_CONNECT, &wifiFastConnect, sizeof(wifiFastConnect)) == sizeof(wifiFastConnect) &&
+         wifiFastConnectValid(ssid);
+}
+
+// Remember the network we just joined. The config store skips the flash
+// write when nothing changed, so this costs nothing on a normal reconnect.
+void saveWifiFastConnect(StringView ssid) {
+  memset(&wifiFastConnect, 0, sizeof(wifiFastConnect));
+  wifiFastConnect.ip = WiFi.localIP();
+  wifiFastConnect.gateway = WiFi.gatewayIP();
+  wifiFastConnect.subnet = WiFi.subnetMask();
+  wifiFastConnect.dns = WiFi.dnsIP();
+  wifiFastConnect.ssidCrc = wifiSSIDCrc(ssid);
+  wifiFastConnect.channel = WiFi.channel();
+  memcpy(wifiFastConnect.bssid, WiFi.BSSID(), sizeof(wifiFastConnect.bssid));
+  wifiFastConnect.crc = wifiFastConnectCrc(wifiFastConnect);
+
+  ESP.rtcUserMemoryWrite(WIFI_RTC_BLOCK, (uint32_t*)&wifiFastConnect, sizeof(wifiFastConnect));
+  configSet(CONFIG_KEY_WIFI_FAST_CONNECT, &wifiFastConnect, sizeof(wifiFastConnect));
+}
+
+// Join the saved network, with the cached BSSID/channel/IP if fast is set
+void beginWiFiStation(bool fast) {
+  WifiSsid savedSSID;
+  WifiPassword savedPassword;
+  configGetString(CONFIG_KEY_WIFI_SSID, savedSSID);
+  configGetString(CONFIG_KEY_WIFI_PASSWORD, savedPassword);
+
+  wifiFastConnectActive = fast && loadWifiFastConnect(savedSSID);
+  if (wifiFastConnectActive) {
+    WiFi.config(IPAddress(wifiFastConnect.ip), IPAddress(wifiFastConnect.gateway),
+                IPAddress(wifiFastConnect.subnet), IPAddress(wifiFastConnect.dns));
+    WiFi.begin(savedSSID.c_str(), savedPassword.c_str(), wifiFastConnect.channel, wifiFastConnect.bssid);
+    LOG_I(LOG_WIFI, "Fast connect on channel %u", (unsigned)wifiFastConnect.channel);
+  }
+  else {
+    // Configure static IP address
+    WiFi.config(wifi_ip, wifi_gateway, wifi_subnet);
+    WiFi.begin(savedSSID.c_str(), savedPassword.c_str());
+    LOG_I(LOG_WIFI, "Scanning");
+  }
+}
+
+// Start connecting to the saved network; handleWiFi() polls the result
 void connectToWiFi() {
-  if (getWifiStatus() && wifiConnection) return;
-  setLedColor(0, 0, 255);
-  printSeparator(1);
-  Serial.println("Connecting to WiFi...");
-  String savedSSID = readStringFromEEPROM(SSID_ADDR);
-  String savedPassword = readStringFromEEPROM(PASSWORD_ADDR);
-
-  // Turn off Access Point mode and connect to WiFi
+  ledSetStatus(LED_STATUS_WIFI_CONNECTING);
+  LOG_I(LOG_WIFI, "Connecting to WiFi...");
+
+  // Turn off Access Point mode and connect to WiFi. Credentials live in the
+  // config store, so keep the SDK from rewriting its own flash copy.
+  WiFi.persistent(false);
   WiFi.softAPdisconnect(true);
   WiFi.mode(WIFI_STA);
-  WiFi.begin(savedSSID.c_str(), savedPassword.c_str());
+  beginWiFiStation(true);
 
-  // Configure static IP address
-  WiFi.config(wifi_ip, wifi_gateway, wifi_subnet);
+  wifiConnectStartTime = millis();
+  wifiLastProgressTime = wifiConnectStartTime;
+  wifiState = WIFI_STATE_CONNECTING;
+}
 
-  Serial.print("Waiting: ");
-  int attempt = 0;
-  while (WiFi.status() != WL_CONNECTED && attempt < WIFI_CONNECTION_ATTEMPTS) {
-    Serial.print(".");
-    delay(WIFI_CONNECTION_DELAY_MS);
-    attempt++;
-  }
-  Serial.println("\n");
-  if (WiFi.status() == WL_CONNECTED) {
-    Serial.println("Connected to WiFi: " + savedSSID);
-    Serial.println("IP address: " + WiFi.localIP().toString());
-    server.on("/", handleWifiHomePage);
-
-    // Start the web server if not already started
-    server.begin();
-    Serial.println("HTTP server started on: http://" + WiFi.localIP().toString());
-    wifiConnection = true;
-    setLedOff();
+// Jittered exponential backoff between failed connections, as for MQTT:
+// the error stays on the LED meanwhile, and a fleet that lost its access
+// point does not come back in lockstep
+unsigned long wifiNextRetryDelay() {
+  unsigned long delayMs = wifiBackoffMs / 2 + random(wifiBackoffMs / 2 + 1);
+  wifiBackoffMs = (wifiBackoffMs * 2 > WIFI_BACKOFF_MAX_MS) ? WIFI_BACKOFF_MAX_MS : wifiBackoffMs * 2;
+  return delayMs;
+}
+
+// Per-device network start delay, 0 unless this boot is a power-on reset
+uint32_t startupJitterMs() {
+  if (STARTUP_JITTER_MAX_MS == 0 || ESP.getResetInfoPtr()->reason != REASON_DEFAULT_RST) return 0;
+  // Murmur3 finalizer: consecutive chip ids land far apart
+  uint32_t h = ESP.getChipId();
+  h ^= h >> 16;
+  h *= 0x85EBCA6BUL;
+  h ^= h >> 13;
+  h *= 0xC2B2AE35UL;
+  h ^= h >> 16;
+  return h % STARTUP_JITTER_MAX_MS;
+}
+
+// Boot with saved credentials: connect once the startup jitter has passed
+void startWiFi() {
+  wifiStartupHoldMs = startupJitterMs();
+  metricStartupJitterMs = wifiStartupHoldMs;
+  if (wifiStartupHoldMs == 0) {
+    connectToWiFi();
+    return;
   }
-  else{
-    Serial.println("Failed to connect to WiFi after " + String(attempt) + " attempts");
-    setLedColor(0, 255, 0);
+  LOG_I(LOG_WIFI, "Power-on: network start held for %lu ms", wifiStartupHoldMs);
+  // Keep the SDK from auto-joining with its own saved settings meanwhile
+  WiFi.persistent(false);
+  WiFi.mode(WIFI_OFF);
+  wifiState = WIFI_STATE_STARTUP_HOLD;
+}
+
+void onWiFiConnected() {
+  WifiSsid savedSSID;
+  configGetString(CONFIG_KEY_WIFI_SSID, savedSSID);
+  IPAddress ip = WiFi.localIP();
+  LOG_I(LOG_WIFI, "Connected to %s as %u.%u.%u.%u after %lu ms%s", savedSSID.c_str(), ip[0], ip[1], ip[2], ip[3],
+        millis() - wifiConnectStartTime, wifiFastConnectActive ? " (fast connect)" : "");
+  saveWifiFastConnect(savedSSID);
+  metricsMarkWifiConnected(wifiFastConnectActive);
+  metricWifiConnects++;
+  wifiBackoffMs = WIFI_BACKOFF_MIN_MS;
+  // Start the web server if not already started
+  registerServerRoutes();
+  httpServerBegin(HTTP_PORT);
+  LOG_I(LOG_HTTP, "HTTP server started on: http://%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+  wifiConnection = true;
+  wifiState = WIFI_STATE_CONNECTED;
+  ledSetStatus(LED_STATUS_IDLE);
+}
+
+// WiFi task: advance the portal / connection state machine
+void handleWiFi() {
+  switch (wifiState) {
+    case WIFI_STATE_STARTUP_HOLD:
+      if (millis() >= wifiStartupHoldMs) connectToWiFi();
+      break;
+
+    case WIFI_STATE_PORTAL:
+      if (credentialsSubmitted) {
+        LOG_I(LOG_WIFI, "WiFi credentials have been submitted");
+        connectToWiFi();
+      }
+      else if (millis() - wifiPortalStartTime > WIFI_SETUP_TIMEOUT_MS) {
+        LOG_W(LOG_WIFI, "Timeout: No credentials submitted within %u seconds", (unsigned)(WIFI_SETUP_TIMEOUT_MS / 1000));
+        connectToWiFi();
+      }
+      break;
+
+    case WIFI_STATE_CONNECTING:
+      if (getWifiStatus()) {
+        onWiFiConnected();
+      }
+      else if (wifiFastConnectActive &&
+               (millis() - wifiConnectStartTime > WIFI_FAST_CONNECT_TIMEOUT_MS ||
+                WiFi.status() == WL_NO_SSID_AVAIL || WiFi.status() == WL_CONNECT_FAILED)) {
+        // Access point moved or changed channel: forget it and scan
+        LOG_W(LOG_WIFI, "Fast connect failed");
+        WiFi.disconnect();
+        beginWiFiStation(false);
+        // The scan gets the full connection timeout of its own
+        wifiConnectStartTime = millis();
+        wifiLastProgressTime = wifiConnectStartTime;
+      }
+      else if (millis() - wifiConnectStartTime > (unsigned long)WIFI_CONNECTION_ATTEMPTS * WIFI_CONNECTION_DELAY_MS) {
+        // Stop the SDK from retrying on its own until the backoff is over
+        WiFi.disconnect();
+        wifiRetryDelayMs = wifiNextRetryDelay();
+        wifiDisconnectedAt = millis();
+        LOG_E(LOG_WIFI, "Failed to connect to WiFi after %u attempts, retrying in %lu ms",
+              (unsigned)WIFI_CONNECTION_ATTEMPTS, wifiRetryDelayMs);
+        ledSetStatus(LED_STATUS_ERROR);
+        wifiState = WIFI_STATE_DISCONNECTED;
+      }
+      else if (millis() - wifiLastProgressTime >= WIFI_CONNECTION_DELAY_MS) {
+        LOG_D(LOG_WIFI, "still connecting (%lu ms)", millis() - wifiConnectStartTime);
+        wifiLastProgressTime = millis();
+      }
+      break;
+
+    case WIFI_STATE_CONNECTED:
+      if (!getWifiStatus()) {
+        metricWifiDrops++;
+        wifiConnection = false;
+        // First reconnect after a drop is immediate, then back off
+        wifiRetryDelayMs = 0;
+        wifiDisconnectedAt = millis();
+        wifiState = WIFI_STATE_DISCONNECTED;
+      }
+      break;
+
+    case WIFI_STATE_DISCONNECTED:
+      if (millis() - wifiDisconnectedAt >= wifiRetryDelayMs) connectToWiFi();
+      break;
   }
-  printSeparator(3);
 }
 
 // Function to handle server clients (for use in loop)
 void handleWiFiServer() {
-    server.handleClient();
+    httpServerPoll();
 }
 
 #endif // WIFI_UTILS_H
\ No newline at end of file
@@ -0,0 +1,376 @@
+// Hot-path benchmarks on the host: MQTT dispatch, discovery serialization,
+// config store writes, page serving, logging and motion profile generation. Each
+// test prints its numbers (pio test -e native -f test_bench -v) and checks
+// that the path still does its job; compare against an earlier run to catch
+// regressions.
+
+#include "../test_support.h"
+
+#include <algorithm>
+
+#include "config_utils.h"
+#include "motor_utils.h"
+#include "mqtt_utils.h"
+#include "wifi_utils.h"
+
+CRGB leds[NEOPIXEL_COUNT];
+
+volatile uint32_t benchSink;  // keeps results the compiler could drop
+
+void setUp() {}
+void tearDown() {}
+
+// ---------------------------------------------------------------------------
+// MQTT dispatch
+// ---------------------------------------------------------------------------
+
+void test_mqtt_dispatch() {
+    static const char* const commands[] = { PAYLOAD_OPEN, PAYLOAD_STOP, PAYLOAD_CLOSE, PAYLOAD_STOP };
+    char topics[2][MQTT_TOPIC_MAX_LEN + 1];
+    strcpy(topics[0], commandTopic);
+    strcpy(topics[1], setPositionTopic);
+    const uint32_t messages = 200000;
+
+    testHeapReset();
+    uint64_t start = testNowNs();
+    for (uint32_t i = 0; i < messages; i++) {
+        if (i & 1) {
+            char position[4];
+            int n = snprintf(position, sizeof(position), "%u", (unsigned)(i % 101));
+            checkMQTTCallBack(topics[1], (byte*)position, n);
+        }
+        else {
+            const char* command = commands[(i >> 1) % 4];
+            checkMQTTCallBack(topics[0], (byte*)command, strlen(command));
+        }
+    }
+    testReport("mqtt dispatch", messages, testNowNs() - start);
+    TEST_ASSERT_EQUAL_UINT32(0, testHeapAllocations());
+
+    // The last message was set_position (messages - 1) % 101
+    TEST_ASSERT_EQUAL((long)((messages - 1) % 101) * BLIND_TRAVEL_STEPS / 100, planners[0].target);
+}
+
+// ---------------------------------------------------------------------------
+// Discovery serialization
+// ---------------------------------------------------------------------------
+
+void test_discovery_serialization() {
+    const uint32_t payloads = 20000;
+    DiscoveryWriter first = {false, 0, 2166136261UL};
+    writeDeviceDiscovery(first);
+
+    uint64_t start = testNowNs();
+    for (uint32_t i = 0; i < payloads; i++) {
+        DiscoveryWriter w = {false, 0, 2166136261UL};
+        writeDeviceDiscovery(w);
+        benchSink = w.hash;
+    }
+    uint64_t ns = testNowNs() - start;
+    testReport("discovery serialization", payloads, ns);
+    testReportValue("discovery throughput", (double)first.length * payloads * 1000.0 / ns, "MB/s");
+
+    TEST_ASSERT_GREATER_THAN(0, first.length);
+    TEST_ASSERT_EQUAL_UINT32(first.hash, benchSink);
+}
+
+// ---------------------------------------------------------------------------
+// Config store
+// ---------------------------------------------------------------------------
+
+void test_config_store() {
+    WifiSsid ssid;
+    const uint32_t commits = 5000;
+    uint32_t erasesBefore = 0;
+    for (uint8_t s = 0; s < FLASH_SECTOR_COUNT; s++) erasesBefore += flashEmuEraseCount[s];
+
+    uint64_t start = testNowNs();
+    for (uint32_t i = 0; i < commits; i++) {
+        ssid.clear();
+        ssid.appendf("network-%u", (unsigned)(i % 7));
+        configSetString(CONFIG_KEY_WIFI_SSID, ssid);
+        TEST_ASSERT_TRUE(configCommit());
+    }
+    testReport("config commit", commits, testNowNs() - start);
+
+    uint32_t erases = 0;
+    for (uint8_t s = 0; s < FLASH_SECTOR_COUNT; s++) erases += flashEmuEraseCount[s];
+    testReportValue("sector erases per 1000 commits", (erases - erasesBefore) * 1000.0 / commits, "");
+
+    const uint32_t reads = 200000;
+    WifiSsid read;
+    start = testNowNs();
+    for (uint32_t i = 0; i < reads; i++) {
+        configGetString(CONFIG_KEY_WIFI_SSID, read);
+        benchSink = read.length();
+    }
+    testReport("config read", reads, testNowNs() - start);
+    TEST_ASSERT_TRUE(read == ssid);
+
+    // An unchanged value is not written again
+    uint32_t offset = configWriteOffset;
+    configSetString(CONFIG_KEY_WIFI_SSID, ssid);
+    TEST_ASSERT_TRUE(configCommit());
+    TEST_ASSERT_EQUAL_UINT32(offset, configWriteOffset);
+}
+
+// ---------------------------------------------------------------------------
+// Page serving
+// ---------------------------------------------------------------------------
+
+void test_page_serving() {
+    static char response[16384];
+    int fd = testHttpConnect(testHttpPort(httpListenFd));
+    TEST_ASSERT_TRUE(fd >= 0);
+
+    const uint32_t requests = 2000;
+    uint64_t bytes = 0;
+    uint64_t start = testNowNs();
+    for (uint32_t i = 0; i < requests; i++) {
+        size_t n = testHttpExchange(fd, "GET /setup HTTP/1.1\r\nHost: blinds\r\n\r\n", response, sizeof(response), httpServerPoll);
+        TEST_ASSERT_GREATER_THAN(WIFI_SETUP_GZ_LEN, n);
+        bytes += n;
+    }
+    uint64_t ns = testNowNs() - start;
+    testReport("GET /setup (200, keep-alive)", requests, ns);
+    testReportValue("bytes per /setup response", (double)bytes / requests, "B");
+
+    char request[128];
+    snprintf(request, sizeof(request), "GET /setup HTTP/1.1\r\nIf-None-Match: %s\r\n\r\n", WIFI_SETUP_ETAG);
+    start = testNowNs();
+    for (uint32_t i = 0; i < requests; i++) {
+        size_t n = testHttpExchange(fd, request, response, sizeof(response), httpServerPoll);
+        TEST_ASSERT_GREATER_THAN(0, n);
+    }
+    testReport("GET /setup (304, keep-alive)", requests, testNowNs() - start);
+    TEST_ASSERT_EQUAL_STRING_LEN("HTTP/1.1 304", response, 12);
+    close(fd);
+}
+
+// ---------------------------------------------------------------------------
+// Logging
+// ---------------------------------------------------------------------------
+
+#define BENCH_LOG_LINES 12
+
+void test_logging() {
+    // A burst of lines like a reconnect logs, against the 115200 baud UART
+    const uint32_t lines = BENCH_LOG_LINES;
+    logRing.tail = logRing.head;  // lines earlier tests left behind
+    nativeSerialModel(true);
+
+    // How the firmware logged before log_utils.h: String concatenation and
+    // Serial.println(), which waits whenever the 128-byte FIFO is full
+    uint64_t bytes = nativeSerialBytes;
+    testHeapReset();
+    uint64_t start = testNowNs();
+    for (uint32_t i = 0; i < lines; i++)
+        Serial.println(String("I mqtt   message arrived [") + commandTopic + "] " + PAYLOAD_OPEN + ", position " + String((int)i));
+    uint64_t printNs = testNowNs() - start;
+    uint32_t printAllocations = testHeapAllocations();
+    uint64_t printBytes = nativeSerialBytes - bytes;
+    while (Serial.availableForWrite() < NATIVE_SERIAL_FIFO) {}
+
+    // LOG_I: formatted into the ring; the log task moves it to the UART
+    // as the FIFO makes room, one scheduler pass at a time
+    bytes = nativeSerialBytes;
+    uint32_t dropped = logDropped;
+    testHeapReset();
+    start = testNowNs();
+    for (uint32_t i = 0; i < lines; i++)
+        LOG_I(LOG_MQTT, "message arrived [%s] %s, position %d", commandTopic, PAYLOAD_OPEN, (int)i);
+    uint64_t logNs = testNowNs() - start;
+    TEST_ASSERT_EQUAL_UINT32(0, testHeapAllocations());
+
+    // Most passes find the FIFO still full and return at once; time the
+    // ones that moved a line (median: the host preempts now and then)
+    uint64_t drainNs[BENCH_LOG_LINES];
+    uint32_t moved = 0;
+    while (logRing.tail != logRing.head) {
+        uint64_t before = nativeSerialBytes;
+        start = testNowNs();
+        handleLog();
+        uint64_t ns = testNowNs() - start;
+        if (nativeSerialBytes != before && moved < lines) drainNs[moved++] = ns;
+    }
+    nativeSerialModel(false);
+    TEST_ASSERT_EQUAL_UINT32(lines, moved);
+    std::sort(drainNs, drainNs + BENCH_LOG_LINES);
+
+    // The same text reached the UART, nothing was dropped
+    TEST_ASSERT_EQUAL_UINT32(printBytes, nativeSerialBytes - bytes);
+    TEST_ASSERT_EQUAL_UINT32(dropped, logDropped);
+    TEST_ASSERT_GREATER_THAN(0, printAllocations);
+    TEST_ASSERT_TRUE(logNs < printNs);
+
+    testReportValue("log burst, String + Serial.println (caller blocked)", printNs / 1000.0, "us");
+    testReportValue("log burst, allocations with String", printAllocations, "");
+    testReportValue("log burst, LOG_I into the ring", logNs / 1000.0, "us");
+    testReportValue("log burst, handleLog() pass that moves a line (median)", drainNs[BENCH_LOG_LINES / 2] / 1000.0, "us");
+    testReportValue("log burst, loop time saved", (printNs - logNs) / 1000.0, "us");
+
+    // Below LOG_LEVEL: no code, arguments not evaluated
+    const uint32_t calls = 1000000;
+    uint32_t evaluated = 0;
+    start = testNowNs();
+    for (uint32_t i = 0; i < calls; i++) LOG_D(LOG_MQTT, "debug %u", (unsigned)++evaluated);
+    testReport("LOG_D below LOG_LEVEL", calls, testNowNs() - start);
+    TEST_ASSERT_EQUAL_UINT32(0, evaluated);
+}
+
+// ---------------------------------------------------------------------------
+// Motion profile generation
+// ---------------------------------------------------------------------------
+
+// AccelStepper 1.64's speed update (computeNewSpeed(), run once per step),
+// with its float members, for comparison with the table-driven planner
+struct AccelStepperModel {
+    enum { DIRECTION_CCW = 0, DIRECTION_CW = 1 };
+    long currentPos = 0;
+    long targetPos = 0;
+    float speed = 0;
+    float maxSpeed = 1;
+    float acceleration = 0;
+    unsigned long stepInterval = 0;
+    long n = 0;
+    float c0 = 0, cn = 0, cmin = 1;
+    int direction = DIRECTION_CCW;
+
+    void moveTo(long absolute) { targetPos = absolute; }
+
+    void setMaxSpeed(float s) {
+        maxSpeed = s;
+        cmin = 1000000.0 / s;
+    }
+
+    void setAcceleration(float a) {
+        acceleration = a;
+        c0 = 0.676 * sqrt(2.0 / a) * 1000000.0;
+    }
+
+    void computeNewSpeed() {
+        long distanceTo = targetPos - currentPos;
+        long stepsToStop = (long)((speed * speed) / (2.0 * acceleration));
+        if (distanceTo == 0 && stepsToStop <= 1) {
+            stepInterval = 0;
+            speed = 0.0;
+            n = 0;
+            return;
+        }
+        if (distanceTo > 0) {
+            if (n > 0) {
+                if ((stepsToStop >= distanceTo) || direction == DIRECTION_CCW) n = -stepsToStop;
+            }
+            else if (n < 0) {
+                if ((stepsToStop < distanceTo) && direction == DIRECTION_CW) n = -n;
+            }
+        }
+        else if (distanceTo < 0) {
+            if (n > 0) {
+                if ((stepsToStop >= -distanceTo) || direction == DIRECTION_CW) n = -stepsToStop;
+            }
+            else if (n < 0) {
+                if ((stepsToStop < -distanceTo) && direction == DIRECTION_CCW) n = -n;
+            }
+        }
+        if (n == 0) {
+            cn = c0;
+            direction = (distanceTo > 0) ? DIRECTION_CW : DIRECTION_CCW;
+        }
+        else {
+            cn = cn - ((2.0 * cn) / ((4.0 * n) + 1));
+            cn = cn > cmin ? cn : cmin;
+        }
+        n++;
+        stepInterval = cn;
+        speed = 1000000.0 / cn;
+        if (direction == DIRECTION_CCW) speed = -speed;
+    }
+};
+
+void test_profile_generation() {
+    // What the firmware would pay per step without the table: the same
+    // double-precision math makeRampTable() runs at compile time
+    volatile uint32_t level = 0;
+    const uint32_t intervals = 100000;
+    uint64_t start = testNowNs();
+    for (uint32_t i = 0; i < intervals; i++) {
+        level = i % PROFILE_RAMP_STEPS;
+        double t = profileStepTime(level + 1) - profileStepTime(level);
+        benchSink = (uint32_t)(t * STEPPER_TIMER_HZ + 0.5);
+    }
+    testReport("ramp interval computed at runtime", intervals, testNowNs() - start);
+
+    start = testNowNs();
+    for (uint32_t i = 0; i < intervals; i++) {
+        level = i % PROFILE_RAMP_STEPS;
+        benchSink = rampInterval(level);
+    }
+    testReport("ramp interval from the table", intervals, testNowNs() - start);
+
+    // Full-travel moves through the precomputed table
+    StepPlanner planner = {0, 0, 0, 1};
+    uint32_t steps = 0, sum = 0, ticks;
+    uint64_t cycles = testCycles();
+    start = testNowNs();
+    for (uint8_t move = 0; move < 20; move++) {
+        planner.target = (move & 1) ? 0 : BLIND_TRAVEL_STEPS;
+        while (planNextStep(planner, &ticks)) {
+            sum += ticks;
+            steps++;
+        }
+    }
+    uint64_t ns = testNowNs() - start;
+    double tableCycles = (double)(testCycles() - cycles) / steps;
+    benchSink = sum;
+    testReport("planNextStep", steps, ns);
+    testReportValue("planNextStep cycles/step", tableCycles, "");
+    TEST_ASSERT_EQUAL_UINT32(20UL * BLIND_TRAVEL_STEPS, steps);
+    TEST_ASSERT_EQUAL(0, planner.position);
+
+    // The same moves through AccelStepper's per-step float math
+    AccelStepperModel stepper;
+    stepper.setMaxSpeed(MOTOR_MAX_SPEED);
+    stepper.setAcceleration(MOTOR_ACCELERATION);
+    uint32_t accelSteps = 0;
+    float intervalSum = 0;
+    cycles = testCycles();
+    start = testNowNs();
+    for (uint8_t move = 0; move < 20; move++) {
+        stepper.moveTo((move & 1) ? 0 : BLIND_TRAVEL_STEPS);
+        stepper.computeNewSpeed();
+        while (stepper.stepInterval) {
+            stepper.currentPos += (stepper.direction == AccelStepperModel::DIRECTION_CW) ? 1 : -1;
+            intervalSum += stepper.stepInterval;
+            accelSteps++;
+            stepper.computeNewSpeed();
+        }
+    }
+    ns = testNowNs() - start;
+    double accelCycles = (double)(testCycles() - cycles) / accelSteps;
+    benchSink = (uint32_t)intervalSum;
+    testReport("AccelStepper computeNewSpeed", accelSteps, ns);
+    testReportValue("AccelStepper cycles/step", accelCycles, "");
+    testReportValue("computeNewSpeed / planNextStep", accelCycles / tableCycles, "x");
+    TEST_ASSERT_EQUAL(0, stepper.currentPos);
+    TEST_ASSERT_TRUE(accelCycles > tableCycles);
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    configBegin();
+    initMotor();
+    setenv("NATIVE_HTTP_PORT", "0", 1);
+    registerServerRoutes();
+    httpServerBegin(HTTP_PORT);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_mqtt_dispatch);
+    RUN_TEST(test_discovery_serialization);
+    RUN_TEST(test_config_store);
+    RUN_TEST(test_page_serving);
+    RUN_TEST(test_logging);
+    RUN_TEST(test_profile_generation);
+    return UNITY_END();
+}
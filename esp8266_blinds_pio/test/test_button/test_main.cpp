@@ -0,0 +1,91 @@
+// Button gestures end to end: edges go into the ring as buttonISR() would
+// queue them, and handleButton() decodes them and drives the blind.
+
+#include "../test_support.h"
+
+#include "button_utils.h"
+
+CRGB leds[NEOPIXEL_COUNT];
+
+void setUp() {
+    buttonEdges = EventRing();
+    buttonGestures = EventRing();
+    buttonPressed = false;
+    buttonLongSent = false;
+    buttonClickPending = false;
+    buttonLastOpen = false;
+}
+
+void tearDown() {}
+
+// Blind at rest at a position
+void placeBlind(uint8_t percent) {
+    long steps = (long)percent * BLIND_TRAVEL_STEPS / 100;
+    for (uint8_t a = 0; a < MOTOR_AXES; a++) {
+        stepperAxes[a].position = steps;
+        planners[a] = {steps, steps, 0, 1};
+    }
+}
+
+// One press and release starting at edge time at (ms), then the button task
+void press(uint32_t at) {
+    TEST_ASSERT_TRUE(eventPush(buttonEdges, BUTTON_EDGE_DOWN, at & EVENT_VALUE_MASK));
+    TEST_ASSERT_TRUE(eventPush(buttonEdges, BUTTON_EDGE_UP, (at + 80) & EVENT_VALUE_MASK));
+    handleButton();
+}
+
+// Two presses 200 ms apart: a short press, then a double
+void doublePress() {
+    uint32_t now = millis();
+    press(now);
+    press(now + 200);
+}
+
+void test_double_press_when_closed_opens() {
+    placeBlind(0);
+    doublePress();
+    TEST_ASSERT_EQUAL(BLIND_TRAVEL_STEPS, planners[0].target);
+}
+
+void test_double_press_when_open_closes() {
+    placeBlind(100);
+    doublePress();
+    TEST_ASSERT_EQUAL(0, planners[0].target);
+}
+
+void test_double_press_goes_to_far_end() {
+    // Stopped near the top, last move was closing: the first press
+    // opens the last bit, the double still goes all the way down
+    placeBlind(80);
+    buttonLastOpen = false;
+    doublePress();
+    TEST_ASSERT_EQUAL(0, planners[0].target);
+
+    // Opening from 30%: the first press stops it, the double opens
+    placeBlind(30);
+    motorMoveTo(0, BLIND_TRAVEL_STEPS);
+    doublePress();
+    TEST_ASSERT_EQUAL(BLIND_TRAVEL_STEPS, planners[0].target);
+}
+
+void test_single_press_cycle_at_endpoints() {
+    placeBlind(0);
+    press(millis());
+    TEST_ASSERT_EQUAL(BLIND_TRAVEL_STEPS, planners[0].target);
+
+    placeBlind(100);
+    press(millis() + 1000);
+    TEST_ASSERT_EQUAL(0, planners[0].target);
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    initMotor();
+    UNITY_BEGIN();
+    RUN_TEST(test_double_press_when_closed_opens);
+    RUN_TEST(test_double_press_when_open_closes);
+    RUN_TEST(test_double_press_goes_to_far_end);
+    RUN_TEST(test_single_press_cycle_at_endpoints);
+    return UNITY_END();
+}
@@ -0,0 +1,151 @@
+// Config store on the flash emulator: power cut at every word of a commit
+// and of a compaction, and the backoff after a commit that keeps failing.
+
+#include "../test_support.h"
+
+#include "config_utils.h"
+
+CRGB leds[NEOPIXEL_COUNT];
+
+// Flash image to start each power-cut run from
+uint32_t savedFlash[FLASH_SECTOR_COUNT][FLASH_SECTOR_SIZE / 4];
+
+// Lose everything in RAM and boot again from what is in flash
+void powerCycle() {
+    memset(configEntries, 0, sizeof(configEntries));
+    configActiveSector = CONFIG_NO_SECTOR;
+    configSequence = 0;
+    configWriteOffset = CONFIG_HEADER_SIZE;
+    configLogDamaged = false;
+    configDirty = false;
+    configFailures = 0;
+    flashEmuWriteBudget = -1;
+    configBegin();
+}
+
+void setUp() {
+    flashEmuReset();
+    powerCycle();
+}
+
+void tearDown() {
+    flashEmuWriteBudget = -1;
+}
+
+void setSsid(const char* value) {
+    WifiSsid ssid;
+    ssid = value;
+    configSetString(CONFIG_KEY_WIFI_SSID, ssid);
+}
+
+bool ssidIs(const char* value) {
+    WifiSsid ssid;
+    configGetString(CONFIG_KEY_WIFI_SSID, ssid);
+    return ssid == StringView(value);
+}
+
+// Commit newValue over oldValue with power lost after 0, 1, 2, ... words,
+// until a commit gets through. Each time the next boot must see exactly one
+// of the two values, and the store must still take writes.
+void checkPowerCuts(const char* oldValue, const char* newValue, bool compacts) {
+    memcpy(savedFlash, flashEmuData, sizeof(savedFlash));
+    uint8_t sector = configActiveSector;
+    bool committed = false;
+    long budget = 0;
+
+    for (; !committed; budget++) {
+        memcpy(flashEmuData, savedFlash, sizeof(savedFlash));
+        powerCycle();
+        TEST_ASSERT_TRUE(ssidIs(oldValue));
+        setSsid(newValue);
+        flashEmuWriteBudget = budget;
+        committed = configCommit();
+        if (committed) TEST_ASSERT_EQUAL(compacts, configActiveSector != sector);
+
+        powerCycle();
+        TEST_ASSERT_TRUE(ssidIs(committed ? newValue : oldValue));
+        TEST_ASSERT_TRUE(ssidIs(oldValue) || ssidIs(newValue));
+
+        setSsid("after");
+        TEST_ASSERT_TRUE(configCommit());
+        powerCycle();
+        TEST_ASSERT_TRUE(ssidIs("after"));
+    }
+    TEST_ASSERT_GREATER_THAN(1, budget);
+}
+
+void test_power_cut_during_append() {
+    setSsid("old-network");
+    TEST_ASSERT_TRUE(configCommit());
+    checkPowerCuts("old-network", "new-network", false);
+}
+
+void test_power_cut_during_compaction() {
+    // Fill the active sector so the next commit has to compact
+    setSsid("old-network");
+    TEST_ASSERT_TRUE(configCommit());
+    configSetString(CONFIG_KEY_WIFI_PASSWORD, StringView("secret"));
+    uint32_t record = configRecordSize(strlen("old-network"));
+    const char* values[] = { "old-networx", "old-network" };
+    uint32_t i = 0;
+    for (; configWriteOffset + record <= FLASH_SECTOR_SIZE; i++) {
+        setSsid(values[i & 1]);
+        TEST_ASSERT_TRUE(configCommit());
+    }
+    const char* oldValue = values[(i - 1) & 1];
+
+    checkPowerCuts(oldValue, "new-network", true);
+
+    WifiPassword password;
+    TEST_ASSERT_TRUE(configGetString(CONFIG_KEY_WIFI_PASSWORD, password));
+    TEST_ASSERT_TRUE(password == StringView("secret"));
+}
+
+void test_failed_commit_backs_off() {
+    nativeVirtualClock(true);
+    setSsid("network");
+    configLogDamaged = true;  // force a compaction
+    flashEmuWriteBudget = 0;  // flash refuses every write and erase
+
+    // An hour of config task passes
+    uint32_t attempts = 0;
+    unsigned long lastAttempt = 0, lastGap = 0;
+    unsigned long start = millis();
+    while (millis() - start < 3600000UL) {
+        uint8_t failures = configFailures;
+        handleConfig();
+        if (configFailures != failures) {
+            unsigned long gap = millis() - lastAttempt;
+            if (attempts > 1) TEST_ASSERT_TRUE(gap >= lastGap);
+            if (attempts > 0) TEST_ASSERT_GREATER_OR_EQUAL(CONFIG_RETRY_MIN_MS, gap);
+            lastGap = gap;
+            lastAttempt = millis();
+            attempts++;
+        }
+        delay(100);
+    }
+    TEST_ASSERT_EQUAL_UINT32(CONFIG_MAX_FAILURES, attempts);
+    TEST_ASSERT_EQUAL_UINT8(CONFIG_MAX_FAILURES, configFailures);
+    TEST_ASSERT_TRUE(configDirty);
+
+    // Latched: the task leaves flash alone, an explicit commit still tries
+    flashEmuWriteBudget = -1;
+    delay(CONFIG_RETRY_MAX_MS);
+    handleConfig();
+    TEST_ASSERT_TRUE(configDirty);
+    TEST_ASSERT_TRUE(configCommit());
+    TEST_ASSERT_EQUAL_UINT8(0, configFailures);
+    powerCycle();
+    TEST_ASSERT_TRUE(ssidIs("network"));
+    nativeVirtualClock(false);
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_power_cut_during_append);
+    RUN_TEST(test_power_cut_during_compaction);
+    RUN_TEST(test_failed_commit_backs_off);
+    return UNITY_END();
+}
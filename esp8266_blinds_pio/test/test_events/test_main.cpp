@@ -0,0 +1,174 @@
+// State event ring (event_utils.h) under stress: a producer and a consumer
+// interleaved at random on one thread and running flat out on two, checking
+// that nothing is lost or reordered, then the MQTT side's latest-value-wins
+// draining.
+
+#include "../test_support.h"
+
+#include <atomic>
+#include <thread>
+
+#include "event_utils.h"
+#include "mqtt_utils.h"
+
+CRGB leds[NEOPIXEL_COUNT];
+
+EventRing ring;
+
+void setUp() {
+    ring = EventRing();
+}
+
+void tearDown() {}
+
+// Event n of a run: the type cycles through all three, the value is n
+uint8_t eventType(uint32_t n) {
+    return EVENT_POSITION + n % 3;
+}
+
+// Pop one event and check it is the next one expected, both overall and
+// for its type
+void expectNext(uint32_t* popped, uint32_t lastPerType[4]) {
+    uint8_t type;
+    uint32_t value;
+    TEST_ASSERT_TRUE(eventPop(ring, &type, &value));
+    TEST_ASSERT_EQUAL_UINT32(*popped, value);
+    TEST_ASSERT_EQUAL_UINT8(eventType(*popped), type);
+    if (*popped >= 3) TEST_ASSERT_EQUAL_UINT32(lastPerType[type] + 3, value);
+    lastPerType[type] = value;
+    (*popped)++;
+}
+
+void test_interleaved() {
+    const uint32_t events = 1000000;
+    uint32_t pushed = 0, popped = 0, rejected = 0;
+    uint32_t lastPerType[4] = {0};
+    uint32_t seed = 1;
+
+    // Bursts of up to 2x the ring size either side, so it runs full and
+    // empty over and over
+    while (popped < events) {
+        seed = seed * 1103515245UL + 12345;
+        uint32_t burst = (seed >> 16) % (2 * EVENT_RING_SIZE) + 1;
+        if (seed & 0x80000000UL) {
+            for (uint32_t i = 0; i < burst && pushed < events; i++) {
+                uint8_t queued = ring.head - ring.tail;
+                if (eventPush(ring, eventType(pushed), pushed)) {
+                    TEST_ASSERT_TRUE(queued < EVENT_RING_SIZE);
+                    pushed++;
+                }
+                else {
+                    TEST_ASSERT_EQUAL_UINT8(EVENT_RING_SIZE, queued);
+                    rejected++;
+                }
+            }
+        }
+        else {
+            for (uint32_t i = 0; i < burst && popped < pushed; i++) expectNext(&popped, lastPerType);
+            uint8_t type;
+            uint32_t value;
+            if (popped == pushed) TEST_ASSERT_FALSE(eventPop(ring, &type, &value));
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(events, pushed);
+    TEST_ASSERT_EQUAL_UINT16((uint16_t)rejected, ring.dropped);
+    TEST_ASSERT_GREATER_THAN(0, rejected);
+}
+
+void test_two_threads() {
+    // Producer and consumer on separate threads for half a second; the
+    // producer retries a full ring, like the motor task reporting a change
+    // on a later pass. Either side yields when it has to wait, so this also
+    // makes progress on a single core, just with fewer events.
+    const uint64_t runNs = 500000000ULL;
+    std::atomic<bool> stop(false);
+    uint32_t pushed = 0, rejected = 0;
+
+    std::thread producer([&]() {
+        for (uint32_t n = 0; n <= EVENT_VALUE_MASK && !stop.load(); n++) {
+            while (!eventPush(ring, eventType(n), n)) {
+                rejected++;
+                if (stop.load()) return;
+                std::this_thread::yield();
+            }
+            pushed = n + 1;
+        }
+    });
+
+    uint32_t popped = 0;
+    uint32_t lastPerType[4] = {0};
+    uint32_t mismatches = 0;  // Unity asserts stay out of the polling loop
+    uint8_t type;
+    uint32_t value;
+    uint64_t start = testNowNs();
+    for (;;) {
+        if (!eventPop(ring, &type, &value)) {
+            if (stop.load()) break;
+            if (testNowNs() - start >= runNs) {
+                stop = true;
+                producer.join();
+            }
+            else std::this_thread::yield();
+            continue;
+        }
+        if (value != popped || type != eventType(popped) ||
+            (popped >= 3 && value != lastPerType[type] + 3)) mismatches++;
+        lastPerType[type] = value;
+        popped++;
+    }
+
+    testReport("event ring push/pop across threads", popped, testNowNs() - start);
+    TEST_ASSERT_EQUAL_UINT32(0, mismatches);
+    TEST_ASSERT_GREATER_THAN(0, popped);
+    TEST_ASSERT_EQUAL_UINT32(pushed, popped);
+    TEST_ASSERT_EQUAL_UINT16((uint16_t)rejected, ring.dropped);
+}
+
+void test_drain_keeps_latest_per_topic() {
+    // A move reported faster than MQTT drains: every topic ends on its last value
+    EventRing& events = motionEvents;
+    events = EventRing();
+    for (uint8_t axis = 0; axis < MOTOR_AXES; axis++) {
+        pendingPosition[axis].pending = pendingMotion[axis].pending = pendingError[axis].pending = false;
+    }
+
+    uint32_t seed = 7;
+    uint16_t lastPosition[MOTOR_AXES] = {0}, lastMotion[MOTOR_AXES] = {0};
+    bool sentPosition[MOTOR_AXES] = {false}, sentMotion[MOTOR_AXES] = {false};
+    for (uint32_t n = 0; n < 10000; n++) {
+        seed = seed * 1103515245UL + 12345;
+        uint8_t axis = (seed >> 16) % MOTOR_AXES;
+        uint16_t position = (seed >> 8) % 101;
+        if (seed & 0x100) {
+            if (eventPush(events, EVENT_POSITION, eventAxisValue(axis, position))) {
+                lastPosition[axis] = position;
+                sentPosition[axis] = true;
+            }
+        }
+        else if (eventPush(events, EVENT_MOTION, eventAxisValue(axis, position % 3))) {
+            lastMotion[axis] = position % 3;
+            sentMotion[axis] = true;
+        }
+        if (n % 37 == 0) drainEventRing(events);
+    }
+    while (events.head != events.tail) drainEventRing(events);
+
+    for (uint8_t axis = 0; axis < MOTOR_AXES; axis++) {
+        TEST_ASSERT_EQUAL(sentPosition[axis], pendingPosition[axis].pending);
+        TEST_ASSERT_EQUAL(sentMotion[axis], pendingMotion[axis].pending);
+        if (sentPosition[axis]) TEST_ASSERT_EQUAL_UINT32(lastPosition[axis], pendingPosition[axis].value);
+        if (sentMotion[axis]) TEST_ASSERT_EQUAL_UINT32(lastMotion[axis], pendingMotion[axis].value);
+        TEST_ASSERT_FALSE(pendingError[axis].pending);
+    }
+    TEST_ASSERT_GREATER_THAN(0, events.dropped);
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_interleaved);
+    RUN_TEST(test_two_threads);
+    RUN_TEST(test_drain_keeps_latest_per_topic);
+    return UNITY_END();
+}
@@ -0,0 +1,411 @@
+// HTTP server on the host socket transport: the gzipped pages served from
+// flash, what each request costs in bytes on the wire and heap, several
+// clients at once, one pipelining past 64 KB, and event stream upkeep.
+
+#include "../test_support.h"
+
+#include "config_utils.h"
+#include "wifi_utils.h"
+
+CRGB leds[NEOPIXEL_COUNT];
+
+uint16_t serverPort;
+char response[16384];
+
+void setUp() {}
+void tearDown() {}
+
+// Value of a response header, "" if absent
+const char* headerValue(const char* name, char* out, size_t outSize) {
+    out[0] = '\0';
+    const char* end = strstr(response, "\r\n\r\n");
+    size_t nameLen = strlen(name);
+    for (const char* line = strstr(response, "\r\n"); line && line < end; line = strstr(line + 2, "\r\n")) {
+        if (strncasecmp(line + 2, name, nameLen) == 0 && line[2 + nameLen] == ':') {
+            const char* value = line + 2 + nameLen + 2;
+            size_t len = strcspn(value, "\r");
+            if (len >= outSize) len = outSize - 1;
+            memcpy(out, value, len);
+            out[len] = '\0';
+            break;
+        }
+    }
+    return out;
+}
+
+size_t headerLength(size_t responseLen) {
+    const char* end = (const char*)memmem(response, responseLen, "\r\n\r\n", 4);
+    return end ? end + 4 - response : 0;
+}
+
+// One request on a fresh connection. The heap counters cover the whole
+// exchange: accept, parse, respond, close.
+size_t request(const char* text) {
+    int fd = testHttpConnect(serverPort);
+    TEST_ASSERT_TRUE(fd >= 0);
+    size_t n = testHttpExchange(fd, text, response, sizeof(response), httpServerPoll);
+    close(fd);
+    for (int i = 0; i < 10; i++) httpServerPoll();  // let the server see the close
+    TEST_ASSERT_GREATER_THAN(0, n);
+    return n;
+}
+
+void checkGzipPage(const char* path, const uint8_t* data, size_t length, const char* etag) {
+    char text[128], value[64];
+    snprintf(text, sizeof(text), "GET %s HTTP/1.1\r\nHost: blinds\r\nAccept-Encoding: gzip\r\n\r\n", path);
+
+    size_t live = testHeap.liveBytes;
+    uint32_t freeHeap = ESP.getFreeHeap();
+    testHeapReset();
+    size_t n = request(text);
+    uint32_t allocations = testHeapAllocations();
+
+    TEST_ASSERT_EQUAL_STRING_LEN("HTTP/1.1 200", response, 12);
+    TEST_ASSERT_EQUAL_STRING("gzip", headerValue("Content-Encoding", value, sizeof(value)));
+    TEST_ASSERT_EQUAL_STRING("text/html", headerValue("Content-Type", value, sizeof(value)));
+    TEST_ASSERT_EQUAL_STRING("no-cache", headerValue("Cache-Control", value, sizeof(value)));
+    TEST_ASSERT_EQUAL_STRING(etag, headerValue("ETag", value, sizeof(value)));
+    TEST_ASSERT_EQUAL_UINT32(length, strtoul(headerValue("Content-Length", value, sizeof(value)), NULL, 10));
+
+    // The body is the flash array as is, and the headers stay small
+    size_t headers = headerLength(n);
+    TEST_ASSERT_EQUAL_UINT32(length, n - headers);
+    TEST_ASSERT_EQUAL_MEMORY(data, response + headers, length);
+    TEST_ASSERT_LESS_OR_EQUAL(256, headers);
+
+    // Served from flash: nothing allocated, no heap used at any point
+    TEST_ASSERT_EQUAL_UINT32(0, allocations);
+    TEST_ASSERT_EQUAL_UINT32(live, testHeap.peakBytes);
+    TEST_ASSERT_EQUAL_UINT32(freeHeap, ESP.getFreeHeap());
+
+    snprintf(text, sizeof(text), "GET %s 200: bytes sent", path);
+    testReportValue(text, n, "B");
+    snprintf(text, sizeof(text), "GET %s 200: peak heap", path);
+    testReportValue(text, testHeap.peakBytes - live, "B");
+}
+
+void test_setup_page() {
+    checkGzipPage("/setup", WIFI_SETUP_GZ, WIFI_SETUP_GZ_LEN, WIFI_SETUP_ETAG);
+}
+
+void test_home_page() {
+    checkGzipPage("/", WIFI_HOME_GZ, WIFI_HOME_GZ_LEN, WIFI_HOME_ETAG);
+}
+
+void test_not_modified() {
+    char text[160], value[64];
+    snprintf(text, sizeof(text), "GET /setup HTTP/1.1\r\nIf-None-Match: %s\r\n\r\n", WIFI_SETUP_ETAG);
+
+    size_t live = testHeap.liveBytes;
+    testHeapReset();
+    size_t n = request(text);
+
+    TEST_ASSERT_EQUAL_STRING_LEN("HTTP/1.1 304", response, 12);
+    TEST_ASSERT_EQUAL_UINT32(n, headerLength(n));  // no body
+    TEST_ASSERT_EQUAL_STRING(WIFI_SETUP_ETAG, headerValue("ETag", value, sizeof(value)));
+    TEST_ASSERT_EQUAL_STRING("", headerValue("Content-Encoding", value, sizeof(value)));
+    TEST_ASSERT_EQUAL_UINT32(0, testHeapAllocations());
+    TEST_ASSERT_EQUAL_UINT32(live, testHeap.peakBytes);
+    testReportValue("GET /setup 304: bytes sent", n, "B");
+
+    // A stale ETag gets the page
+    n = request("GET /setup HTTP/1.1\r\nIf-None-Match: \"0000000000000000\"\r\n\r\n");
+    TEST_ASSERT_EQUAL_STRING_LEN("HTTP/1.1 200", response, 12);
+    TEST_ASSERT_EQUAL_UINT32(WIFI_SETUP_GZ_LEN, n - headerLength(n));
+}
+
+// ---------------------------------------------------------------------------
+// Form bodies
+// ---------------------------------------------------------------------------
+
+void test_wifi_form_worst_case() {
+    // 32-byte SSID and 64-byte password of two-byte UTF-8 characters, all
+    // percent-encoded: the largest body the setup page can send
+    char body[HTTP_BODY_MAX_LEN + 2], text[HTTP_BODY_MAX_LEN + 160];
+    int n = snprintf(body, sizeof(body), "ssid=");
+    for (int i = 0; i < MAX_SSID_LEN / 2; i++) n += snprintf(body + n, sizeof(body) - n, "%%C3%%A9");
+    n += snprintf(body + n, sizeof(body) - n, "&password=");
+    for (int i = 0; i < MAX_PASSWORD_LEN / 2; i++) n += snprintf(body + n, sizeof(body) - n, "%%C3%%A9");
+    TEST_ASSERT_EQUAL(5 + 3 * MAX_SSID_LEN + 10 + 3 * MAX_PASSWORD_LEN, n);
+
+    snprintf(text, sizeof(text), "POST /wifi-config HTTP/1.1\r\nContent-Type: application/x-www-form-urlencoded\r\n"
+             "Content-Length: %d\r\n\r\n%s", n, body);
+    request(text);
+    TEST_ASSERT_EQUAL_STRING_LEN("HTTP/1.1 200", response, 12);
+
+    WifiSsid ssid;
+    WifiPassword password;
+    TEST_ASSERT_TRUE(configGetString(CONFIG_KEY_WIFI_SSID, ssid));
+    TEST_ASSERT_TRUE(configGetString(CONFIG_KEY_WIFI_PASSWORD, password));
+    TEST_ASSERT_EQUAL_UINT32(MAX_SSID_LEN, ssid.length());
+    TEST_ASSERT_EQUAL_UINT32(MAX_PASSWORD_LEN, password.length());
+    TEST_ASSERT_EQUAL_STRING_LEN("\xC3\xA9\xC3\xA9", ssid.c_str(), 4);
+
+    // One byte over the limit is refused before any of it is read
+    snprintf(text, sizeof(text), "POST /wifi-config HTTP/1.1\r\nContent-Length: %d\r\n\r\n", HTTP_BODY_MAX_LEN + 1);
+    request(text);
+    TEST_ASSERT_EQUAL_STRING_LEN("HTTP/1.1 413", response, 12);
+    credentialsSubmitted = false;
+}
+
+// ---------------------------------------------------------------------------
+// Load
+// ---------------------------------------------------------------------------
+
+// A keep-alive client that sends its next request once the last response
+// is in. All of them share the test thread with the server.
+struct LoadClient {
+    int fd;
+    const char* request;
+    size_t sent;
+    char buf[4096];
+    size_t len;
+    uint32_t done;
+};
+
+// Send, poll the server once, collect; true when a response completed
+bool loadStep(LoadClient& client) {
+    size_t requestLen = strlen(client.request);
+    if (client.sent < requestLen) {
+        ssize_t n = send(client.fd, client.request + client.sent, requestLen - client.sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n > 0) client.sent += n;
+    }
+    ssize_t n = recv(client.fd, client.buf + client.len, sizeof(client.buf) - 1 - client.len, MSG_DONTWAIT);
+    if (n > 0) client.len += n;
+    client.buf[client.len] = '\0';
+    size_t complete = testHttpComplete(client.buf, client.len, false);
+    if (!complete) return false;
+    TEST_ASSERT_EQUAL_STRING_LEN("HTTP/1.1 ", client.buf, 9);
+    TEST_ASSERT_TRUE(strncmp(client.buf + 9, "200", 3) == 0 || strncmp(client.buf + 9, "304", 3) == 0);
+    memmove(client.buf, client.buf + complete, client.len - complete);
+    client.len -= complete;
+    client.sent = 0;
+    client.done++;
+    return true;
+}
+
+void test_concurrent_clients() {
+    static char notModified[128];
+    snprintf(notModified, sizeof(notModified), "GET /setup HTTP/1.1\r\nIf-None-Match: %s\r\n\r\n", WIFI_SETUP_ETAG);
+    static const char* const requests[] = {
+        "GET /status HTTP/1.1\r\n\r\n",
+        notModified,
+        "GET / HTTP/1.1\r\nAccept-Encoding: gzip\r\n\r\n",
+        "GET /metrics HTTP/1.1\r\n\r\n",
+    };
+    const uint8_t clientCount = HTTP_MAX_CONNECTIONS - 1;  // one slot for the slow client
+    const uint32_t perClient = 2000;
+    static LoadClient clients[HTTP_MAX_CONNECTIONS];
+
+    for (uint8_t i = 0; i < clientCount; i++) {
+        clients[i] = LoadClient();
+        clients[i].fd = testHttpConnect(serverPort);
+        clients[i].request = requests[i % 4];
+        TEST_ASSERT_TRUE(clients[i].fd >= 0);
+    }
+
+    // A client that trickles its request in one byte per server pass must
+    // not hold up the others
+    const char slowRequest[] = "GET /status HTTP/1.1\r\nHost: blinds\r\nUser-Agent: slow\r\n\r\n";
+    int slow = testHttpConnect(serverPort);
+    TEST_ASSERT_TRUE(slow >= 0);
+    size_t slowSent = 0;
+
+    uint32_t total = 0, passes = 0;
+    uint64_t start = testNowNs();
+    uint64_t deadline = start + 20000000000ULL;
+    while (total < clientCount * perClient && testNowNs() < deadline) {
+        if (slowSent < sizeof(slowRequest) - 1 && passes++ % 8 == 0 &&
+            send(slow, slowRequest + slowSent, 1, MSG_NOSIGNAL | MSG_DONTWAIT) == 1)
+            slowSent++;
+        httpServerPoll();
+        for (uint8_t i = 0; i < clientCount; i++) {
+            if (clients[i].done < perClient && loadStep(clients[i])) total++;
+        }
+    }
+    uint64_t ns = testNowNs() - start;
+    testReport("concurrent keep-alive requests", total, ns);
+    TEST_ASSERT_EQUAL_UINT32(clientCount * perClient, total);
+    TEST_ASSERT_EQUAL_UINT32(sizeof(slowRequest) - 1, slowSent);
+
+    // The slow client is answered too once its request is complete
+    size_t n = testHttpExchange(slow, "", response, sizeof(response), httpServerPoll);
+    TEST_ASSERT_GREATER_THAN(0, n);
+    TEST_ASSERT_EQUAL_STRING_LEN("HTTP/1.1 200", response, 12);
+
+    // With every slot taken, one more connection is turned away, not queued
+    int extra = testHttpConnect(serverPort);
+    TEST_ASSERT_TRUE(extra >= 0);
+    bool closed = false;
+    for (int i = 0; i < 100 && !closed; i++) {
+        httpServerPoll();
+        char c;
+        closed = recv(extra, &c, 1, MSG_DONTWAIT) == 0;
+    }
+    TEST_ASSERT_TRUE(closed);
+    close(extra);
+
+    for (uint8_t i = 0; i < clientCount; i++) close(clients[i].fd);
+    close(slow);
+    for (int i = 0; i < 10; i++) httpServerPoll();
+}
+
+void test_pipelined_client() {
+    // One client writes requests back to back without waiting, well past
+    // 64 KB, while it reads. Every request is answered, in order, and the
+    // server holds no more of the stream than it is parsing.
+    const char pipelined[] = "GET /status HTTP/1.1\r\nHost: blinds\r\n\r\n";
+    const size_t requestLen = sizeof(pipelined) - 1;
+    const uint32_t requests = 4000;
+    TEST_ASSERT_GREATER_THAN(65536, requests * requestLen);
+
+    int fd = testHttpConnect(serverPort);
+    TEST_ASSERT_TRUE(fd >= 0);
+    static char buf[8192];
+    size_t len = 0, sent = 0;
+    uint32_t answered = 0;
+    testHeapReset();
+    uint64_t start = testNowNs();
+    uint64_t deadline = start + 20000000000ULL;
+    while (answered < requests && testNowNs() < deadline) {
+        if (sent < requests * requestLen) {
+            size_t offset = sent % requestLen;
+            ssize_t n = send(fd, pipelined + offset, requestLen - offset, MSG_NOSIGNAL | MSG_DONTWAIT);
+            if (n > 0) sent += n;
+        }
+        httpServerPoll();
+        ssize_t n = recv(fd, buf + len, sizeof(buf) - 1 - len, MSG_DONTWAIT);
+        if (n == 0) break;
+        if (n > 0) len += n;
+        buf[len] = '\0';
+        while (size_t complete = testHttpComplete(buf, len, false)) {
+            TEST_ASSERT_EQUAL_STRING_LEN("HTTP/1.1 200", buf, 12);
+            memmove(buf, buf + complete, len - complete);
+            len -= complete;
+            answered++;
+        }
+    }
+    testReport("pipelined requests", answered, testNowNs() - start);
+    TEST_ASSERT_EQUAL_UINT32(requests, answered);
+    TEST_ASSERT_EQUAL_UINT32(0, testHeapAllocations());
+
+    close(fd);
+    for (int i = 0; i < 10; i++) httpServerPoll();
+}
+
+// ---------------------------------------------------------------------------
+// Event streams
+// ---------------------------------------------------------------------------
+
+int openEventStream(int receiveBuffer = 0) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (receiveBuffer) setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &receiveBuffer, sizeof(receiveBuffer));
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(serverPort);
+    TEST_ASSERT_TRUE(connect(fd, (struct sockaddr*)&addr, sizeof(addr)) == 0);
+    const char text[] = "GET /events HTTP/1.1\r\n\r\n";
+    TEST_ASSERT_EQUAL(sizeof(text) - 1, send(fd, text, sizeof(text) - 1, MSG_NOSIGNAL));
+
+    // The stream has no length: read up to the end of the headers only
+    size_t len = 0;
+    response[0] = '\0';
+    for (int i = 0; i < 1000 && !strstr(response, "\r\n\r\n"); i++) {
+        httpServerPoll();
+        ssize_t n = recv(fd, response + len, 1, MSG_DONTWAIT);
+        if (n > 0) len += n;
+        response[len] = '\0';
+    }
+    TEST_ASSERT_EQUAL_STRING_LEN("HTTP/1.1 200", response, 12);
+    TEST_ASSERT_TRUE(strstr(response, "text/event-stream") != NULL);
+    return fd;
+}
+
+int8_t eventStreamIndex() {
+    for (uint8_t i = 0; i < HTTP_MAX_CONNECTIONS; i++) {
+        if (httpIsEventStream(i)) return i;
+    }
+    return -1;
+}
+
+void test_event_stream_keepalive() {
+    nativeVirtualClock(true);
+    int fd = openEventStream();
+    TEST_ASSERT_EQUAL_UINT8(1, httpEventStreamCount());
+
+    // Quiet for a keep-alive interval: a comment line goes out
+    delay(HTTP_EVENT_KEEPALIVE_MS + 1);
+    httpServerPoll();
+    char buf[64];
+    ssize_t n = recv(fd, buf, sizeof(buf) - 1, MSG_DONTWAIT);
+    TEST_ASSERT_GREATER_THAN(0, n);
+    buf[n] = '\0';
+    TEST_ASSERT_EQUAL_STRING(": keepalive\n\n", buf);
+
+    // A client that keeps reading keeps its stream
+    for (int i = 0; i < 10; i++) {
+        delay(HTTP_EVENT_KEEPALIVE_MS + 1);
+        httpServerPoll();
+        TEST_ASSERT_GREATER_THAN(0, recv(fd, buf, sizeof(buf), MSG_DONTWAIT));
+    }
+    TEST_ASSERT_EQUAL_UINT8(1, httpEventStreamCount());
+    close(fd);
+    for (int i = 0; i < 10; i++) httpServerPoll();
+    TEST_ASSERT_EQUAL_UINT8(0, httpEventStreamCount());
+    nativeVirtualClock(false);
+}
+
+void test_event_stream_idle_timeout() {
+    nativeVirtualClock(true);
+    int fd = openEventStream(4096);
+    int8_t index = eventStreamIndex();
+    TEST_ASSERT_TRUE(index >= 0);
+
+    // The client stops reading: fill the socket buffers until an event can
+    // no longer be handed over
+    char event[400];
+    memset(event, 'x', sizeof(event) - 1);
+    event[sizeof(event) - 1] = '\0';
+    uint32_t refused = 0;
+    for (uint32_t i = 0; i < 100000 && refused < 100; i++) {
+        if (httpSendEvent(index, event)) refused = 0;
+        else refused++;
+        httpServerPoll();
+    }
+    TEST_ASSERT_EQUAL_UINT32(100, refused);
+    TEST_ASSERT_TRUE(httpIsEventStream(index));
+
+    // Not before the timeout, and the slot is free after it
+    delay(HTTP_EVENT_IDLE_TIMEOUT_MS - 1000);
+    httpServerPoll();
+    TEST_ASSERT_TRUE(httpIsEventStream(index));
+    delay(2000);
+    httpServerPoll();
+    TEST_ASSERT_FALSE(httpIsEventStream(index));
+    TEST_ASSERT_EQUAL_UINT8(0, httpEventStreamCount());
+    close(fd);
+    nativeVirtualClock(false);
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    configBegin();
+    setenv("NATIVE_HTTP_PORT", "0", 1);
+    registerServerRoutes();
+    httpServerBegin(HTTP_PORT);
+    serverPort = testHttpPort(httpListenFd);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_setup_page);
+    RUN_TEST(test_home_page);
+    RUN_TEST(test_not_modified);
+    RUN_TEST(test_wifi_form_worst_case);
+    RUN_TEST(test_concurrent_clients);
+    RUN_TEST(test_pipelined_client);
+    RUN_TEST(test_event_stream_keepalive);
+    RUN_TEST(test_event_stream_idle_timeout);
+    return UNITY_END();
+}
@@ -0,0 +1,288 @@
+// Step generator: the interval sequence the planner queues for a move and
+// the timer1 ISR replays. The ISR is called directly, once per timer expiry,
+// with the motor task refilling the queue in between as it would on the
+// device.
+
+#include "../test_support.h"
+
+#include "motor_utils.h"
+#include "power_utils.h"
+
+CRGB leds[NEOPIXEL_COUNT];
+
+#define MOVE_MAX_STEPS (BLIND_TRAVEL_STEPS + 1000)
+
+// One recorded move: the ticks the timer was armed with before each step,
+// and the axis position after it
+uint32_t moveTicks[MOVE_MAX_STEPS];
+long movePositions[MOVE_MAX_STEPS];
+uint32_t moveSteps;
+
+void resetMotion() {
+    for (uint8_t a = 0; a < MOTOR_AXES; a++) {
+        StepperAxis& axis = stepperAxes[a];
+        axis.head = axis.tail = 0;
+        axis.running = false;
+        axis.position = 0;
+        axis.due = 0;
+    }
+    stepperActiveAxes = 0;
+    stepperArmedTicks = 0;
+    stepperUnderruns = 0;
+    stepperIsrEvents = EventRing();
+    motionEvents = EventRing();
+    initMotor();
+}
+
+void setUp() {
+    resetMotion();
+}
+
+void tearDown() {}
+
+// Let one timer expiry happen: refill the queue, then run the ISR.
+// False once the axis is idle.
+bool stepOnce(uint8_t a = 0) {
+    refillStepperAxis(a);
+    if (!stepperActiveAxes) return false;
+    TEST_ASSERT_TRUE(moveSteps < MOVE_MAX_STEPS);
+    moveTicks[moveSteps] = stepperArmedTicks;
+    stepperISR();
+    movePositions[moveSteps] = stepperAxes[a].position;
+    moveSteps++;
+    return true;
+}
+
+void runMove(long target) {
+    moveSteps = 0;
+    motorMoveTo(0, target);
+    while (stepOnce()) {}
+}
+
+// Steps already planned but not taken: the queue plus the one the timer
+// is armed for. A new target only shows in the steps after these.
+uint32_t queuedSteps(uint8_t a = 0) {
+    return (uint8_t)(stepperAxes[a].head - stepperAxes[a].tail) + (stepperAxes[a].running ? 1 : 0);
+}
+
+// Expected interval of step i (0-based) of an n-step move from rest to
+// rest: the ramp up, cruise at the last ramp interval, the ramp mirrored.
+// The middle step of an odd-length move is taken at the speed reached.
+uint32_t expectedInterval(uint32_t i, uint32_t n) {
+    uint32_t up = i;
+    uint32_t down = n - 1 - i;
+    uint32_t level = up < down ? up : down;
+    if (up == down && level > 0) level--;
+    if (level >= PROFILE_RAMP_STEPS) level = PROFILE_RAMP_STEPS - 1;
+    return rampInterval(level);
+}
+
+void test_ramp_table() {
+    // First step at t = sqrt(2/a) for the trapezoid
+    if (MOTION_PROFILE == MOTION_PROFILE_TRAPEZOID) {
+        uint32_t first = (uint32_t)(sqrt(2.0 / MOTOR_ACCELERATION) * STEPPER_TIMER_HZ + 0.5);
+        TEST_ASSERT_UINT32_WITHIN(1, first, rampInterval(0));
+    }
+    for (uint32_t i = 1; i < PROFILE_RAMP_STEPS; i++)
+        TEST_ASSERT_TRUE(rampInterval(i) <= rampInterval(i - 1));
+    TEST_ASSERT_UINT32_WITHIN(PROFILE_CRUISE_INTERVAL / 100, PROFILE_CRUISE_INTERVAL,
+                              rampInterval(PROFILE_RAMP_STEPS - 1));
+}
+
+void test_full_travel_sequence() {
+    runMove(BLIND_TRAVEL_STEPS);
+
+    TEST_ASSERT_EQUAL_UINT32(BLIND_TRAVEL_STEPS, moveSteps);
+    for (uint32_t i = 0; i < moveSteps; i++) {
+        TEST_ASSERT_EQUAL_UINT32(expectedInterval(i, moveSteps), moveTicks[i]);
+        TEST_ASSERT_EQUAL((long)i + 1, movePositions[i]);
+    }
+    TEST_ASSERT_EQUAL(BLIND_TRAVEL_STEPS, stepperAxes[0].position);
+    TEST_ASSERT_EQUAL_UINT32(0, stepperUnderruns);
+    TEST_ASSERT_FALSE(motorIsMoving());
+}
+
+void test_short_moves_are_symmetric() {
+    // Moves too short to reach full speed ramp up and straight back down
+    const long lengths[] = { 1, 2, 3, 7, 100, 2 * PROFILE_RAMP_STEPS - 1 };
+    long position = 0;
+    for (long length : lengths) {
+        runMove(position + length);
+        TEST_ASSERT_EQUAL_UINT32(length, moveSteps);
+        for (uint32_t i = 0; i < moveSteps; i++) {
+            TEST_ASSERT_EQUAL_UINT32(expectedInterval(i, moveSteps), moveTicks[i]);
+            TEST_ASSERT_EQUAL_UINT32(moveTicks[moveSteps - 1 - i], moveTicks[i]);
+        }
+        position += length;
+        TEST_ASSERT_EQUAL(position, stepperAxes[0].position);
+    }
+}
+
+void test_closing_move() {
+    runMove(5000);
+    runMove(0);
+    TEST_ASSERT_EQUAL_UINT32(5000, moveSteps);
+    for (uint32_t i = 0; i < moveSteps; i++) {
+        TEST_ASSERT_EQUAL_UINT32(expectedInterval(i, moveSteps), moveTicks[i]);
+        TEST_ASSERT_EQUAL(5000 - (long)i - 1, movePositions[i]);
+    }
+    TEST_ASSERT_EQUAL(0, stepperAxes[0].position);
+}
+
+void test_reversal_decelerates_first() {
+    moveSteps = 0;
+    motorMoveTo(0, BLIND_TRAVEL_STEPS);
+    while (moveSteps < 3000) stepOnce();
+    uint32_t committed = moveSteps + queuedSteps();
+    motorMoveTo(0, 0);
+    while (stepOnce()) {}
+
+    // Position peaks where the motor came to rest; the steps either side
+    // of the turn are both taken at the slowest ramp interval
+    uint32_t turn = 0;
+    for (uint32_t i = 1; i < moveSteps; i++) {
+        if (movePositions[i] < movePositions[i - 1]) {
+            turn = i;
+            break;
+        }
+    }
+    TEST_ASSERT_TRUE(turn > committed);
+    TEST_ASSERT_EQUAL_UINT32(rampInterval(0), moveTicks[turn - 1]);
+    TEST_ASSERT_EQUAL_UINT32(rampInterval(0), moveTicks[turn]);
+    // Decelerating from full speed takes a ramp's worth of steps
+    TEST_ASSERT_EQUAL_UINT32(committed + PROFILE_RAMP_STEPS, turn);
+    for (uint32_t i = 1; i < turn; i++) TEST_ASSERT_EQUAL(movePositions[i - 1] + 1, movePositions[i]);
+    TEST_ASSERT_EQUAL(0, stepperAxes[0].position);
+    TEST_ASSERT_EQUAL_UINT32(0, stepperUnderruns);
+}
+
+void test_stop_ramps_down() {
+    moveSteps = 0;
+    motorMoveTo(0, BLIND_TRAVEL_STEPS);
+    while (moveSteps < 5000) stepOnce();
+    uint32_t committed = moveSteps + queuedSteps();
+    motorStop(0);
+    while (stepOnce()) {}
+
+    TEST_ASSERT_EQUAL_UINT32(committed + PROFILE_RAMP_STEPS, moveSteps);
+    for (uint32_t i = committed; i < moveSteps; i++)
+        TEST_ASSERT_EQUAL_UINT32(rampInterval(moveSteps - 1 - i), moveTicks[i]);
+    TEST_ASSERT_EQUAL_UINT32(0, stepperUnderruns);
+}
+
+// Every interval the planner hands out comes from the ramp table
+void assertInterval(uint32_t ticks) {
+    TEST_ASSERT_GREATER_OR_EQUAL(rampInterval(PROFILE_RAMP_STEPS - 1), ticks);
+    TEST_ASSERT_LESS_OR_EQUAL(rampInterval(0), ticks);
+}
+
+void test_one_step_move_from_rest() {
+    StepPlanner planner = {100, 101, 0, 1};
+    uint32_t ticks;
+    TEST_ASSERT_TRUE(planNextStep(planner, &ticks));
+    TEST_ASSERT_EQUAL_UINT32(rampInterval(0), ticks);
+    TEST_ASSERT_EQUAL(101, planner.position);
+    TEST_ASSERT_EQUAL_UINT32(0, planner.level);
+    TEST_ASSERT_FALSE(planNextStep(planner, &ticks));
+
+    planner.target = 100;
+    TEST_ASSERT_TRUE(planNextStep(planner, &ticks));
+    TEST_ASSERT_EQUAL_UINT32(rampInterval(0), ticks);
+    TEST_ASSERT_EQUAL(-1, planner.direction);
+    TEST_ASSERT_FALSE(planNextStep(planner, &ticks));
+}
+
+void test_one_step_move_after_stop() {
+    moveSteps = 0;
+    motorMoveTo(0, BLIND_TRAVEL_STEPS);
+    while (moveSteps < 1500) stepOnce();
+    motorStop(0);
+    while (stepOnce()) {}
+    long stopped = stepperAxes[0].position;
+
+    // set_position one step further, then one step back
+    runMove(stopped + 1);
+    TEST_ASSERT_EQUAL_UINT32(1, moveSteps);
+    TEST_ASSERT_EQUAL_UINT32(rampInterval(0), moveTicks[0]);
+    runMove(stopped);
+    TEST_ASSERT_EQUAL_UINT32(1, moveSteps);
+    TEST_ASSERT_EQUAL_UINT32(rampInterval(0), moveTicks[0]);
+    TEST_ASSERT_EQUAL(stopped, stepperAxes[0].position);
+    TEST_ASSERT_EQUAL_UINT32(0, stepperUnderruns);
+}
+
+void test_one_step_move_after_underrun() {
+    moveSteps = 0;
+    motorMoveTo(0, BLIND_TRAVEL_STEPS);
+    while (moveSteps < 1500) stepOnce();
+
+    // The motor task stalls: the ISR drains the queue and stops mid-move
+    while (stepperActiveAxes) stepperISR();
+    TEST_ASSERT_EQUAL_UINT32(1, stepperUnderruns);
+    TEST_ASSERT_TRUE(planners[0].level > 0);
+
+    // The next refill restarts from rest; the remaining move is one step
+    long position = stepperAxes[0].position;
+    motorMoveTo(0, position + 1);
+    moveSteps = 0;
+    while (stepOnce()) {}
+    TEST_ASSERT_EQUAL_UINT32(1, moveSteps);
+    TEST_ASSERT_EQUAL_UINT32(rampInterval(0), moveTicks[0]);
+    TEST_ASSERT_EQUAL(position + 1, stepperAxes[0].position);
+    TEST_ASSERT_EQUAL_UINT32(1, stepperUnderruns);
+}
+
+void test_random_targets_stay_in_table() {
+    // Targets changed at random points of a move, including one step away
+    // and the current position, never step outside the ramp table
+    StepPlanner planner = {0, 0, 0, 1};
+    uint32_t seed = 12345, ticks;
+    for (uint32_t i = 0; i < 200000; i++) {
+        seed = seed * 1103515245UL + 12345;
+        uint32_t r = seed >> 8;
+        if (r % 97 == 0) planner.target = planner.position + (long)(r % 3) - 1;
+        else if (r % 89 == 0) planner.target = (long)(r % BLIND_TRAVEL_STEPS);
+        else if (r % 83 == 0) planner.target = planner.position + planner.direction * (long)planner.level;
+        if (planNextStep(planner, &ticks)) assertInterval(ticks);
+        TEST_ASSERT_LESS_OR_EQUAL(PROFILE_RAMP_STEPS, planner.level);
+    }
+}
+
+void test_driver_released_after_move() {
+    // Default build (POWER_MODE_NONE): the radio never sleeps, but the
+    // coils are still energized only for the move
+    TEST_ASSERT_FALSE(motorDriverEnabled);
+    moveSteps = 0;
+    motorMoveTo(0, 1000);
+    TEST_ASSERT_TRUE(stepOnce());
+    TEST_ASSERT_TRUE(motorDriverEnabled);
+    handlePower();
+    while (stepOnce()) {}
+
+    nativeVirtualClock(true);
+    handlePower();
+    TEST_ASSERT_TRUE(motorDriverEnabled);  // still settling
+    delay(POWER_DRIVER_OFF_DELAY_MS);
+    handlePower();
+    TEST_ASSERT_FALSE(motorDriverEnabled);
+    TEST_ASSERT_FALSE(powerIdle);
+    nativeVirtualClock(false);
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_ramp_table);
+    RUN_TEST(test_full_travel_sequence);
+    RUN_TEST(test_short_moves_are_symmetric);
+    RUN_TEST(test_closing_move);
+    RUN_TEST(test_reversal_decelerates_first);
+    RUN_TEST(test_stop_ramps_down);
+    RUN_TEST(test_one_step_move_from_rest);
+    RUN_TEST(test_one_step_move_after_stop);
+    RUN_TEST(test_one_step_move_after_underrun);
+    RUN_TEST(test_random_targets_stay_in_table);
+    RUN_TEST(test_driver_released_after_move);
+    return UNITY_END();
+}
@@ -0,0 +1,291 @@
+// MQTT path end to end: the firmware connects to the loopback broker in
+// lib/native_shims, and commands go through the socket, PubSubClient and
+// the dispatch table exactly as they would from Home Assistant. Then the
+// broker name resolver: *.local names go through the shim's mDNS stand-in
+// (NATIVE_MDNS_LOSS=100 makes every lookup fail) on a virtual clock.
+
+// Any address reaches the loopback broker; this one is only used after a
+// failed lookup
+#define RESOLVER_FALLBACK_IP "127.0.0.2"
+
+#include "../test_support.h"
+
+#include "config_utils.h"
+#include "motor_utils.h"
+#include "mqtt_utils.h"
+
+CRGB leds[NEOPIXEL_COUNT];
+
+void setUp() {}
+void tearDown() {}
+
+// Deliver one message and let the client read it
+void brokerSend(const char* topic, const char* payload) {
+    TEST_ASSERT_TRUE(nativeBrokerPublish(topic, payload));
+    TEST_ASSERT_TRUE(mqttClient.loop());
+}
+
+void test_connect_and_subscribe() {
+    TEST_ASSERT_TRUE(mqttSetupActive);
+    TEST_ASSERT_TRUE(nativeBrokerConnected());
+    TEST_ASSERT_EQUAL_UINT32(1, nativeBrokerConnects);
+    TEST_ASSERT_TRUE(nativeBrokerSubscribed(commandTopic));
+    TEST_ASSERT_TRUE(nativeBrokerSubscribed(setPositionTopic));
+    TEST_ASSERT_TRUE(nativeBrokerSubscribed(haStatusTopic));
+}
+
+void test_commands() {
+    brokerSend(commandTopic, PAYLOAD_OPEN);
+    TEST_ASSERT_EQUAL(BLIND_TRAVEL_STEPS, planners[0].target);
+    brokerSend(setPositionTopic, "42");
+    TEST_ASSERT_EQUAL(42L * BLIND_TRAVEL_STEPS / 100, planners[0].target);
+    brokerSend(commandTopic, PAYLOAD_CLOSE);
+    TEST_ASSERT_EQUAL(0, planners[0].target);
+
+    // Rejected payloads leave the target alone
+    brokerSend(setPositionTopic, "101");
+    brokerSend(setPositionTopic, "4x");
+    brokerSend(setPositionTopic, "");
+    brokerSend(commandTopic, "open");
+    TEST_ASSERT_EQUAL(0, planners[0].target);
+
+    // Home Assistant came back: discovery is sent again
+    discoveryRepublishRequested = false;
+    brokerSend(haStatusTopic, PAYLOAD_AVAILABLE);
+    TEST_ASSERT_TRUE(discoveryRepublishRequested);
+    discoveryRepublishRequested = false;
+}
+
+void test_dispatch_throughput_without_heap() {
+    static const char* const positions[] = { "0", "7", "42", "100" };
+    static const char* const commands[] = { PAYLOAD_OPEN, PAYLOAD_STOP, PAYLOAD_CLOSE, PAYLOAD_STOP };
+    const uint32_t messages = 50000;
+    uint32_t freeHeap = ESP.getFreeHeap();
+
+    testHeapReset();
+    uint64_t start = testNowNs();
+    for (uint32_t i = 0; i < messages; i++) {
+        if (i & 1) nativeBrokerPublish(setPositionTopic, positions[(i >> 1) % 4]);
+        else nativeBrokerPublish(commandTopic, commands[(i >> 1) % 4]);
+        mqttClient.loop();
+    }
+    uint64_t ns = testNowNs() - start;
+    testReport("mqtt receive and dispatch (loopback)", messages, ns);
+
+    // Nothing on the way from the socket to the motor target allocates
+    TEST_ASSERT_EQUAL_UINT32(0, testHeapAllocations());
+    TEST_ASSERT_EQUAL_UINT32(0, testHeap.frees);
+    TEST_ASSERT_EQUAL_UINT32(freeHeap, ESP.getFreeHeap());
+    TEST_ASSERT_TRUE(mqttClient.connected());
+    TEST_ASSERT_EQUAL(100L * BLIND_TRAVEL_STEPS / 100, planners[0].target);
+}
+
+// What Home Assistant receives for the default single-blind build. This is
+// a hand-maintained golden, not generated: ArduinoJson left the build with
+// the streamed template, and byte identity with its old per-entity payload
+// was given up when device-based discovery changed the format. Any change
+// here is a change to what HA sees, so update it only on purpose.
+static const char expectedDiscovery[] =
+    "{\"dev\":{\"ids\":\"mintek_blinds_1\",\"name\":\"Family Room Blinds\",\"mf\":\"Mintek\","
+    "\"mdl\":\"\",\"sw\":\"\"},"
+    "\"o\":{\"name\":\"Family Room Blinds\",\"sw\":\"\"},"
+    "\"avty_t\":\"mintek_blinds_1/availability\",\"pl_avail\":\"online\",\"pl_not_avail\":\"offline\","
+    "\"qos\":1,"
+    "\"cmps\":{\"mintek_blinds_1\":{\"p\":\"cover\",\"name\":null,\"uniq_id\":\"mintek_blinds_1\","
+    "\"retain\":true,\"optimistic\":false,"
+    "\"cmd_t\":\"mintek_blinds_1/set\",\"pos_t\":\"mintek_blinds_1/position\","
+    "\"stat_t\":\"mintek_blinds_1/state\",\"set_pos_t\":\"mintek_blinds_1/set_position\","
+    "\"pl_open\":\"OPEN\",\"pl_cls\":\"CLOSE\",\"pl_stop\":\"STOP\","
+    "\"pos_open\":100,\"pos_closed\":0}}}";
+
+char discoveryReceived[2048];
+size_t discoveryReceivedLen;
+bool discoveryReceivedRetained;
+uint32_t discoveryPublishes;
+uint32_t discoveryClears;  // empty retained payloads on the old per-entity topics
+
+void recordDiscovery(const char* topic, const uint8_t* payload, size_t length, bool retained) {
+    if (strcmp(topic, deviceDiscoveryTopic) == 0) {
+        TEST_ASSERT_TRUE(length < sizeof(discoveryReceived));
+        memcpy(discoveryReceived, payload, length);
+        discoveryReceivedLen = length;
+        discoveryReceivedRetained = retained;
+        discoveryPublishes++;
+    }
+    else if (strncmp(topic, "homeassistant/", 14) == 0 && length == 0 && retained) {
+        discoveryClears++;
+    }
+}
+
+void test_discovery_payload() {
+    if (MOTOR_AXES != 1 || METRICS_HA_SENSORS) TEST_IGNORE_MESSAGE("golden payload is for the default build");
+    configRemove(CONFIG_KEY_DISCOVERY_HASH);
+    nativeBrokerOnPublish = recordDiscovery;
+    discoveryPublishes = discoveryClears = 0;
+
+    TEST_ASSERT_TRUE(publishDeviceDiscovery(false));
+    TEST_ASSERT_EQUAL_UINT32(1, discoveryPublishes);
+    TEST_ASSERT_TRUE(discoveryReceivedRetained);
+    TEST_ASSERT_EQUAL_UINT32(sizeof(expectedDiscovery) - 1, discoveryReceivedLen);
+    TEST_ASSERT_EQUAL_MEMORY(expectedDiscovery, discoveryReceived, discoveryReceivedLen);
+
+    // The measuring pass agrees with what was streamed
+    DiscoveryWriter measure = {false, 0, 2166136261UL};
+    writeDeviceDiscovery(measure);
+    TEST_ASSERT_EQUAL_UINT32(discoveryReceivedLen, measure.length);
+
+    // First publish clears the pre-device-discovery topics
+    TEST_ASSERT_EQUAL_UINT32(MOTOR_AXES + sizeof(diagnosticSensors) / sizeof(diagnosticSensors[0]), discoveryClears);
+
+    // Unchanged: not sent again unless forced
+    TEST_ASSERT_TRUE(publishDeviceDiscovery(false));
+    TEST_ASSERT_EQUAL_UINT32(1, discoveryPublishes);
+    // Streamed from flash: no payload-sized buffer, no allocation
+    testHeapReset();
+    TEST_ASSERT_TRUE(publishDeviceDiscovery(true));
+    TEST_ASSERT_EQUAL_UINT32(0, testHeapAllocations());
+    TEST_ASSERT_EQUAL_UINT32(2, discoveryPublishes);
+    TEST_ASSERT_EQUAL_MEMORY(expectedDiscovery, discoveryReceived, discoveryReceivedLen);
+
+    nativeBrokerOnPublish = NULL;
+}
+
+// ---------------------------------------------------------------------------
+// Broker name resolver
+// ---------------------------------------------------------------------------
+
+// Run the MQTT task, on the virtual clock, until it has noticed a dropped
+// session and the session is up again
+void reconnectBroker() {
+    for (int i = 0; i < 1200; i++) {
+        handleMQTT();
+        if (mqttSetupActive) break;
+        delay(100);
+    }
+    TEST_ASSERT_TRUE(mqttSetupActive);
+}
+
+// Switch to a new broker name and connect through a successful lookup
+void useBrokerName(const char* name) {
+    setenv("NATIVE_MDNS_LOSS", "0", 1);
+    setMQTTBroker(name, "", "");
+    uint32_t lookups = metricResolverLookups;
+    reconnectBroker();
+    TEST_ASSERT_EQUAL_UINT32(lookups + 1, metricResolverLookups);
+}
+
+bool brokerAddressStored() {
+    ResolverCache stored;
+    return configGet(CONFIG_KEY_BROKER_ADDRESS, &stored, sizeof(stored)) == sizeof(stored);
+}
+
+void test_resolver_connects_to_cached_address() {
+    useBrokerName("broker.local");
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)IPAddress(127, 0, 0, 1), resolverCache.ip);
+    TEST_ASSERT_TRUE(brokerAddressStored());
+
+    // The session drops within the TTL: the reconnect needs no lookup
+    uint32_t lookups = metricResolverLookups, connects = nativeBrokerConnects;
+    nativeBrokerDisconnect();
+    reconnectBroker();
+    TEST_ASSERT_EQUAL_UINT32(connects + 1, nativeBrokerConnects);
+    TEST_ASSERT_EQUAL_UINT32(lookups, metricResolverLookups);
+
+    // After a reboot the stored address is there before any lookup, and
+    // the connect itself never runs one
+    resolverCache.ip = 0;
+    resolverLoaded = false;
+    resolverStale = true;
+    mqttClient.disconnect();
+    mqttSetupActive = false;
+    mqttConnectAttempt = 0;
+    resolverLoad(mqttServer.c_str());
+    setupMQTT();
+    TEST_ASSERT_TRUE(mqttSetupActive);
+    TEST_ASSERT_EQUAL_UINT32(connects + 2, nativeBrokerConnects);
+    TEST_ASSERT_EQUAL_UINT32(lookups, metricResolverLookups);
+}
+
+void test_resolver_refreshes_after_ttl_and_failed_connect() {
+    useBrokerName("refresh.local");
+    uint32_t lookups = metricResolverLookups;
+    handleResolver(mqttServer.c_str());
+    delay(RESOLVER_TTL_MS - 1000);
+    handleResolver(mqttServer.c_str());
+    TEST_ASSERT_EQUAL_UINT32(lookups, metricResolverLookups);
+
+    delay(1000);
+    handleResolver(mqttServer.c_str());
+    TEST_ASSERT_EQUAL_UINT32(lookups + 1, metricResolverLookups);
+    handleResolver(mqttServer.c_str());
+    TEST_ASSERT_EQUAL_UINT32(lookups + 1, metricResolverLookups);
+
+    // A failed connect looks the name up again without waiting out the TTL
+    resolverConnectFailed();
+    handleResolver(mqttServer.c_str());
+    TEST_ASSERT_EQUAL_UINT32(lookups + 2, metricResolverLookups);
+}
+
+void test_resolver_fallback_only_after_failed_lookup() {
+    IPAddress address;
+    setenv("NATIVE_MDNS_LOSS", "100", 1);
+    setMQTTBroker("missing.local", "", "");
+    TEST_ASSERT_FALSE(resolverAddress(mqttServer.c_str(), address));
+
+    uint32_t failures = metricResolverFailures;
+    handleResolver(mqttServer.c_str());
+    TEST_ASSERT_EQUAL_UINT32(failures + 1, metricResolverFailures);
+    TEST_ASSERT_TRUE(resolverAddress(mqttServer.c_str(), address));
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)IPAddress(127, 0, 0, 2), (uint32_t)address);
+    reconnectBroker();
+
+    // A name that has resolved keeps its cached address through failures
+    useBrokerName("cached.local");
+    setenv("NATIVE_MDNS_LOSS", "100", 1);
+    resolverConnectFailed();
+    handleResolver(mqttServer.c_str());
+    TEST_ASSERT_EQUAL_UINT32(failures + 2, metricResolverFailures);
+    TEST_ASSERT_TRUE(resolverAddress(mqttServer.c_str(), address));
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)IPAddress(127, 0, 0, 1), (uint32_t)address);
+    setenv("NATIVE_MDNS_LOSS", "0", 1);
+}
+
+void test_resolver_new_broker_drops_stored_address() {
+    useBrokerName("first.local");
+    TEST_ASSERT_TRUE(brokerAddressStored());
+
+    // Same name again (e.g. only the credentials changed): kept
+    setMQTTBroker("first.local", "user", "");
+    TEST_ASSERT_TRUE(brokerAddressStored());
+    TEST_ASSERT_NOT_EQUAL(0, resolverCache.ip);
+
+    setMQTTBroker("other.local", "", "");
+    TEST_ASSERT_FALSE(brokerAddressStored());
+    TEST_ASSERT_EQUAL_UINT32(0, resolverCache.ip);
+    reconnectBroker();
+    TEST_ASSERT_TRUE(brokerAddressStored());
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    configBegin();
+    initMotor();
+    WiFi.begin("test", "test");
+    nativeBrokerEnable(true);
+    mqttServer = "127.0.0.1";
+    setupMQTT();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_connect_and_subscribe);
+    RUN_TEST(test_commands);
+    RUN_TEST(test_discovery_payload);
+    RUN_TEST(test_dispatch_throughput_without_heap);
+
+    nativeVirtualClock(true);
+    RUN_TEST(test_resolver_connects_to_cached_address);
+    RUN_TEST(test_resolver_refreshes_after_ttl_and_failed_connect);
+    RUN_TEST(test_resolver_fallback_only_after_failed_lookup);
+    RUN_TEST(test_resolver_new_broker_drops_stored_address);
+    return UNITY_END();
+}
@@ -0,0 +1,189 @@
+// Three blinds on one timer1 interrupt: every step of every axis lands on
+// its own planned schedule, whatever the other axes are doing, and each
+// STEP pulse is held high for STEPPER_PULSE_US. Time is counted in timer
+// ticks: each ISR call happens stepperArmedTicks after the previous one.
+
+#define MOTOR_AXES 3
+#define STEPPER_STEP_PIN_3 4
+#define STEPPER_DIR_PIN_3 2
+
+#include "../test_support.h"
+
+#include "motor_utils.h"
+
+CRGB leds[NEOPIXEL_COUNT];
+
+uint64_t isrTime;                      // ticks at the last interrupt
+StepPlanner idealPlanner[MOTOR_AXES];  // replays each axis' move on its own
+uint64_t idealTime[MOTOR_AXES];        // when the axis' next step is due
+long retargetPosition[MOTOR_AXES];     // where the real planner saw a new target
+long retarget[MOTOR_AXES];
+bool retargetPending[MOTOR_AXES];
+uint32_t axisSteps[MOTOR_AXES];
+uint32_t isrCount;
+uint32_t pulseMinNs;                   // shortest ISR that raised a STEP line
+
+void setUp() {
+    for (uint8_t a = 0; a < MOTOR_AXES; a++) {
+        StepperAxis& axis = stepperAxes[a];
+        axis.head = axis.tail = 0;
+        axis.running = false;
+        axis.position = 0;
+        axis.due = 0;
+        axisSteps[a] = 0;
+        retargetPending[a] = false;
+    }
+    stepperActiveAxes = 0;
+    stepperArmedTicks = 0;
+    stepperUnderruns = 0;
+    initMotor();
+    isrTime = 0;
+    isrCount = 0;
+    pulseMinNs = 0xFFFFFFFFUL;
+}
+
+void tearDown() {}
+
+// Start a move on one axis, offset ticks after the last interrupt (as if
+// the motor task ran that much later); the timer counts down meanwhile
+void startMove(uint8_t a, long target, uint32_t offset = 0) {
+    if (stepperActiveAxes) {
+        TEST_ASSERT_TRUE(offset < stepperArmedTicks);
+        nativeTimer1Load = stepperArmedTicks - offset;
+    }
+    else {
+        TEST_ASSERT_EQUAL_UINT32(0, offset);
+    }
+    motorMoveTo(a, target);
+    idealPlanner[a] = planners[a];
+    idealTime[a] = isrTime + offset;
+    refillStepperAxis(a);
+    TEST_ASSERT_TRUE(stepperAxes[a].running);
+}
+
+// One timer expiry: the motor task refills, then the ISR runs. Checks that
+// each axis that stepped did so on schedule. False once all are idle.
+bool timerExpiry() {
+    for (uint8_t a = 0; a < MOTOR_AXES; a++) refillStepperAxis(a);
+    if (!stepperActiveAxes) return false;
+
+    long before[MOTOR_AXES];
+    for (uint8_t a = 0; a < MOTOR_AXES; a++) before[a] = stepperAxes[a].position;
+    isrTime += stepperArmedTicks;
+    uint64_t start = testNowNs();
+    stepperISR();
+    uint64_t ns = testNowNs() - start;
+    isrCount++;
+
+    uint32_t stepBits = 0;
+    for (uint8_t a = 0; a < MOTOR_AXES; a++) {
+        if (stepperAxes[a].position == before[a]) continue;
+        stepBits |= stepperAxes[a].stepMask;
+        axisSteps[a]++;
+
+        // Never late, and early by at most the coalescing window
+        uint32_t ticks;
+        if (retargetPending[a] && idealPlanner[a].position == retargetPosition[a]) {
+            idealPlanner[a].target = retarget[a];
+            retargetPending[a] = false;
+        }
+        TEST_ASSERT_TRUE(planNextStep(idealPlanner[a], &ticks));
+        idealTime[a] += ticks;
+        TEST_ASSERT_TRUE(isrTime <= idealTime[a]);
+        TEST_ASSERT_LESS_OR_EQUAL(STEPPER_COALESCE_TICKS, idealTime[a] - isrTime);
+    }
+    // The STEP lines that went low are exactly the axes that moved
+    TEST_ASSERT_EQUAL_UINT32(stepBits, GPOC);
+    if (stepBits && ns < pulseMinNs) pulseMinNs = ns;
+    return true;
+}
+
+void test_staggered_moves_keep_their_schedules() {
+    startMove(0, BLIND_TRAVEL_STEPS);
+    for (uint32_t i = 0; i < 500; i++) TEST_ASSERT_TRUE(timerExpiry());
+    startMove(1, 12000, 37);
+    for (uint32_t i = 0; i < 3000; i++) TEST_ASSERT_TRUE(timerExpiry());
+    startMove(2, 7777, stepperArmedTicks / 2);
+    while (timerExpiry()) {}
+
+    TEST_ASSERT_EQUAL_UINT32(BLIND_TRAVEL_STEPS, axisSteps[0]);
+    TEST_ASSERT_EQUAL_UINT32(12000, axisSteps[1]);
+    TEST_ASSERT_EQUAL_UINT32(7777, axisSteps[2]);
+    TEST_ASSERT_EQUAL(BLIND_TRAVEL_STEPS, stepperAxes[0].position);
+    TEST_ASSERT_EQUAL(12000, stepperAxes[1].position);
+    TEST_ASSERT_EQUAL(7777, stepperAxes[2].position);
+    TEST_ASSERT_EQUAL_UINT32(0, stepperUnderruns);
+    // Moves that overlap cost fewer interrupts than steps
+    TEST_ASSERT_TRUE(isrCount < BLIND_TRAVEL_STEPS + 12000 + 7777);
+
+    TEST_ASSERT_GREATER_OR_EQUAL(STEPPER_PULSE_US * 1000, pulseMinNs);
+    testReportValue("shortest STEP pulse (host)", pulseMinNs / 1000.0, "us");
+}
+
+void test_identical_moves_share_interrupts() {
+    for (uint8_t a = 0; a < MOTOR_AXES; a++) startMove(a, 5000);
+    while (timerExpiry()) {}
+
+    for (uint8_t a = 0; a < MOTOR_AXES; a++) {
+        TEST_ASSERT_EQUAL_UINT32(5000, axisSteps[a]);
+        TEST_ASSERT_EQUAL(5000, stepperAxes[a].position);
+    }
+    TEST_ASSERT_EQUAL_UINT32(5000, isrCount);
+}
+
+void test_reversal_while_others_run() {
+    startMove(0, BLIND_TRAVEL_STEPS);
+    startMove(1, 15000);
+    for (uint32_t i = 0; i < 4000; i++) TEST_ASSERT_TRUE(timerExpiry());
+
+    // Axis 1 turns back. The steps already queued go out as planned, so
+    // the replay takes the new target where the real planner did.
+    motorMoveTo(1, 1000);
+    retargetPosition[1] = planners[1].position;
+    retarget[1] = 1000;
+    retargetPending[1] = true;
+    while (timerExpiry()) {}
+
+    TEST_ASSERT_EQUAL(BLIND_TRAVEL_STEPS, stepperAxes[0].position);
+    TEST_ASSERT_EQUAL(1000, stepperAxes[1].position);
+    TEST_ASSERT_EQUAL(0, stepperAxes[2].position);
+    TEST_ASSERT_EQUAL_UINT32(0, stepperUnderruns);
+}
+
+void test_start_while_another_axis_is_due() {
+    startMove(0, BLIND_TRAVEL_STEPS);
+    for (uint32_t i = 0; i < 500; i++) TEST_ASSERT_TRUE(timerExpiry());
+
+    // Axis 1 starts just as axis 0's interval runs out: the counter has
+    // wrapped past zero and the interrupt is pending. Axis 0's edge stays
+    // where it was, and axis 1's schedule counts from that deadline.
+    uint32_t armed = stepperArmedTicks;
+    nativeTimer1Load = 0x7FFFFF;
+    motorMoveTo(1, 5000);
+    idealPlanner[1] = planners[1];
+    idealTime[1] = isrTime + armed;
+    refillStepperAxis(1);
+    TEST_ASSERT_TRUE(stepperAxes[1].running);
+    TEST_ASSERT_EQUAL_UINT32(armed, stepperArmedTicks);
+
+    uint32_t before = axisSteps[0];
+    TEST_ASSERT_TRUE(timerExpiry());
+    TEST_ASSERT_EQUAL_UINT32(before + 1, axisSteps[0]);
+    while (timerExpiry()) {}
+
+    TEST_ASSERT_EQUAL(BLIND_TRAVEL_STEPS, stepperAxes[0].position);
+    TEST_ASSERT_EQUAL(5000, stepperAxes[1].position);
+    TEST_ASSERT_EQUAL_UINT32(5000, axisSteps[1]);
+    TEST_ASSERT_EQUAL_UINT32(0, stepperUnderruns);
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    UNITY_BEGIN();
+    RUN_TEST(test_staggered_moves_keep_their_schedules);
+    RUN_TEST(test_identical_moves_share_interrupts);
+    RUN_TEST(test_reversal_while_others_run);
+    RUN_TEST(test_start_while_another_axis_is_due);
+    return UNITY_END();
+}
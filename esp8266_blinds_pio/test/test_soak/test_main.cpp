@@ -0,0 +1,142 @@
+// Heap soak (pio test -e soak): the whole firmware, setup() and loop() from
+// src/main.cpp, runs SOAK_DAYS on a virtual clock against the loopback
+// broker, with Home Assistant commands, web UI polling, WiFi drops and
+// reconfiguration going through every path that handles text at runtime.
+// Every allocation is placed in the emulated 40 KB device heap. Once the
+// device has booted and connected, nothing may allocate and the largest
+// free block must be where it started.
+
+#include "../test_support.h"
+
+#include "../../src/main.cpp"
+
+// Soak Configuration
+#ifndef SOAK_DAYS
+#define SOAK_DAYS 30
+#endif
+#define SOAK_STEP_MS 100                       // virtual time per loop pass
+#define SOAK_SETTLE_MS 60000UL                 // boot and first connect before the baseline
+#define SOAK_DAY_MS 86400000ULL
+#define SOAK_STATUS_INTERVAL_MS 10000UL        // GET /status from the web UI
+#define SOAK_COMMAND_INTERVAL_MS 600000UL      // a Home Assistant command
+#define SOAK_WIFI_DROP_INTERVAL_MS 3600000UL   // access point goes away
+#define SOAK_RECONFIG_INTERVAL_MS 86400000UL   // credentials and broker saved again
+
+void setUp() {}
+void tearDown() {}
+
+void soakReport(const char* label) {
+    char line[120];
+    snprintf(line, sizeof(line), "soak %s: free %u, largest block %u, fragmentation %u%%, allocations %u",
+             label, (unsigned)ESP.getFreeHeap(), (unsigned)ESP.getMaxFreeBlockSize(),
+             (unsigned)ESP.getHeapFragmentation(), (unsigned)testHeapAllocations());
+    TEST_MESSAGE(line);
+}
+
+// Home Assistant traffic: the command cycle, a position, and the birth
+// message that triggers a discovery check
+void soakCommand(uint32_t n) {
+    static const char* const commands[] = { PAYLOAD_OPEN, PAYLOAD_STOP, PAYLOAD_CLOSE, PAYLOAD_STOP };
+    char position[4];
+    snprintf(position, sizeof(position), "%u", (unsigned)(n * 37 % 101));
+    nativeBrokerPublish(commandTopic, commands[n % 4]);
+    nativeBrokerPublish(setPositionTopic, position);
+    nativeBrokerPublish(haStatusTopic, PAYLOAD_AVAILABLE);
+}
+
+// The web UI polling /status over a real socket
+void soakStatusRequest(int& fd) {
+    static char response[2048];
+    if (fd < 0) fd = testHttpConnect(testHttpPort(httpListenFd));
+    if (fd < 0) return;
+    if (!testHttpExchange(fd, "GET /status HTTP/1.1\r\nHost: blinds\r\n\r\n", response, sizeof(response), httpServerPoll)) {
+        close(fd);
+        fd = -1;
+    }
+}
+
+// What the setup portal and a broker change do, minus the HTTP request
+void soakReconfigure(uint32_t n) {
+    configSetString(CONFIG_KEY_WIFI_SSID, n % 2 ? "native" : "native-5g");
+    configSetString(CONFIG_KEY_WIFI_PASSWORD, "native-password");
+    readWifiCredentials();
+    setMQTTBroker(mqttServer, mqttUsername, mqttPassword);
+}
+
+void test_heap_soak() {
+    // Provision the way the setup portal does
+    configSetString(CONFIG_KEY_WIFI_SSID, "native");
+    configSetString(CONFIG_KEY_WIFI_PASSWORD, "native-password");
+    configCommit();
+    credentialsSubmitted = true;
+
+    unsigned long start = millis();
+    while (millis() - start < SOAK_SETTLE_MS) {
+        loop();
+        delay(SOAK_STEP_MS);
+    }
+    TEST_ASSERT_TRUE(mqttClient.connected());
+    testHeapReset();
+    uint32_t maxBlock = ESP.getMaxFreeBlockSize();
+    uint32_t freeHeap = ESP.getFreeHeap();
+    uint32_t connects = nativeBrokerConnects;
+    soakReport("start");
+
+    int statusFd = -1;
+    unsigned long lastStatus = millis(), lastCommand = millis(), lastDrop = millis(), lastReconfig = millis();
+    uint32_t commands = 0, reconfigs = 0;
+    for (uint16_t day = 1; day <= SOAK_DAYS; day++) {
+        unsigned long dayEnd = start + SOAK_SETTLE_MS + day * SOAK_DAY_MS;
+        while (millis() < dayEnd) {
+            loop();
+            delay(SOAK_STEP_MS);
+
+            unsigned long now = millis();
+            if (now - lastStatus >= SOAK_STATUS_INTERVAL_MS) {
+                soakStatusRequest(statusFd);
+                lastStatus = now;
+            }
+            if (now - lastCommand >= SOAK_COMMAND_INTERVAL_MS) {
+                soakCommand(commands++);
+                lastCommand = now;
+            }
+            if (now - lastDrop >= SOAK_WIFI_DROP_INTERVAL_MS) {
+                WiFi.disconnect();
+                lastDrop = now;
+            }
+            if (now - lastReconfig >= SOAK_RECONFIG_INTERVAL_MS) {
+                soakReconfigure(reconfigs++);
+                lastReconfig = now;
+            }
+        }
+        char label[12];
+        snprintf(label, sizeof(label), "day %u", day);
+        soakReport(label);
+    }
+    if (statusFd >= 0) close(statusFd);
+
+    soakReport("end");
+    TEST_ASSERT_EQUAL_UINT32(0, testHeapAllocations());
+    TEST_ASSERT_EQUAL_UINT32(maxBlock, ESP.getMaxFreeBlockSize());
+    TEST_ASSERT_EQUAL_UINT32(freeHeap, ESP.getFreeHeap());
+    // The load really went through: reconnects after every drop, commands
+    // received over the socket
+    TEST_ASSERT_GREATER_THAN(connects, nativeBrokerConnects);
+    TEST_ASSERT_GREATER_THAN(0, commands);
+    TEST_ASSERT_GREATER_THAN(0, metricWifiDrops);
+}
+
+int main(int argc, char** argv) {
+    (void)argc;
+    (void)argv;
+    setenv("NATIVE_HTTP_PORT", "0", 1);
+    nativeBrokerEnable(true);
+    nativeSerialModel(true);  // the log goes to a modelled UART, not stdout
+    testHeapEmulated = true;
+    nativeVirtualClock(true);
+    setup();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_heap_soak);
+    return UNITY_END();
+}
@@ -0,0 +1,205 @@
+#ifndef TEST_SUPPORT_H
+#define TEST_SUPPORT_H
+
+// Shared by the suites in test/ (pio test -e native). Every suite is one
+// program that includes the firmware headers it exercises, the way
+// src/main.cpp does, and defines the LED array itself.
+
+#include <Arduino.h>
+#include <unity.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// ---------------------------------------------------------------------------
+// Heap accounting
+// ---------------------------------------------------------------------------
+
+// Every operator new/delete in the program goes through here, so a test can
+// check that a code path allocates nothing. With testHeapEmulated set, new
+// blocks come from the emulated 40 KB device heap (lib/native_shims), where
+// they show up in ESP.getFreeHeap() and getMaxFreeBlockSize() and can
+// fragment it like on the ESP8266.
+struct TestHeapCounters {
+    uint32_t allocations;  // operator new
+    uint32_t frees;
+    size_t liveBytes;
+    size_t peakBytes;      // highest liveBytes since testHeapReset()
+    uint32_t emulated;     // allocations placed in the device heap
+    uint32_t deviceBase;   // nativeHeapAllocations at testHeapReset()
+};
+
+TestHeapCounters testHeap;
+bool testHeapEmulated = false;
+
+#define TEST_HEAP_PREFIX 16  // size header; keeps malloc's alignment
+
+void testHeapReset() {
+    testHeap.allocations = 0;
+    testHeap.frees = 0;
+    testHeap.peakBytes = testHeap.liveBytes;
+    testHeap.emulated = 0;
+    testHeap.deviceBase = nativeHeapAllocations;
+}
+
+// Allocations since testHeapReset(): operator new, plus String and anything
+// else that takes blocks from the device heap directly
+uint32_t testHeapAllocations() {
+    return testHeap.allocations + (nativeHeapAllocations - testHeap.deviceBase - testHeap.emulated);
+}
+
+void* testHeapAlloc(size_t size) {
+    uint8_t* block = NULL;
+    size_t prefix = TEST_HEAP_PREFIX;
+    if (testHeapEmulated) {
+        prefix = 8;
+        block = (uint8_t*)nativeHeapAlloc(size + prefix);
+        if (block) testHeap.emulated++;
+    }
+    if (!block) {
+        prefix = TEST_HEAP_PREFIX;
+        block = (uint8_t*)malloc(size + prefix);
+    }
+    if (!block) throw std::bad_alloc();
+    memcpy(block, &size, sizeof(size));
+    testHeap.allocations++;
+    testHeap.liveBytes += size;
+    if (testHeap.liveBytes > testHeap.peakBytes) testHeap.peakBytes = testHeap.liveBytes;
+    return block + prefix;
+}
+
+void testHeapFree(void* ptr) {
+    if (!ptr) return;
+    bool emulated = nativeHeapOwns(ptr);
+    uint8_t* block = (uint8_t*)ptr - (emulated ? 8 : TEST_HEAP_PREFIX);
+    size_t size;
+    memcpy(&size, block, sizeof(size));
+    testHeap.frees++;
+    testHeap.liveBytes -= size;
+    if (emulated) nativeHeapRelease(block);
+    else free(block);
+}
+
+void* operator new(size_t size) { return testHeapAlloc(size); }
+void* operator new[](size_t size) { return testHeapAlloc(size); }
+void operator delete(void* ptr) noexcept { testHeapFree(ptr); }
+void operator delete[](void* ptr) noexcept { testHeapFree(ptr); }
+void operator delete(void* ptr, size_t) noexcept { testHeapFree(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { testHeapFree(ptr); }
+
+// ---------------------------------------------------------------------------
+// Benchmarks
+// ---------------------------------------------------------------------------
+
+// Wall-clock nanoseconds; not affected by nativeVirtualClock()
+uint64_t testNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Host CPU cycle counter (the TSC on x86), for per-step costs that are
+// compared as cycles; other hosts fall back to nanoseconds
+uint64_t testCycles() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return testNowNs();
+#endif
+}
+
+// One result line in the test output, e.g.
+//   mqtt dispatch: 200000 ops, 41.2 ns/op, 24271844 ops/s
+void testReport(const char* name, uint32_t ops, uint64_t ns) {
+    char line[160];
+    double perOp = ops ? (double)ns / ops : 0;
+    snprintf(line, sizeof(line), "%s: %u ops, %.1f ns/op, %.0f ops/s",
+             name, (unsigned)ops, perOp, perOp > 0 ? 1e9 / perOp : 0);
+    TEST_MESSAGE(line);
+}
+
+void testReportValue(const char* name, double value, const char* unit) {
+    char line[160];
+    snprintf(line, sizeof(line), "%s: %.1f %s", name, value, unit);
+    TEST_MESSAGE(line);
+}
+
+// ---------------------------------------------------------------------------
+// HTTP client for the host server (http_utils.h)
+// ---------------------------------------------------------------------------
+
+// The server is polled in between, so client and server share one thread
+typedef void (*TestPoll)();
+
+// Port the server listens on; start it with NATIVE_HTTP_PORT=0 for any free one
+uint16_t testHttpPort(int listenFd) {
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+    if (getsockname(listenFd, (struct sockaddr*)&addr, &len) < 0) return 0;
+    return ntohs(addr.sin_port);
+}
+
+int testHttpConnect(uint16_t port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    if (fd < 0 || connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Response length once the headers and Content-Length bytes of body are
+// in (or the server closed a response without one); 0 while incomplete
+size_t testHttpComplete(const char* data, size_t len, bool closed) {
+    const char* end = (const char*)memmem(data, len, "\r\n\r\n", 4);
+    if (!end) return 0;
+    size_t headerLen = end + 4 - data;
+    const char* cl = (const char*)memmem(data, headerLen, "Content-Length: ", 16);
+    if (!cl) return closed ? len : 0;
+    size_t total = headerLen + strtoul(cl + 16, NULL, 10);
+    return len >= total ? total : 0;
+}
+
+// Send a request on fd and collect the response into out, polling the
+// server until it is complete. Returns its length, 0 on timeout.
+size_t testHttpExchange(int fd, const char* request, char* out, size_t outSize, TestPoll poll,
+                        unsigned long timeoutMs = 2000) {
+    size_t sent = 0, len = 0, requestLen = strlen(request);
+    bool closed = false;
+    uint64_t deadline = testNowNs() + timeoutMs * 1000000ULL;
+    while (testNowNs() < deadline) {
+        if (sent < requestLen) {
+            ssize_t n = send(fd, request + sent, requestLen - sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+            if (n > 0) sent += n;
+        }
+        poll();
+        for (;;) {
+            ssize_t n = recv(fd, out + len, outSize - 1 - len, MSG_DONTWAIT);
+            if (n > 0) len += n;
+            else {
+                if (n == 0) closed = true;
+                break;
+            }
+        }
+        out[len] = '\0';
+        size_t complete = testHttpComplete(out, len, closed);
+        if (complete) return complete;
+        if (closed || len == outSize - 1) return 0;
+    }
+    return 0;
+}
+
+#endif // TEST_SUPPORT_H